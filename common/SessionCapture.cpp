@@ -0,0 +1,645 @@
+#include "SessionCapture.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+constexpr int fileMagic = 0x53435041; // "APCS"
+constexpr int fileVersion = 1;
+constexpr size_t recordHeaderBytes = 2 * sizeof (std::uint32_t);
+
+enum PositionFlags : std::uint32_t
+{
+    hasPosition = 1u << 0,
+    isPlaying = 1u << 1,
+    isRecording = 1u << 2,
+    isLooping = 1u << 3,
+    hasTimeInSamples = 1u << 4,
+    hasTimeInSeconds = 1u << 5,
+    hasPpqPosition = 1u << 6,
+    hasBpm = 1u << 7,
+    hasTimeSignature = 1u << 8,
+    hasPpqOfLastBar = 1u << 9,
+    hasHostTime = 1u << 10,
+    hasLoopPoints = 1u << 11,
+    hasBarCount = 1u << 12
+};
+
+struct PositionRecord
+{
+    std::uint32_t flags = 0;
+    std::int32_t timeSignatureNumerator = 4;
+    std::int32_t timeSignatureDenominator = 4;
+    std::int32_t reserved = 0;
+    std::int64_t timeInSamples = 0;
+    std::uint64_t hostTimeNs = 0;
+    std::int64_t barCount = 0;
+    double timeInSeconds = 0.0;
+    double ppqPosition = 0.0;
+    double bpm = 0.0;
+    double ppqOfLastBar = 0.0;
+    double loopStart = 0.0;
+    double loopEnd = 0.0;
+};
+
+struct BlockRecord
+{
+    std::int64_t index = 0;
+    std::int32_t numSamples = 0;
+    std::int32_t numChannels = 0;
+    std::int32_t numParameterChanges = 0;
+    std::int32_t numMidiEvents = 0;
+    std::int32_t midiBytes = 0;
+    std::int32_t reserved = 0;
+};
+
+struct ParameterChange
+{
+    std::int32_t index = 0;
+    float value = 0.0f;
+};
+
+struct MidiEventHeader
+{
+    std::int32_t samplePosition = 0;
+    std::int32_t numBytes = 0;
+};
+
+PositionRecord makePositionRecord (const juce::AudioPlayHead::PositionInfo& position) noexcept
+{
+    PositionRecord record;
+    record.flags = hasPosition;
+    if (position.getIsPlaying())
+        record.flags |= isPlaying;
+    if (position.getIsRecording())
+        record.flags |= isRecording;
+    if (position.getIsLooping())
+        record.flags |= isLooping;
+
+    if (auto value = position.getTimeInSamples())
+    {
+        record.flags |= hasTimeInSamples;
+        record.timeInSamples = *value;
+    }
+    if (auto value = position.getTimeInSeconds())
+    {
+        record.flags |= hasTimeInSeconds;
+        record.timeInSeconds = *value;
+    }
+    if (auto value = position.getPpqPosition())
+    {
+        record.flags |= hasPpqPosition;
+        record.ppqPosition = *value;
+    }
+    if (auto value = position.getBpm())
+    {
+        record.flags |= hasBpm;
+        record.bpm = *value;
+    }
+    if (auto value = position.getTimeSignature())
+    {
+        record.flags |= hasTimeSignature;
+        record.timeSignatureNumerator = value->numerator;
+        record.timeSignatureDenominator = value->denominator;
+    }
+    if (auto value = position.getPpqPositionOfLastBarStart())
+    {
+        record.flags |= hasPpqOfLastBar;
+        record.ppqOfLastBar = *value;
+    }
+    if (auto value = position.getHostTimeNs())
+    {
+        record.flags |= hasHostTime;
+        record.hostTimeNs = *value;
+    }
+    if (auto value = position.getLoopPoints())
+    {
+        record.flags |= hasLoopPoints;
+        record.loopStart = value->ppqStart;
+        record.loopEnd = value->ppqEnd;
+    }
+    if (auto value = position.getBarCount())
+    {
+        record.flags |= hasBarCount;
+        record.barCount = *value;
+    }
+
+    return record;
+}
+
+juce::AudioPlayHead::PositionInfo makePositionInfo (const PositionRecord& record)
+{
+    juce::AudioPlayHead::PositionInfo position;
+    position.setIsPlaying ((record.flags & isPlaying) != 0);
+    position.setIsRecording ((record.flags & isRecording) != 0);
+    position.setIsLooping ((record.flags & isLooping) != 0);
+
+    if ((record.flags & hasTimeInSamples) != 0)
+        position.setTimeInSamples (record.timeInSamples);
+    if ((record.flags & hasTimeInSeconds) != 0)
+        position.setTimeInSeconds (record.timeInSeconds);
+    if ((record.flags & hasPpqPosition) != 0)
+        position.setPpqPosition (record.ppqPosition);
+    if ((record.flags & hasBpm) != 0)
+        position.setBpm (record.bpm);
+    if ((record.flags & hasTimeSignature) != 0)
+        position.setTimeSignature (juce::AudioPlayHead::TimeSignature { record.timeSignatureNumerator, record.timeSignatureDenominator });
+    if ((record.flags & hasPpqOfLastBar) != 0)
+        position.setPpqPositionOfLastBarStart (record.ppqOfLastBar);
+    if ((record.flags & hasHostTime) != 0)
+        position.setHostTimeNs (record.hostTimeNs);
+    if ((record.flags & hasLoopPoints) != 0)
+        position.setLoopPoints (juce::AudioPlayHead::LoopPoints { record.loopStart, record.loopEnd });
+    if ((record.flags & hasBarCount) != 0)
+        position.setBarCount (record.barCount);
+
+    return position;
+}
+
+// Counts the audio thread in while it touches the ring, so stop() can wait for it to leave.
+struct ActiveWriter
+{
+    ActiveWriter (std::atomic<int>& counter, const std::atomic<bool>& capturing) noexcept
+        : count (counter)
+    {
+        count.fetch_add (1);
+        active = capturing.load();
+    }
+
+    ~ActiveWriter() { count.fetch_sub (1); }
+
+    std::atomic<int>& count;
+    bool active = false;
+};
+
+template <typename Value>
+bool readValue (const char*& cursor, const char* end, Value& value) noexcept
+{
+    if (static_cast<size_t> (end - cursor) < sizeof (Value))
+        return false;
+
+    std::memcpy (&value, cursor, sizeof (Value));
+    cursor += sizeof (Value);
+    return true;
+}
+} // namespace
+
+// Copies one record into space already reserved in the ring, across the wrap if needed.
+class SessionCapture::RingWriter
+{
+public:
+    RingWriter (SessionCapture& owner, RecordType type, size_t payloadBytes) noexcept
+        : fifo (owner.ring),
+          storage (owner.ringStorage.data()),
+          total (static_cast<int> (recordHeaderBytes + payloadBytes))
+    {
+        fifo.prepareToWrite (total, start1, size1, start2, size2);
+        const std::uint32_t header[2] { static_cast<std::uint32_t> (type), static_cast<std::uint32_t> (payloadBytes) };
+        put (header, sizeof (header));
+    }
+
+    ~RingWriter() { fifo.finishedWrite (written); }
+
+    void put (const void* data, size_t numBytes) noexcept
+    {
+        const auto* bytes = static_cast<const char*> (data);
+        auto remaining = static_cast<int> (numBytes);
+        if (written < size1)
+        {
+            const int count = juce::jmin (remaining, size1 - written);
+            std::memcpy (storage + start1 + written, bytes, static_cast<size_t> (count));
+            written += count;
+            bytes += count;
+            remaining -= count;
+        }
+
+        if (remaining > 0)
+        {
+            std::memcpy (storage + start2 + (written - size1), bytes, static_cast<size_t> (remaining));
+            written += remaining;
+        }
+    }
+
+private:
+    juce::AbstractFifo& fifo;
+    char* storage = nullptr;
+    int total = 0;
+    int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+    int written = 0;
+};
+
+SessionCapture::SessionCapture (int newRingBytes)
+    : juce::Thread ("Session capture writer"),
+      ringBytes (newRingBytes)
+{
+}
+
+SessionCapture::~SessionCapture()
+{
+    stop();
+}
+
+bool SessionCapture::startFromEnvironment (juce::AudioProcessor& processor, double sampleRate, int maxBlockSize, juce::int64 randomSeed)
+{
+    stop();
+
+    const auto folderPath = juce::SystemStats::getEnvironmentVariable (folderVariable, {});
+    if (folderPath.isEmpty())
+        return false;
+
+    const juce::File folder (folderPath);
+    if (! folder.createDirectory())
+        return false;
+
+    Header header;
+    header.pluginName = processor.getName();
+    header.sampleRate = sampleRate;
+    header.maxBlockSize = maxBlockSize;
+    for (const bool isInput : { true, false })
+    {
+        auto& channels = isInput ? header.inputBusChannels : header.outputBusChannels;
+        for (int i = 0; i < processor.getBusCount (isInput); ++i)
+        {
+            const auto* bus = processor.getBus (isInput, i);
+            channels.add (bus != nullptr && bus->isEnabled() ? bus->getNumberOfChannels() : 0);
+        }
+    }
+    header.numParameters = processor.getParameters().size();
+    header.randomSeed = randomSeed;
+    processor.getStateInformation (header.state);
+
+    const auto name = header.pluginName + "-" + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S");
+    return start (folder.getNonexistentChildFile (name, fileExtension, false), processor, header);
+}
+
+bool SessionCapture::start (const juce::File& file, juce::AudioProcessor& processor, const Header& header)
+{
+    stop();
+
+    file.deleteFile();
+    stream = std::make_unique<juce::FileOutputStream> (file);
+    if (! stream->openedOk())
+    {
+        stream.reset();
+        return false;
+    }
+
+    stream->writeInt (fileMagic);
+    stream->writeInt (fileVersion);
+    stream->writeString (header.pluginName);
+    stream->writeDouble (header.sampleRate);
+    stream->writeInt (header.maxBlockSize);
+    for (const auto* channels : { &header.inputBusChannels, &header.outputBusChannels })
+    {
+        stream->writeInt (channels->size());
+        for (const auto numChannels : *channels)
+            stream->writeInt (numChannels);
+    }
+    stream->writeInt (header.numParameters);
+    stream->writeInt64 (header.randomSeed);
+    stream->writeInt64 (static_cast<juce::int64> (header.state.getSize()));
+    stream->write (header.state.getData(), header.state.getSize());
+    bytesWritten = stream->getPosition();
+
+    ringStorage.assign (static_cast<size_t> (ringBytes + 1), 0);
+    ring.setTotalSize (ringBytes + 1);
+    nextBlockIndex = 0;
+    pendingDroppedRecords = 0;
+    blockOpen = false;
+    numInputChannels = processor.getTotalNumInputChannels();
+    // NaN never compares equal, so the first block records every parameter.
+    lastParameterValues.assign (static_cast<size_t> (header.numParameters), std::numeric_limits<float>::quiet_NaN());
+    parameterChanges.clear();
+    parameterChanges.reserve (static_cast<size_t> (header.numParameters));
+
+    capturing.store (true);
+    startThread (juce::Thread::Priority::low);
+    return true;
+}
+
+void SessionCapture::stop()
+{
+    capturing.store (false);
+    while (activeWriters.load() > 0)
+        juce::Thread::yield();
+
+    stopThread (2000);
+    if (stream != nullptr)
+    {
+        drainRing();
+        stream->flush();
+        stream.reset();
+    }
+
+    // A one-slot fifo has no free space, so nothing can reserve into the released storage.
+    ring.setTotalSize (1);
+    ringStorage.clear();
+    ringStorage.shrink_to_fit();
+}
+
+void SessionCapture::run()
+{
+    while (! threadShouldExit())
+    {
+        drainRing();
+        wait (20);
+    }
+}
+
+void SessionCapture::drainRing()
+{
+    int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+    ring.prepareToRead (ring.getNumReady(), start1, size1, start2, size2);
+    if (size1 > 0)
+        stream->write (ringStorage.data() + start1, static_cast<size_t> (size1));
+    if (size2 > 0)
+        stream->write (ringStorage.data() + start2, static_cast<size_t> (size2));
+    ring.finishedRead (size1 + size2);
+
+    bytesWritten += size1 + size2;
+    if (bytesWritten >= maxFileBytes)
+        capturing.store (false);
+}
+
+bool SessionCapture::reserve (size_t payloadBytes) const noexcept
+{
+    return static_cast<size_t> (ring.getFreeSpace()) >= recordHeaderBytes + payloadBytes;
+}
+
+void SessionCapture::writeGapIfPending() noexcept
+{
+    if (pendingDroppedRecords == 0 || ! reserve (sizeof (std::int32_t)))
+        return;
+
+    RingWriter writer (*this, RecordType::gap, sizeof (std::int32_t));
+    const auto count = static_cast<std::int32_t> (pendingDroppedRecords);
+    writer.put (&count, sizeof (count));
+    pendingDroppedRecords = 0;
+}
+
+void SessionCapture::beginBlock (juce::AudioProcessor& processor, const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    if (numSamples <= 0)
+        return;
+
+    ActiveWriter writer (activeWriters, capturing);
+    if (! writer.active)
+        return;
+
+    writeGapIfPending();
+    const auto blockIndex = nextBlockIndex++;
+    blockOpen = false;
+
+    parameterChanges.clear();
+    const auto& parameters = processor.getParameters();
+    const int numParameters = juce::jmin (parameters.size(), static_cast<int> (lastParameterValues.size()));
+    for (int i = 0; i < numParameters; ++i)
+    {
+        const float value = parameters[i]->getValue();
+        if (! (value == lastParameterValues[static_cast<size_t> (i)]))
+            parameterChanges.emplace_back (i, value);
+    }
+
+    PositionRecord position;
+    if (auto* playHead = processor.getPlayHead())
+        if (auto info = playHead->getPosition())
+            position = makePositionRecord (*info);
+
+    BlockRecord block;
+    block.index = blockIndex;
+    block.numSamples = numSamples;
+    block.numChannels = juce::jmin (numInputChannels, buffer.getNumChannels());
+    block.numParameterChanges = static_cast<std::int32_t> (parameterChanges.size());
+    for (const auto metadata : midi)
+    {
+        ++block.numMidiEvents;
+        block.midiBytes += metadata.numBytes;
+    }
+
+    const size_t payloadBytes = sizeof (BlockRecord) + sizeof (PositionRecord)
+                                + static_cast<size_t> (block.numParameterChanges) * sizeof (ParameterChange)
+                                + static_cast<size_t> (block.numMidiEvents) * sizeof (MidiEventHeader)
+                                + static_cast<size_t> (block.midiBytes)
+                                + static_cast<size_t> (block.numChannels) * static_cast<size_t> (numSamples) * sizeof (float);
+    if (! reserve (payloadBytes))
+    {
+        ++pendingDroppedRecords;
+        return;
+    }
+
+    RingWriter record (*this, RecordType::block, payloadBytes);
+    record.put (&block, sizeof (block));
+    record.put (&position, sizeof (position));
+
+    for (const auto& change : parameterChanges)
+    {
+        const ParameterChange entry { change.first, change.second };
+        record.put (&entry, sizeof (entry));
+        lastParameterValues[static_cast<size_t> (change.first)] = change.second;
+    }
+
+    for (const auto metadata : midi)
+    {
+        const MidiEventHeader event { metadata.samplePosition, metadata.numBytes };
+        record.put (&event, sizeof (event));
+        record.put (metadata.data, static_cast<size_t> (metadata.numBytes));
+    }
+
+    for (int ch = 0; ch < block.numChannels; ++ch)
+        record.put (buffer.getReadPointer (ch), static_cast<size_t> (numSamples) * sizeof (float));
+
+    blockOpen = true;
+}
+
+void SessionCapture::addCommand (const void* data, size_t numBytes) noexcept
+{
+    ActiveWriter writer (activeWriters, capturing);
+    if (! writer.active)
+        return;
+
+    writeGapIfPending();
+    if (! reserve (numBytes))
+    {
+        ++pendingDroppedRecords;
+        return;
+    }
+
+    RingWriter record (*this, RecordType::command, numBytes);
+    record.put (data, numBytes);
+}
+
+void SessionCapture::endBlock (const juce::AudioBuffer<float>& buffer) noexcept
+{
+    ActiveWriter writer (activeWriters, capturing);
+    if (! writer.active || ! blockOpen)
+        return;
+
+    blockOpen = false;
+    if (! reserve (sizeof (std::uint64_t)))
+        return;
+
+    const auto hash = hashOutput (buffer);
+    RingWriter record (*this, RecordType::output, sizeof (hash));
+    record.put (&hash, sizeof (hash));
+}
+
+std::uint64_t SessionCapture::hashOutput (const juce::AudioBuffer<float>& buffer) noexcept
+{
+    // FNV-1a over the raw sample bits, so any difference at all shows up.
+    std::uint64_t hash = 14695981039346656037ull;
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        const float* samples = buffer.getReadPointer (ch);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            std::uint32_t bits = 0;
+            std::memcpy (&bits, samples + i, sizeof (bits));
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+    }
+
+    return hash;
+}
+
+bool SessionCapture::Reader::open (const juce::File& file, juce::String& error)
+{
+    stream = std::make_unique<juce::FileInputStream> (file);
+    if (! stream->openedOk())
+    {
+        error = "Could not open " + file.getFullPathName() + ".";
+        return false;
+    }
+
+    if (stream->readInt() != fileMagic || stream->readInt() != fileVersion)
+    {
+        error = file.getFileName() + " is not a session capture from this version.";
+        return false;
+    }
+
+    header = {};
+    header.pluginName = stream->readString();
+    header.sampleRate = stream->readDouble();
+    header.maxBlockSize = stream->readInt();
+    for (auto* channels : { &header.inputBusChannels, &header.outputBusChannels })
+    {
+        const int numBuses = stream->readInt();
+        for (int i = 0; i < numBuses; ++i)
+            channels->add (stream->readInt());
+    }
+    header.numParameters = stream->readInt();
+    header.randomSeed = stream->readInt64();
+
+    const auto stateBytes = stream->readInt64();
+    if (stateBytes < 0 || stateBytes > stream->getNumBytesRemaining())
+    {
+        error = file.getFileName() + " has a damaged header.";
+        return false;
+    }
+
+    header.state.setSize (static_cast<size_t> (stateBytes));
+    stream->read (header.state.getData(), static_cast<int> (stateBytes));
+    return true;
+}
+
+bool SessionCapture::Reader::readNextBlock (Block& block)
+{
+    block.numDroppedBefore = 0;
+    block.parameterChanges.clear();
+    block.commands.clear();
+    block.midi.clear();
+    block.hasPosition = false;
+    block.hasOutputHash = false;
+    bool haveBlock = false;
+
+    juce::MemoryBlock payload;
+    while (stream != nullptr)
+    {
+        const auto recordStart = stream->getPosition();
+        std::uint32_t recordHeader[2] {};
+        if (stream->read (recordHeader, sizeof (recordHeader)) != static_cast<int> (sizeof (recordHeader)))
+            break;
+
+        const auto type = static_cast<RecordType> (recordHeader[0]);
+        const auto size = static_cast<size_t> (recordHeader[1]);
+        if (static_cast<juce::int64> (size) > stream->getNumBytesRemaining())
+            break; // truncated by a crash or a full disk
+
+        // A block without an output record (dropped, or the host returned early) ends here.
+        if (type == RecordType::block && haveBlock)
+        {
+            stream->setPosition (recordStart);
+            return true;
+        }
+
+        payload.setSize (size);
+        stream->read (payload.getData(), static_cast<int> (size));
+        const char* cursor = static_cast<const char*> (payload.getData());
+        const char* end = cursor + size;
+
+        if (type == RecordType::gap)
+        {
+            std::int32_t count = 0;
+            if (readValue (cursor, end, count))
+                block.numDroppedBefore += count;
+        }
+        else if (type == RecordType::command)
+        {
+            block.commands.push_back (payload);
+        }
+        else if (type == RecordType::output)
+        {
+            if (haveBlock && readValue (cursor, end, block.outputHash))
+            {
+                block.hasOutputHash = true;
+                return true;
+            }
+        }
+        else if (type == RecordType::block)
+        {
+            BlockRecord record;
+            PositionRecord position;
+            if (! readValue (cursor, end, record) || ! readValue (cursor, end, position))
+                return false;
+
+            block.index = record.index;
+            block.numSamples = record.numSamples;
+            block.hasPosition = (position.flags & hasPosition) != 0;
+            if (block.hasPosition)
+                block.position = makePositionInfo (position);
+
+            for (int i = 0; i < record.numParameterChanges; ++i)
+            {
+                ParameterChange change;
+                if (! readValue (cursor, end, change))
+                    return false;
+                block.parameterChanges.emplace_back (change.index, change.value);
+            }
+
+            for (int i = 0; i < record.numMidiEvents; ++i)
+            {
+                MidiEventHeader event;
+                if (! readValue (cursor, end, event) || end - cursor < event.numBytes)
+                    return false;
+                block.midi.addEvent (cursor, event.numBytes, event.samplePosition);
+                cursor += event.numBytes;
+            }
+
+            block.input.setSize (record.numChannels, record.numSamples, false, false, true);
+            for (int ch = 0; ch < record.numChannels; ++ch)
+            {
+                const auto bytes = static_cast<size_t> (record.numSamples) * sizeof (float);
+                if (static_cast<size_t> (end - cursor) < bytes)
+                    return false;
+                std::memcpy (block.input.getWritePointer (ch), cursor, bytes);
+                cursor += bytes;
+            }
+
+            haveBlock = true;
+        }
+    }
+
+    return haveBlock;
+}
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+    SessionCapture.h
+    Opt-in recording of a processor's audio callbacks for deterministic replay
+  ==============================================================================
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+/**
+ * SessionCapture - records everything that drives processBlock so a CPU spike seen in a host
+ * can be replayed offline, bit for bit, with timing around every block.
+ *
+ * Capturing is opt-in: set APC_SESSION_CAPTURE_DIR to a folder and every instance writes one
+ * .apccap file per prepareToPlay there. Each block stores its input channels, MIDI, play-head
+ * position and the parameters that changed, followed by any plugin-specific commands applied
+ * during it and a hash of the output, so replay can tell exactly where it first diverges.
+ *
+ * The audio thread serialises into a lock-free ring and never blocks, allocates or touches the
+ * file; a writer thread drains the ring to disk. The ring only exists while capturing, so
+ * instances that never capture cost nothing. A block that does not fit is
+ * dropped and the gap is recorded, and the file stops growing at maxFileBytes.
+ */
+class SessionCapture : private juce::Thread
+{
+public:
+    static constexpr const char* folderVariable = "APC_SESSION_CAPTURE_DIR";
+    static constexpr const char* fileExtension = ".apccap";
+    static constexpr int defaultRingBytes = 32 << 20;
+    static constexpr juce::int64 maxFileBytes = juce::int64 (4) << 30;
+
+    struct Header
+    {
+        juce::String pluginName;
+        double sampleRate = 44100.0;
+        int maxBlockSize = 0;
+        juce::Array<int> inputBusChannels;
+        juce::Array<int> outputBusChannels;
+        int numParameters = 0;
+        // For plugins with randomised DSP; replay seeds the processor with it before prepareToPlay.
+        juce::int64 randomSeed = 0;
+        juce::MemoryBlock state;
+    };
+
+    // One captured processBlock call, as read back by Reader.
+    struct Block
+    {
+        juce::int64 index = 0;
+        int numDroppedBefore = 0;
+        int numSamples = 0;
+        juce::AudioBuffer<float> input;
+        juce::MidiBuffer midi;
+        bool hasPosition = false;
+        juce::AudioPlayHead::PositionInfo position;
+        std::vector<std::pair<int, float>> parameterChanges;
+        std::vector<juce::MemoryBlock> commands;
+        bool hasOutputHash = false;
+        std::uint64_t outputHash = 0;
+    };
+
+    class Reader
+    {
+    public:
+        bool open (const juce::File& file, juce::String& error);
+        const Header& getHeader() const noexcept { return header; }
+
+        // Reads the next block together with the commands applied before or during it.
+        bool readNextBlock (Block& block);
+
+    private:
+        std::unique_ptr<juce::FileInputStream> stream;
+        Header header;
+    };
+
+    explicit SessionCapture (int ringBytes = defaultRingBytes);
+    ~SessionCapture() override;
+
+    // Message thread, audio stopped. Starts a new file for processor in the folder named by
+    // APC_SESSION_CAPTURE_DIR, ending any previous capture; returns false when unset or on error.
+    bool startFromEnvironment (juce::AudioProcessor& processor, double sampleRate, int maxBlockSize, juce::int64 randomSeed = 0);
+    bool start (const juce::File& file, juce::AudioProcessor& processor, const Header& header);
+    void stop();
+
+    // Any thread.
+    bool isCapturing() const noexcept { return capturing.load (std::memory_order_acquire); }
+
+    // Audio thread, at the top of processBlock before the buffer is touched.
+    void beginBlock (juce::AudioProcessor& processor, const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi) noexcept;
+    // Audio thread, or the message thread while audio is stopped. An opaque plugin-specific
+    // command, handed back verbatim on replay.
+    void addCommand (const void* data, size_t numBytes) noexcept;
+    // Audio thread, once the block's output is final.
+    void endBlock (const juce::AudioBuffer<float>& buffer) noexcept;
+
+    static std::uint64_t hashOutput (const juce::AudioBuffer<float>& buffer) noexcept;
+
+private:
+    enum class RecordType : std::uint32_t
+    {
+        block = 1,
+        command,
+        output,
+        gap
+    };
+
+    class RingWriter;
+
+    void run() override;
+    void drainRing();
+    bool reserve (size_t payloadBytes) const noexcept;
+    void writeGapIfPending() noexcept;
+
+    int ringBytes = 0;
+    juce::AbstractFifo ring { 1 };
+    std::vector<char> ringStorage;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    juce::int64 bytesWritten = 0;
+
+    std::atomic<bool> capturing { false };
+    std::atomic<int> activeWriters { 0 };
+
+    // Audio thread only.
+    juce::int64 nextBlockIndex = 0;
+    int pendingDroppedRecords = 0;
+    bool blockOpen = false;
+    int numInputChannels = 0;
+    std::vector<float> lastParameterValues;
+    std::vector<std::pair<int, float>> parameterChanges;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SessionCapture)
+};
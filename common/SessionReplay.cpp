@@ -0,0 +1,284 @@
+#include "SessionReplay.h"
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+namespace
+{
+struct Options
+{
+    juce::File file;
+    int repeats = 1;
+    int worst = 10;
+    juce::File timingsFile;
+};
+
+// Hands the captured position of the block being replayed to the processor.
+class ReplayPlayHead : public juce::AudioPlayHead
+{
+public:
+    std::optional<PositionInfo> getPosition() const override { return position; }
+
+    std::optional<PositionInfo> position;
+};
+
+struct BlockTiming
+{
+    juce::int64 index = 0;
+    int numSamples = 0;
+    double microseconds = 0.0;
+};
+
+struct PassResult
+{
+    bool opened = false;
+    juce::String error;
+    juce::String pluginName;
+    double sampleRate = 0.0;
+    int droppedRecords = 0;
+    int hashedBlocks = 0;
+    juce::int64 firstMismatch = -1;
+    std::vector<BlockTiming> timings;
+};
+
+juce::AudioChannelSet channelSetFor (int numChannels)
+{
+    if (numChannels <= 0)
+        return juce::AudioChannelSet::disabled();
+
+    const auto canonical = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+    return canonical.size() == numChannels ? canonical : juce::AudioChannelSet::discreteChannels (numChannels);
+}
+
+PassResult replayOnce (const juce::File& file, const SessionReplay::Hooks& hooks)
+{
+    PassResult result;
+    SessionCapture::Reader reader;
+    if (! reader.open (file, result.error))
+        return result;
+
+    const auto& header = reader.getHeader();
+    result.opened = true;
+    result.pluginName = header.pluginName;
+    result.sampleRate = header.sampleRate;
+
+    auto processor = hooks.createProcessor();
+    juce::AudioProcessor::BusesLayout layout;
+    for (const auto numChannels : header.inputBusChannels)
+        layout.inputBuses.add (channelSetFor (numChannels));
+    for (const auto numChannels : header.outputBusChannels)
+        layout.outputBuses.add (channelSetFor (numChannels));
+
+    if (! processor->setBusesLayout (layout))
+    {
+        result.opened = false;
+        result.error = "The processor rejected the captured bus layout.";
+        return result;
+    }
+
+    processor->setRateAndBufferSizeDetails (header.sampleRate, header.maxBlockSize);
+    if (header.state.getSize() > 0)
+        processor->setStateInformation (header.state.getData(), static_cast<int> (header.state.getSize()));
+    if (hooks.prepare)
+        hooks.prepare (*processor, header);
+
+    ReplayPlayHead playHead;
+    processor->setPlayHead (&playHead);
+    processor->setNonRealtime (false);
+    processor->prepareToPlay (header.sampleRate, header.maxBlockSize);
+
+    const auto& parameters = processor->getParameters();
+    const int numChannels = juce::jmax (processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+    juce::AudioBuffer<float> buffer (numChannels, juce::jmax (1, header.maxBlockSize));
+    juce::MidiBuffer midi;
+
+    SessionCapture::Block block;
+    while (reader.readNextBlock (block))
+    {
+        result.droppedRecords += block.numDroppedBefore;
+
+        for (const auto& [index, value] : block.parameterChanges)
+            if (juce::isPositiveAndBelow (index, parameters.size()))
+                parameters[index]->setValue (value);
+
+        if (hooks.applyCommand)
+            for (const auto& command : block.commands)
+                hooks.applyCommand (*processor, command);
+
+        playHead.position.reset();
+        if (block.hasPosition)
+            playHead.position = block.position;
+
+        // Hosts may pass longer blocks than announced; grow rather than truncate.
+        buffer.setSize (numChannels, block.numSamples, false, false, true);
+        buffer.clear();
+        for (int ch = 0; ch < juce::jmin (numChannels, block.input.getNumChannels()); ++ch)
+            buffer.copyFrom (ch, 0, block.input, ch, 0, block.numSamples);
+        midi = block.midi;
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor->processBlock (buffer, midi);
+        const auto ticks = juce::Time::getHighResolutionTicks() - start;
+
+        result.timings.push_back ({ block.index, block.numSamples, 1.0e6 * juce::Time::highResolutionTicksToSeconds (ticks) });
+
+        if (block.hasOutputHash)
+        {
+            ++result.hashedBlocks;
+            if (result.firstMismatch < 0 && SessionCapture::hashOutput (buffer) != block.outputHash)
+                result.firstMismatch = block.index;
+        }
+    }
+
+    processor->releaseResources();
+    processor->setPlayHead (nullptr);
+    return result;
+}
+
+double budgetMicroseconds (const BlockTiming& timing, double sampleRate)
+{
+    return 1.0e6 * static_cast<double> (timing.numSamples) / juce::jmax (1.0, sampleRate);
+}
+
+bool parseOptions (int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--repeat" && hasValue)
+            options.repeats = juce::jlimit (1, 1000, juce::String (argv[++i]).getIntValue());
+        else if (arg == "--worst" && hasValue)
+            options.worst = juce::jlimit (0, 100000, juce::String (argv[++i]).getIntValue());
+        else if (arg == "--timings" && hasValue)
+            options.timingsFile = juce::File::getCurrentWorkingDirectory().getChildFile (argv[++i]);
+        else if (arg.startsWith ("--") || options.file != juce::File())
+            return false;
+        else
+            options.file = juce::File::getCurrentWorkingDirectory().getChildFile (arg);
+    }
+
+    return options.file != juce::File();
+}
+
+void printUsage (const char* toolName)
+{
+    std::cout << "Usage: " << toolName << " <capture" << SessionCapture::fileExtension << "> [--repeat N] [--worst N] [--timings <csv>]\n"
+                 "  Replays a session captured with " << SessionCapture::folderVariable << " set, timing every\n"
+                 "  processBlock call and checking each block's output against the capture. --repeat keeps\n"
+                 "  the fastest of N passes per block to filter out scheduler noise, --worst lists the N\n"
+                 "  slowest blocks and --timings writes every block's time to a CSV file.\n";
+}
+} // namespace
+
+namespace SessionReplay
+{
+int runCommandLine (int argc, char* argv[], const char* toolName, const Hooks& hooks)
+{
+    Options options;
+    if (! parseOptions (argc, argv, options))
+    {
+        printUsage (toolName);
+        return 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    PassResult first;
+    std::vector<double> fastest;
+    juce::int64 firstMismatch = -1;
+    for (int pass = 0; pass < options.repeats; ++pass)
+    {
+        auto result = replayOnce (options.file, hooks);
+        if (! result.opened)
+        {
+            std::cout << "{\"path\":" << juce::JSON::toString (juce::var (options.file.getFullPathName()))
+                      << ",\"success\":false,\"message\":" << juce::JSON::toString (juce::var (result.error)) << "}" << std::endl;
+            return 1;
+        }
+
+        if (firstMismatch < 0)
+            firstMismatch = result.firstMismatch;
+
+        if (pass == 0)
+        {
+            for (const auto& timing : result.timings)
+                fastest.push_back (timing.microseconds);
+            first = std::move (result);
+            continue;
+        }
+
+        for (size_t b = 0; b < juce::jmin (fastest.size(), result.timings.size()); ++b)
+            fastest[b] = juce::jmin (fastest[b], result.timings[b].microseconds);
+    }
+
+    for (size_t b = 0; b < fastest.size(); ++b)
+        first.timings[b].microseconds = fastest[b];
+
+    std::vector<double> sorted (fastest);
+    std::sort (sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (const auto value : sorted)
+        total += value;
+
+    const auto percentile = [&sorted] (double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+        return sorted[juce::jmin (sorted.size() - 1, static_cast<size_t> (fraction * static_cast<double> (sorted.size())))];
+    };
+
+    double maxLoad = 0.0;
+    for (const auto& timing : first.timings)
+        maxLoad = juce::jmax (maxLoad, timing.microseconds / budgetMicroseconds (timing, first.sampleRate));
+
+    const bool bitExact = firstMismatch < 0;
+    std::cout << "{\"path\":" << juce::JSON::toString (juce::var (options.file.getFullPathName()))
+              << ",\"success\":true"
+              << ",\"plugin\":" << juce::JSON::toString (juce::var (first.pluginName))
+              << ",\"blocks\":" << first.timings.size()
+              << ",\"droppedRecords\":" << first.droppedRecords
+              << ",\"repeats\":" << options.repeats
+              << ",\"bitExact\":" << (bitExact ? "true" : "false")
+              << ",\"hashedBlocks\":" << first.hashedBlocks
+              << ",\"firstMismatchBlock\":" << firstMismatch
+              << ",\"meanMicroseconds\":" << juce::String (sorted.empty() ? 0.0 : total / static_cast<double> (sorted.size()), 3)
+              << ",\"p99Microseconds\":" << juce::String (percentile (0.99), 3)
+              << ",\"maxMicroseconds\":" << juce::String (sorted.empty() ? 0.0 : sorted.back(), 3)
+              << ",\"maxLoad\":" << juce::String (maxLoad, 4) << "}" << std::endl;
+
+    auto worst = first.timings;
+    const auto count = static_cast<size_t> (juce::jmin (options.worst, static_cast<int> (worst.size())));
+    std::partial_sort (worst.begin(), worst.begin() + static_cast<std::ptrdiff_t> (count), worst.end(),
+                       [] (const BlockTiming& a, const BlockTiming& b) { return a.microseconds > b.microseconds; });
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& timing = worst[i];
+        std::cout << "{\"block\":" << timing.index
+                  << ",\"samples\":" << timing.numSamples
+                  << ",\"microseconds\":" << juce::String (timing.microseconds, 3)
+                  << ",\"load\":" << juce::String (timing.microseconds / budgetMicroseconds (timing, first.sampleRate), 4) << "}" << std::endl;
+    }
+
+    if (options.timingsFile != juce::File())
+    {
+        juce::String csv ("block,samples,microseconds,budgetMicroseconds\n");
+        for (const auto& timing : first.timings)
+            csv << timing.index << "," << timing.numSamples << "," << juce::String (timing.microseconds, 3)
+                << "," << juce::String (budgetMicroseconds (timing, first.sampleRate), 3) << "\n";
+
+        if (! options.timingsFile.replaceWithText (csv))
+        {
+            std::cerr << "Could not write " << options.timingsFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    return bitExact ? 0 : 2;
+}
+} // namespace SessionReplay
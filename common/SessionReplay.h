@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+    SessionReplay.h
+    Offline, timed replay of a SessionCapture file
+  ==============================================================================
+*/
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "SessionCapture.h"
+
+/**
+ * SessionReplay - the shared body of each plugin's replay tool.
+ *
+ * A fresh processor is created for every pass, given the captured bus layout, sample rate,
+ * state and (through the prepare hook) random seed, and then fed the captured blocks in order
+ * with their parameter changes, commands, MIDI and play-head positions. Only processBlock is
+ * timed. Every block's output is hashed and compared with the capture, so a replay that is not
+ * bit-exact reports the first block where it diverged rather than timing something else.
+ */
+namespace SessionReplay
+{
+struct Hooks
+{
+    std::function<std::unique_ptr<juce::AudioProcessor>()> createProcessor;
+    // Called after the state is restored and before prepareToPlay.
+    std::function<void (juce::AudioProcessor&, const SessionCapture::Header&)> prepare;
+    std::function<void (juce::AudioProcessor&, const juce::MemoryBlock&)> applyCommand;
+};
+
+// Parses "<file> [--repeat N] [--worst N] [--timings <csv>]", replays the file and prints a
+// JSON summary line followed by one line per slowest block. Returns 0 when every pass was
+// bit-exact, 2 when an output differed and 1 on a usage or file error.
+int runCommandLine (int argc, char* argv[], const char* toolName, const Hooks& hooks);
+} // namespace SessionReplay
@@ -184,15 +184,22 @@ void BassicAudioProcessor::changeProgramName (int, const juce::String&) {}
 
 void BassicAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    juce::ignoreUnused (samplesPerBlock);
+    if (monoVoice != nullptr)
+        monoVoice->setRandomSeed (randomSeed);
     synth.setCurrentPlaybackSampleRate (sampleRate);
     heldNotes.fill (false);
     heldVelocities.fill (0.0f);
     heldOrder.clear();
     activeExternalNote = -1;
+
+    if (sessionCaptureEnabled)
+        sessionCapture.startFromEnvironment (*this, sampleRate, samplesPerBlock, randomSeed);
 }
 
-void BassicAudioProcessor::releaseResources() {}
+void BassicAudioProcessor::releaseResources()
+{
+    sessionCapture.stop();
+}
 
 bool BassicAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
@@ -215,6 +222,7 @@ void BassicAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce:
     if (numSamples <= 0)
         return;
 
+    sessionCapture.beginBlock (*this, buffer, midiMessages);
     buffer.clear();
 
     juce::MidiBuffer perfMidi;
@@ -275,6 +283,7 @@ void BassicAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce:
     }
 
     synth.renderNextBlock (buffer, perfMidi, 0, numSamples);
+    sessionCapture.endBlock (buffer);
 }
 
 bool BassicAudioProcessor::hasEditor() const { return true; }
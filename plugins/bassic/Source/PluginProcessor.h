@@ -6,6 +6,8 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include "SessionCapture.h"
+
 class BassicAudioProcessor : public juce::AudioProcessor
 {
 public:
@@ -36,6 +38,12 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // Message thread, before prepareToPlay. Seeds the voice's analog drift so a captured session
+    // replays bit for bit; every instance starts with a random one.
+    void setRandomSeed (juce::int64 seed) noexcept { randomSeed = seed; }
+    // Message thread, before prepareToPlay. The replay tool turns capture off for its own runs.
+    void setSessionCaptureEnabled (bool enabled) noexcept { sessionCaptureEnabled = enabled; }
+
     juce::AudioProcessorValueTreeState parameters;
 
 private:
@@ -61,6 +69,7 @@ private:
         void setCurrentPlaybackSampleRate (double newRate) override;
         void setLegatoTransition (bool isLegato) noexcept { legatoTransition = isLegato; }
         void setFilterDriftSeed (float cutoffVarianceInPercent) noexcept { cutoffVariancePercent = cutoffVarianceInPercent; }
+        void setRandomSeed (juce::int64 seed) noexcept { random.setSeed (seed); }
 
     private:
         struct ExpEnvelope
@@ -165,6 +174,10 @@ private:
     std::vector<int> heldOrder;
     int activeExternalNote = -1;
 
+    juce::int64 randomSeed = juce::Random::getSystemRandom().nextInt64();
+    SessionCapture sessionCapture;
+    bool sessionCaptureEnabled = true;
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     void removeHeldNote (int note);
 
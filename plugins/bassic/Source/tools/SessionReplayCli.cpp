@@ -0,0 +1,16 @@
+#include "../PluginProcessor.h"
+#include "SessionReplay.h"
+
+int main (int argc, char* argv[])
+{
+    SessionReplay::Hooks hooks;
+    hooks.createProcessor = [] { return std::make_unique<BassicAudioProcessor>(); };
+    hooks.prepare = [] (juce::AudioProcessor& processor, const SessionCapture::Header& header)
+    {
+        auto& bassic = static_cast<BassicAudioProcessor&> (processor);
+        bassic.setSessionCaptureEnabled (false);
+        bassic.setRandomSeed (header.randomSeed);
+    };
+
+    return SessionReplay::runCommandLine (argc, argv, "bassic_replay", hooks);
+}
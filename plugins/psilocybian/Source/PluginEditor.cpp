@@ -10,17 +10,17 @@
 
 namespace
 {
-template <size_t N>
-juce::String makeJsFloatArray (const std::array<float, N>& values)
+template <typename Container>
+juce::String makeJsFloatArray (const Container& values, int decimals = 6)
 {
     juce::String out = "[";
-    for (size_t i = 0; i < N; ++i)
+    for (size_t i = 0; i < values.size(); ++i)
     {
         if (i > 0)
             out << ",";
 
         const float v = values[i];
-        out << juce::String (std::isfinite (v) ? v : 0.0f, 6);
+        out << juce::String (std::isfinite (v) ? v : 0.0f, decimals);
     }
 
     out << "]";
@@ -101,12 +101,12 @@ void SpecraumAudioProcessorEditor::timerCallback()
     if (webView == nullptr)
         return;
 
-    const auto spectrum = processorRef.getSpectrumSnapshot();
-    const auto oscilloscope = processorRef.getOscilloscopeSnapshot();
-    const auto oscilloscopeRight = processorRef.getOscilloscopeSnapshotRight();
+    processorRef.updateDerivedReference();
+    processorRef.getSpectrumSnapshot (spectrumValues);
     const auto reference = processorRef.getReferenceSpectrumSnapshot();
     const auto suppressorFrequencies = processorRef.getResonanceSuppressorFrequencySnapshot();
     const auto suppressorGains = processorRef.getResonanceSuppressorGainSnapshot();
+    processorRef.getFilterResponseSnapshot (filterResponseDb);
     const auto referenceRevision = processorRef.getReferenceSpectrumRevision();
     bool hasReference = processorRef.hasReferenceSpectrumData() || referenceRevision > 0;
     if (! hasReference)
@@ -115,9 +115,23 @@ void SpecraumAudioProcessorEditor::timerCallback()
                                     [] (float value) { return value > 1.0e-6f; });
     }
 
-    const auto arr = makeJsFloatArray (spectrum);
-    const auto oscilloscopeArr = makeJsFloatArray (oscilloscope);
-    const auto oscilloscopeRightArr = makeJsFloatArray (oscilloscopeRight);
+    const auto arr = makeJsFloatArray (spectrumValues);
+
+    // The scope only changes when a full cycle is published; skip resending the
+    // (up to 8192-point) traces otherwise.
+    juce::String oscilloscopeArr = "null";
+    juce::String oscilloscopeRightArr = "null";
+    if (processorRef.getOscilloscopeSequence() != lastOscilloscopeSequence)
+    {
+        std::uint32_t sequence = 0;
+        if (processorRef.getOscilloscopeSnapshot (oscilloscopeLeft, oscilloscopeRight, sequence) > 0)
+        {
+            lastOscilloscopeSequence = sequence;
+            oscilloscopeArr = makeJsFloatArray (oscilloscopeLeft, 4);
+            oscilloscopeRightArr = makeJsFloatArray (oscilloscopeRight, 4);
+        }
+    }
+
     const auto referenceArrForTick = makeJsFloatArray (reference);
     const auto suppressorFrequencyArr = makeJsFloatArray (suppressorFrequencies);
     const auto suppressorGainArr = makeJsFloatArray (suppressorGains);
@@ -134,7 +148,66 @@ void SpecraumAudioProcessorEditor::timerCallback()
 
     webView->evaluateJavascript ("if (window.updateResonanceSuppressor) window.updateResonanceSuppressor("
                                  + suppressorFrequencyArr + ","
-                                 + suppressorGainArr + ");");
+                                 + suppressorGainArr + ","
+                                 + makeJsFloatArray (filterResponseDb, 2) + ");");
+
+    if (processorRef.isStereoFieldEnabled())
+    {
+        processorRef.getStereoFieldSnapshot (stereoCoherence, stereoCorrelation, stereoWidth);
+        webView->evaluateJavascript ("if (window.updateStereoField) window.updateStereoField("
+                                     + makeJsFloatArray (stereoCoherence, 3) + ","
+                                     + makeJsFloatArray (stereoCorrelation, 3) + ","
+                                     + makeJsFloatArray (stereoWidth, 3) + ");");
+    }
+
+    processorRef.getGainReductionSnapshot (gainReductionDb);
+    webView->evaluateJavascript ("if (window.updateGainReduction) window.updateGainReduction("
+                                 + makeJsFloatArray (gainReductionDb, 2) + ");");
+
+    const int numSpectrogramColumns = processorRef.readSpectrogram (nextSpectrogramColumn, spectrogramColumns);
+    if (numSpectrogramColumns > 0)
+        webView->evaluateJavascript ("if (window.updateSpectrogram) window.updateSpectrogram("
+                                     + makeJsFloatArray (spectrogramColumns, 2) + ","
+                                     + juce::String (ReassignedSpectrogram::numBins) + ");");
+
+    const int numMarkerProbePoints = processorRef.readMarkerProbes (nextMarkerProbePoint, markerProbeLevels);
+    if (numMarkerProbePoints > 0)
+        webView->evaluateJavascript ("if (window.updateMarkerProbes) window.updateMarkerProbes("
+                                     + makeJsFloatArray (markerProbeLevels, 1) + ","
+                                     + juce::String (MarkerProbes::maxProbes) + ","
+                                     + juce::String (1000.0 * MarkerProbes::historyIntervalSeconds, 2) + ");");
+
+    float zoomMinHz = 0.0f;
+    float zoomMaxHz = 0.0f;
+    const auto zoomSequence = processorRef.readZoomSpectrum (zoomValues, zoomMinHz, zoomMaxHz);
+    if (zoomSequence != lastZoomSequence)
+    {
+        lastZoomSequence = zoomSequence;
+        webView->evaluateJavascript ("if (window.updateZoomSpectrum) window.updateZoomSpectrum("
+                                     + makeJsFloatArray (zoomValues, 4) + ","
+                                     + juce::String (zoomMinHz, 2) + ","
+                                     + juce::String (zoomMaxHz, 2) + ");");
+    }
+
+    SpectralFeatures::Values features;
+    const auto featuresSequence = processorRef.readSpectralFeatures (features);
+    if (featuresSequence != lastSpectralFeaturesSequence)
+    {
+        lastSpectralFeaturesSequence = featuresSequence;
+        webView->evaluateJavascript ("if (window.updateSpectralFeatures) window.updateSpectralFeatures("
+                                     + juce::String (features.centroidHz, 1) + ","
+                                     + juce::String (features.rolloffHz, 1) + ","
+                                     + juce::String (features.flatness, 4) + ","
+                                     + juce::String (features.flux, 4) + ","
+                                     + makeJsFloatArray (features.chroma, 3) + ");");
+    }
+
+    const auto pitch = processorRef.getPitchReadout();
+    webView->evaluateJavascript ("if (window.updatePitch) window.updatePitch("
+                                 + juce::String (pitch.frequencyHz, 2) + ","
+                                 + juce::String (pitch.midiNote) + ","
+                                 + juce::String (pitch.cents, 1) + ","
+                                 + juce::String (pitch.confidence, 3) + ");");
 
     const auto currentRevision = processorRef.getReferenceSpectrumRevision();
     if (currentRevision != lastReferenceRevision)
@@ -181,6 +254,29 @@ juce::WebBrowserComponent::Options SpecraumAudioProcessorEditor::createWebOption
                 editor.processorRef.setOscilloscopeLengthMode (mode);
                 done (true);
             })
+        .withNativeFunction ("setOscilloscopeResolution",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                int points = OscilloscopeCapture::defaultResolution;
+                if (args.size() > 0 && (args[0].isInt() || args[0].isDouble()))
+                    points = static_cast<int> (args[0]);
+
+                editor.processorRef.setOscilloscopeResolution (points);
+                done (true);
+            })
+        .withNativeFunction ("setOscilloscopeTrigger",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                float level = 0.0f;
+                float windowMs = 20.0f;
+                if (args.size() > 0 && (args[0].isInt() || args[0].isDouble()))
+                    level = static_cast<float> (args[0]);
+                if (args.size() > 1 && (args[1].isInt() || args[1].isDouble()))
+                    windowMs = static_cast<float> (args[1]);
+
+                editor.processorRef.setOscilloscopeTrigger (level, windowMs);
+                done (true);
+            })
         .withNativeFunction ("setSoloBand",
             [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
             {
@@ -194,6 +290,117 @@ juce::WebBrowserComponent::Options SpecraumAudioProcessorEditor::createWebOption
                 editor.processorRef.setSoloBand (bandIndex);
                 done (true);
             })
+        .withNativeFunction ("setLiveReferenceEnabled",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                const bool enabled = args.size() > 0 && static_cast<bool> (args[0]);
+                editor.processorRef.setLiveReferenceEnabled (enabled);
+                done (true);
+            })
+        .withNativeFunction ("setAutoReferenceEnabled",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                const bool enabled = args.size() > 0 && static_cast<bool> (args[0]);
+                editor.processorRef.setAutoReferenceEnabled (enabled);
+                done (true);
+            })
+        .withNativeFunction ("setAnalyzerSmoothing",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                int octaveFraction = FractionalOctaveSmoother::defaultFraction;
+                if (args.size() > 0)
+                {
+                    if (args[0].isInt() || args[0].isDouble())
+                        octaveFraction = static_cast<int> (args[0]);
+                    else if (args[0].isString())
+                        octaveFraction = args[0].toString().getIntValue();
+                }
+
+                editor.processorRef.setAnalyzerSmoothingFraction (octaveFraction);
+                done (editor.processorRef.getAnalyzerSmoothingFraction());
+            })
+        .withNativeFunction ("setSpectrumResolution",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                int numBins = SpecraumAudioProcessor::spectrumBins;
+                if (args.size() > 0)
+                {
+                    if (args[0].isInt() || args[0].isDouble())
+                        numBins = static_cast<int> (args[0]);
+                    else if (args[0].isString())
+                        numBins = args[0].toString().getIntValue();
+                }
+
+                editor.processorRef.setSpectrumResolution (numBins);
+                done (editor.processorRef.getSpectrumResolution());
+            })
+        .withNativeFunction ("setSpectrogramMode",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                int mode = 0;
+                if (args.size() > 0 && (args[0].isInt() || args[0].isDouble()))
+                    mode = static_cast<int> (args[0]);
+
+                editor.processorRef.setSpectrogramMode (mode);
+                done (true);
+            })
+        .withNativeFunction ("setSpectralFeaturesEnabled",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                const bool enabled = args.size() > 0 && static_cast<bool> (args[0]);
+                editor.processorRef.setSpectralFeaturesEnabled (enabled);
+                done (true);
+            })
+        .withNativeFunction ("setStereoFieldEnabled",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                const bool enabled = args.size() > 0 && static_cast<bool> (args[0]);
+                editor.processorRef.setStereoFieldEnabled (enabled);
+                done (true);
+            })
+        .withNativeFunction ("setRtaMode",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                int mode = 0;
+                if (args.size() > 0 && (args[0].isInt() || args[0].isDouble()))
+                    mode = static_cast<int> (args[0]);
+
+                editor.processorRef.setRtaMode (mode);
+                done (true);
+            })
+        .withNativeFunction ("setMarkerProbe",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                int index = -1;
+                bool enabled = false;
+                float frequencyHz = 0.0f;
+                float bandwidthHz = MarkerProbes::Probe().bandwidthHz;
+                if (args.size() > 0 && (args[0].isInt() || args[0].isDouble()))
+                    index = static_cast<int> (args[0]);
+                if (args.size() > 1)
+                    enabled = static_cast<bool> (args[1]);
+                if (args.size() > 2 && (args[2].isInt() || args[2].isDouble()))
+                    frequencyHz = static_cast<float> (args[2]);
+                if (args.size() > 3 && (args[3].isInt() || args[3].isDouble()))
+                    bandwidthHz = static_cast<float> (args[3]);
+
+                editor.processorRef.setMarkerProbe (index, enabled, frequencyHz, bandwidthHz);
+                done (true);
+            })
+        .withNativeFunction ("setZoomRange",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                float minHz = 0.0f;
+                float maxHz = 0.0f;
+                if (args.size() > 1 && (args[0].isInt() || args[0].isDouble()) && (args[1].isInt() || args[1].isDouble()))
+                {
+                    minHz = static_cast<float> (args[0]);
+                    maxHz = static_cast<float> (args[1]);
+                }
+
+                editor.processorRef.setZoomRange (minHz, maxHz);
+                done (true);
+            })
         .withNativeFunction ("setReferenceSpectrum",
             [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
             {
@@ -248,6 +455,23 @@ juce::WebBrowserComponent::Options SpecraumAudioProcessorEditor::createWebOption
                     tiltDb);
                 done (true);
             })
+        .withNativeFunction ("setMatchEqConfig",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                bool enabled = false;
+                int phaseMode = static_cast<int> (MatchEq::Phase::linear);
+                float amount = 1.0f;
+
+                if (args.size() > 0)
+                    enabled = static_cast<bool> (args[0]);
+                if (args.size() > 1 && (args[1].isInt() || args[1].isDouble()))
+                    phaseMode = static_cast<int> (args[1]);
+                if (args.size() > 2 && (args[2].isInt() || args[2].isDouble()))
+                    amount = static_cast<float> (args[2]);
+
+                editor.processorRef.setMatchEqConfig (enabled, phaseMode, amount);
+                done (editor.processorRef.getLatencySamples());
+            })
         .withNativeFunction ("buildSmoothPresetFromFolder",
             [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
             {
@@ -330,6 +554,45 @@ juce::WebBrowserComponent::Options SpecraumAudioProcessorEditor::createWebOption
                         done (success);
                     });
             })
+        .withNativeFunction ("requestLoudnessTimeline",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                int level = 0;
+                if (args.size() > 0 && (args[0].isInt() || args[0].isDouble()))
+                    level = juce::jlimit (0, LoudnessTimeline::numLevels - 1, static_cast<int> (args[0]));
+
+                auto& points = editor.loudnessTimelinePoints;
+                const int numPoints = editor.processorRef.getLoudnessTimeline (level, points);
+                if (editor.webView != nullptr)
+                {
+                    std::vector<float> momentary (points.size());
+                    std::vector<float> shortTerm (points.size());
+                    std::vector<float> peak (points.size());
+                    for (size_t i = 0; i < points.size(); ++i)
+                    {
+                        momentary[i] = points[i].momentaryLufs;
+                        shortTerm[i] = points[i].shortTermLufs;
+                        peak[i] = points[i].peakDb;
+                    }
+
+                    editor.webView->evaluateJavascript (
+                        "if (window.updateLoudnessTimeline) window.updateLoudnessTimeline("
+                        + juce::String (level) + ","
+                        + juce::String (LoudnessTimeline::getSecondsPerPoint (level), 1) + ","
+                        + makeJsFloatArray (momentary, 2) + ","
+                        + makeJsFloatArray (shortTerm, 2) + ","
+                        + makeJsFloatArray (peak, 2) + ");");
+                }
+
+                done (numPoints);
+            })
+        .withNativeFunction ("resetLoudnessTimeline",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                juce::ignoreUnused (args);
+                editor.processorRef.resetLoudnessTimeline();
+                done (true);
+            })
         .withNativeFunction ("clearSmoothPreset",
             [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
             {
@@ -338,6 +601,71 @@ juce::WebBrowserComponent::Options SpecraumAudioProcessorEditor::createWebOption
                 editor.lastReferenceRevision = (std::numeric_limits<std::uint32_t>::max)();
                 done (true);
             })
+        .withNativeFunction ("setReferenceLibrary",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                // Keys and curves arrive as parallel arrays; entries without a full curve are skipped.
+                juce::StringArray keys;
+                std::vector<ReferenceCurveIndex::Curve> curves;
+                auto* keyValues = args.size() > 0 ? args[0].getArray() : nullptr;
+                auto* curveValues = args.size() > 1 ? args[1].getArray() : nullptr;
+                if (keyValues != nullptr && curveValues != nullptr)
+                {
+                    const int num = juce::jmin (keyValues->size(), curveValues->size());
+                    curves.reserve (static_cast<size_t> (num));
+                    for (int n = 0; n < num; ++n)
+                    {
+                        auto* values = curveValues->getReference (n).getArray();
+                        if (values == nullptr || values->size() < ReferenceCurveIndex::numPoints)
+                            continue;
+
+                        ReferenceCurveIndex::Curve curve {};
+                        for (int i = 0; i < ReferenceCurveIndex::numPoints; ++i)
+                        {
+                            const auto& value = values->getReference (i);
+                            const float parsed = (value.isInt() || value.isDouble()) ? static_cast<float> (value) : 0.0f;
+                            curve[static_cast<size_t> (i)] = juce::jlimit (0.0f, 1.0f, parsed);
+                        }
+
+                        keys.add (keyValues->getReference (n).toString());
+                        curves.push_back (curve);
+                    }
+                }
+
+                editor.referenceIndex.build (curves);
+                editor.referenceKeys = keys;
+                done (editor.referenceIndex.getNumCurves());
+            })
+        .withNativeFunction ("findNearestReferences",
+            [&editor] (const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion done)
+            {
+                int count = 5;
+                if (args.size() > 0 && (args[0].isInt() || args[0].isDouble()))
+                    count = juce::jlimit (1, 32, static_cast<int> (args[0]));
+
+                const auto spectrum = editor.processorRef.getLongTermSpectrumSnapshot();
+                const bool hasSignal = std::any_of (spectrum.begin(), spectrum.end(), [] (float v) { return v > 1.0e-6f; });
+                auto& matches = editor.referenceMatches;
+                matches.clear();
+                if (hasSignal)
+                    editor.referenceIndex.findNearest (spectrum, count, matches);
+
+                juce::Array<juce::var> results;
+                for (const auto& match : matches)
+                {
+                    auto* entry = new juce::DynamicObject();
+                    entry->setProperty ("key", editor.referenceKeys[match.index]);
+                    entry->setProperty ("distanceDb", std::round (match.distanceDb * 10.0f) / 10.0f);
+                    results.add (juce::var (entry));
+                }
+
+                if (editor.webView != nullptr)
+                    editor.webView->evaluateJavascript ("if (window.onNearestReferences) window.onNearestReferences("
+                                                        + juce::JSON::toString (juce::var (results), true) + ","
+                                                        + juce::String (hasSignal ? "true" : "false") + ");");
+
+                done (static_cast<int> (matches.size()));
+            })
         .withResourceProvider ([&editor] (const juce::String& url) { return editor.getResource (url); });
 
 #if JUCE_WINDOWS
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "PluginProcessor.h"
+#include "dsp/ReferenceCurveIndex.h"
 #include <cstdint>
 #include <limits>
+#include <vector>
 #include <juce_gui_extra/juce_gui_extra.h>
 
 class SpecraumAudioProcessorEditor : public juce::AudioProcessorEditor,
@@ -21,6 +23,26 @@ private:
     std::unique_ptr<juce::WebBrowserComponent> webView;
     std::unique_ptr<juce::FileChooser> folderChooser;
     std::uint32_t lastReferenceRevision = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t lastOscilloscopeSequence = std::numeric_limits<std::uint32_t>::max();
+    std::vector<float> spectrumValues;
+    StereoFieldAnalyzer::Values stereoCoherence {};
+    StereoFieldAnalyzer::Values stereoCorrelation {};
+    StereoFieldAnalyzer::Values stereoWidth {};
+    GainReductionSpectrum::Values gainReductionDb {};
+    std::array<float, SpecraumAudioProcessor::spectrumBins> filterResponseDb {};
+    std::vector<float> oscilloscopeLeft;
+    std::vector<float> oscilloscopeRight;
+    std::vector<LoudnessTimeline::Point> loudnessTimelinePoints;
+    std::vector<float> spectrogramColumns;
+    std::uint64_t nextSpectrogramColumn = 0;
+    std::vector<float> markerProbeLevels;
+    std::uint64_t nextMarkerProbePoint = 0;
+    std::vector<float> zoomValues;
+    std::uint32_t lastZoomSequence = 0;
+    std::uint32_t lastSpectralFeaturesSequence = 0;
+    ReferenceCurveIndex referenceIndex;
+    juce::StringArray referenceKeys;
+    std::vector<ReferenceCurveIndex::Match> referenceMatches;
     bool fullscreen = false;
     juce::Component::SafePointer<juce::Component> fullscreenTarget;
     juce::Rectangle<int> windowedBounds;
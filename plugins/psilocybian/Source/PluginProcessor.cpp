@@ -1,9 +1,13 @@
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+
+#if ! SPECRAUM_HEADLESS
+ #include "PluginEditor.h"
+#endif
 
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include <juce_audio_formats/juce_audio_formats.h>
@@ -11,6 +15,15 @@
 namespace
 {
 constexpr float kOverlayLiftDb = -6.0f;
+constexpr double kLiveReferenceTimeConstantSeconds = 3.0;
+constexpr double kLiveReferencePublishSeconds = 0.25;
+constexpr double kLiveReferenceSmoothingOctaves = 16.0 / 24.0;
+constexpr float kLiveReferenceMinChange = 1.0e-3f;
+constexpr double kLongTermTimeConstantSeconds = 5.0;
+constexpr float kRetuneFrequencyRatio = 0.001f;
+constexpr float kRetuneGainDb = 0.05f;
+constexpr float kRetuneQRatio = 0.01f;
+constexpr double kSuppressorUpdateSeconds = 0.005;
 
 inline float normToDb (float norm) noexcept
 {
@@ -21,19 +34,31 @@ inline float normToDb (float norm) noexcept
 SpecraumAudioProcessor::SpecraumAudioProcessor()
     : AudioProcessor (BusesProperties()
                       .withInput ("Input", juce::AudioChannelSet::stereo(), true)
+                      .withInput ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
       parameters (*this, nullptr, juce::Identifier ("SpecraumAnalyzer"), createParameterLayout())
 {
+    spectrumSmoother.prepare (linearSpectrumBins);
 }
 
-SpecraumAudioProcessor::~SpecraumAudioProcessor() = default;
+SpecraumAudioProcessor::~SpecraumAudioProcessor()
+{
+    // Curves still in flight are owned by the pending slots and the retire queue.
+    for (auto& command : pendingControls)
+        delete command.curve;
+    freeRetiredReferenceCurves();
+}
 
 juce::AudioProcessorValueTreeState::ParameterLayout SpecraumAudioProcessor::createParameterLayout()
 {
     return {};
 }
 
+#if SPECRAUM_HEADLESS
+const juce::String SpecraumAudioProcessor::getName() const { return "SPECRAUM"; }
+#else
 const juce::String SpecraumAudioProcessor::getName() const { return JucePlugin_Name; }
+#endif
 bool SpecraumAudioProcessor::acceptsMidi() const { return false; }
 bool SpecraumAudioProcessor::producesMidi() const { return false; }
 bool SpecraumAudioProcessor::isMidiEffect() const { return false; }
@@ -46,41 +71,84 @@ void SpecraumAudioProcessor::changeProgramName (int index, const juce::String& n
 
 void SpecraumAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    juce::ignoreUnused (samplesPerBlock);
+    // The audio thread is stopped here, so pending control changes can be applied directly.
+    applyControlCommands();
+
     currentSampleRate.store (sampleRate);
-    updateSpectrumLayout (sampleRate);
-    fftMagnitudeToDbScale = computeFftMagnitudeScale();
+
+    // Spectrum analysis runs at 44.1/48 kHz whatever the session rate; metering, the
+    // oscilloscope and the suppressor stay at the session rate.
+    analysisDecimator.prepare (sampleRate);
+    sideDecimator.prepare (sampleRate);
+    sidechainDecimator.prepare (sampleRate);
+    preSuppressorDecimator.prepare (sampleRate);
+    const double analysisRate = analysisDecimator.getOutputSampleRate();
+    analysisSampleRate.store (analysisRate);
+    updateSpectrumLayout (analysisRate);
+    markerProbes.prepare (analysisRate);
+    thirdOctaveRta.prepare (analysisRate);
+    fftMagnitudeToDbScale = hannWindow->magnitudeScale;
 
     lufsHighPass.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass (sampleRate, 60.0f);
     lufsHighShelf.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf (
         sampleRate, 1500.0f, 0.7071f, juce::Decibels::decibelsToGain (4.0f));
     updateSoloBandFilters (sampleRate);
+    filterResponse.prepare (sampleRate, spectrumDisplays.getBase().getFrequencies().data(), spectrumBins);
     lufsHighPass.reset();
     lufsHighShelf.reset();
     resetSoloBandFilters();
     resetResonanceSuppressor();
     lufsWeightedEnergySum = 0.0;
     lufsWeightedSampleCount = 0.0;
+    loudnessTimeline.prepare (sampleRate);
     rmsSmoothedDb = -96.0f;
     rmsDb.store (-96.0f);
     lufsIntegrated.store (-96.0f);
 
     fifoIndex = 0;
     std::fill (fifo.begin(), fifo.end(), 0.0f);
-    std::fill (fftData.begin(), fftData.end(), 0.0f);
-    std::fill (smoothedSpectrum.begin(), smoothedSpectrum.end(), 0.0f);
-    for (auto& v : spectrumData)
-        v.store (0.0f);
-    for (auto& v : oscilloscopeData)
-        v.store (0.0f);
-    for (auto& v : oscilloscopeDataRight)
-        v.store (0.0f);
-    oscilloscopeLastBin = -1;
-    oscilloscopeQuarterPositionSamples = 0.0;
-    oscilloscopeLastLengthMode = oscilloscopeLengthMode.load (std::memory_order_relaxed);
+    std::fill (sideFifo.begin(), sideFifo.end(), 0.0f);
+    std::fill (sidechainFifo.begin(), sidechainFifo.end(), 0.0f);
+    std::fill (preSuppressorFifo.begin(), preSuppressorFifo.end(), 0.0f);
+    preSuppressorMono.assign (static_cast<size_t> (juce::jmax (1, samplesPerBlock)), 0.0f);
+    gainReductionActive = false;
+    gainReduction.reset();
+    stereoField.reset();
+    std::fill (sidechainPowerAverage.begin(), sidechainPowerAverage.end(), 0.0);
+    liveReferenceActive = false;
+    liveReferenceFrames = 0;
+    liveReferenceCurve.hasData = false;
+    liveReferenceSamplesSincePublish = 0;
+    liveReferenceAverageCoefficient = 1.0 - std::exp (-(static_cast<double> (fftSize) / analysisRate) / kLiveReferenceTimeConstantSeconds);
+    liveReferencePublishIntervalSamples = static_cast<int> (kLiveReferencePublishSeconds * analysisRate);
+    std::fill (longTermPowerAverage.begin(), longTermPowerAverage.end(), 0.0);
+    longTermFrames = 0;
+    longTermSamplesSincePublish = 0;
+    longTermAverageCoefficient = 1.0 - std::exp (-(static_cast<double> (fftSize) / analysisRate) / kLongTermTimeConstantSeconds);
+    noiseFloor.prepare (linearSpectrumBins, analysisRate / static_cast<double> (fftSize));
+    noiseFloorSamplesSincePublish = 0;
+    noiseFloorCurve = {};
+    matchEqActive = false;
+    oscilloscopeCapture.prepare (sampleRate);
+
+    // Offline renders outrun the worker, and nothing but the feature stage is read there.
+    analysisWorker.prepare (analysisRate, fftSize, ! isNonRealtime());
+
+    matchEq.prepare (sampleRate, spectrumDisplays.getBase().getFrequencies().data(), spectrumBins);
+    if (matchEqEnabled.load (std::memory_order_relaxed))
+        matchEq.start();
+    setLatencySamples (matchEqEnabled.load (std::memory_order_relaxed) ? MatchEq::getLatencySamples (matchEq.getPhase()) : 0);
+
+    if (sessionCaptureEnabled && sessionCapture.startFromEnvironment (*this, sampleRate, samplesPerBlock))
+        captureControlState();
 }
 
-void SpecraumAudioProcessor::releaseResources() {}
+void SpecraumAudioProcessor::releaseResources()
+{
+    sessionCapture.stop();
+    analysisWorker.stop();
+    matchEq.stop();
+}
 
 bool SpecraumAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
@@ -91,119 +159,391 @@ bool SpecraumAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     if (layouts.getMainInputChannelSet() != layouts.getMainOutputChannelSet())
         return false;
 
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet (true, 1);
+        if (! sidechain.isDisabled()
+            && sidechain != juce::AudioChannelSet::mono()
+            && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
+
     return true;
 }
 
-void SpecraumAudioProcessor::updateSpectrumLayout (double sampleRate) noexcept
+void SpecraumAudioProcessor::updateSpectrumLayout (double sampleRate)
 {
-    spectrumBinPosition = buildSpectrumBinPositions (sampleRate);
+    spectrumDisplays.prepare (sampleRate, fftSize);
+    peakTracker.prepare (sampleRate, fftSize);
+
+    const double binWidthHz = sampleRate / static_cast<double> (fftSize);
+    FractionalOctaveSmoother::computeBands (spectrumDisplays.getBase().getFrequencies().data(),
+                                            spectrumBins,
+                                            binWidthHz,
+                                            kLiveReferenceSmoothingOctaves,
+                                            linearSpectrumBins,
+                                            liveReferenceBands.data());
+}
 
-    const float nyquist = static_cast<float> (sampleRate * 0.5);
-    const float minFreq = 20.0f;
-    const float maxFreq = juce::jlimit (minFreq + 1.0f, nyquist, 20000.0f);
-    const float ratio = maxFreq / minFreq;
-    for (int i = 0; i < spectrumBins; ++i)
+void SpecraumAudioProcessor::pushAnalyserSample (float sample, float sideSample, float sidechainSample, float preSuppressorSample) noexcept
+{
+    fifo[static_cast<size_t> (fifoIndex)] = sample;
+    sideFifo[static_cast<size_t> (fifoIndex)] = sideSample;
+    sidechainFifo[static_cast<size_t> (fifoIndex)] = sidechainSample;
+    preSuppressorFifo[static_cast<size_t> (fifoIndex)] = preSuppressorSample;
+    ++fifoIndex;
+
+    if (fifoIndex >= fftSize)
     {
-        const float t = static_cast<float> (i) / static_cast<float> (spectrumBins - 1);
-        spectrumBinFrequencyHz[static_cast<size_t> (i)] = minFreq * std::pow (ratio, t);
+        buildSpectrumFrame();
+        fifoIndex = 0;
     }
 }
 
-std::array<float, SpecraumAudioProcessor::spectrumBins> SpecraumAudioProcessor::buildSpectrumBinPositions (double sampleRate) noexcept
+void SpecraumAudioProcessor::pushAnalysisChunk (float* samples, float* sideSamples, float* sidechainSamples,
+                                                float* preSuppressorSamples, int numSamples) noexcept
 {
-    std::array<float, spectrumBins> positions {};
-    const float nyquist = static_cast<float> (sampleRate * 0.5);
-    const float minFreq = 20.0f;
-    const float maxFreq = juce::jlimit (minFreq + 1.0f, nyquist, 20000.0f);
-    const float ratio = maxFreq / minFreq;
-    const float fftBinHz = static_cast<float> (sampleRate / static_cast<double> (fftSize));
-    const float maxIndex = static_cast<float> ((fftSize / 2) - 2);
+    const int numDecimated = analysisDecimator.process (samples, numSamples, samples);
+    sideDecimator.process (sideSamples, numSamples, sideSamples);
+    if (liveReferenceActive)
+        sidechainDecimator.process (sidechainSamples, numSamples, sidechainSamples);
+    if (gainReductionActive)
+        preSuppressorDecimator.process (preSuppressorSamples, numSamples, preSuppressorSamples);
+
+    markerProbes.process (samples, numDecimated);
+    thirdOctaveRta.process (samples, numDecimated);
+
+    for (int i = 0; i < numDecimated; ++i)
+        pushAnalyserSample (samples[i],
+                            sideSamples[i],
+                            liveReferenceActive ? sidechainSamples[i] : 0.0f,
+                            gainReductionActive ? preSuppressorSamples[i] : 0.0f);
+
+    analysisWorker.pushSamples (samples, numDecimated);
+}
 
-    for (int i = 0; i < spectrumBins; ++i)
+void SpecraumAudioProcessor::buildSpectrumFrame() noexcept
+{
+    // Mid and side share one FFT. L = M + S and R = M - S, so the mono spectrum and the L/R
+    // auto- and cross-spectra for the stereo field all follow per bin without another transform.
+    // While the suppressor is active, its input is tapped as well and paired with the mid
+    // signal instead, so pre and post share a window and a transform; side then pairs with the
+    // sidechain, or takes the half-size single-frame path.
+    const float* windowTable = hannWindow->values.data();
+    juce::FloatVectorOperations::multiply (analysisFrame.data(), fifo.data(), windowTable, fftSize);
+    juce::FloatVectorOperations::multiply (sideFrame.data(), sideFifo.data(), windowTable, fftSize);
+    if (liveReferenceActive)
+        juce::FloatVectorOperations::multiply (sidechainFrame.data(), sidechainFifo.data(), windowTable, fftSize);
+
+    if (gainReductionActive)
+    {
+        juce::FloatVectorOperations::multiply (preSuppressorFrame.data(), preSuppressorFifo.data(), windowTable, fftSize);
+        analysisFft.computeSpectra (analysisFrame.data(), preSuppressorFrame.data(), midSpectrum.data(), preSuppressorSpectrum.data());
+
+        if (liveReferenceActive)
+        {
+            analysisFft.computeSpectra (sideFrame.data(), sidechainFrame.data(), sideSpectrum.data(), sidechainSpectrum.data());
+            for (size_t k = 0; k < sidechainSpectrum.size(); ++k)
+                sidechainPower[k] = std::norm (sidechainSpectrum[k]);
+        }
+        else
+        {
+            analysisFft.computeSpectrum (sideFrame.data(), sideSpectrum.data());
+        }
+
+        for (size_t k = 0; k < preSuppressorSpectrum.size(); ++k)
+            preSuppressorPower[k] = std::norm (preSuppressorSpectrum[k]);
+    }
+    else
+    {
+        analysisFft.computeSpectra (analysisFrame.data(), sideFrame.data(), midSpectrum.data(), sideSpectrum.data());
+        if (liveReferenceActive)
+            analysisFft.computePowerSpectrum (sidechainFrame.data(), sidechainPower.data());
+    }
+
+    for (size_t k = 0; k < midSpectrum.size(); ++k)
+        linearPower[k] = std::norm (midSpectrum[k]);
+
+    if (stereoFieldRequested)
     {
-        const float t = static_cast<float> (i) / static_cast<float> (spectrumBins - 1);
-        const float f = minFreq * std::pow (ratio, t);
-        const float fftBin = f / fftBinHz;
-        positions[static_cast<size_t> (i)] = juce::jlimit (1.0f, maxIndex, fftBin);
+        for (size_t k = 0; k < midSpectrum.size(); ++k)
+        {
+            const auto left = midSpectrum[k] + sideSpectrum[k];
+            const auto right = midSpectrum[k] - sideSpectrum[k];
+            const auto cross = std::conj (left) * right;
+            leftPower[k] = std::norm (left);
+            rightPower[k] = std::norm (right);
+            crossPowerReal[k] = cross.real();
+            crossPowerImag[k] = cross.imag();
+        }
     }
 
-    return positions;
+    spectrumDisplays.process (spectrumSmoother,
+                              linearPower.data(),
+                              spectrumSmoothingIndex,
+                              fftMagnitudeToDbScale,
+                              spectrumDisplayIndex);
+
+    if (suppressorConfig.enabled)
+        peakTracker.process (linearPower.data(), linearSpectrumBins, fftMagnitudeToDbScale);
+
+    if (stereoFieldRequested)
+        stereoField.process (spectrumSmoother,
+                             leftPower.data(),
+                             rightPower.data(),
+                             crossPowerReal.data(),
+                             crossPowerImag.data(),
+                             spectrumDisplays.getBase().getBands (spectrumSmoothingIndex),
+                             fftMagnitudeToDbScale);
+
+    if (gainReductionActive)
+        gainReduction.process (spectrumSmoother,
+                               preSuppressorPower.data(),
+                               linearPower.data(),
+                               spectrumDisplays.getBase().getBands (spectrumSmoothingIndex),
+                               fftMagnitudeToDbScale);
+
+    publishFilterResponse();
+    analysisWorker.pushSpectrum (linearPower.data());
+
+    if (spectrumFrameCallback != nullptr)
+        spectrumFrameCallback (spectrumDisplays.getBase().getValues());
+
+    if (liveReferenceActive)
+        updateLiveReference();
+    updateLongTermSpectrum();
+    if (autoReferenceRequested || (suppressorConfig.enabled && ! getActiveReferenceCurve().hasData))
+        updateNoiseFloor();
 }
 
-float SpecraumAudioProcessor::computeFftMagnitudeScale()
+void SpecraumAudioProcessor::publishFilterResponse() noexcept
 {
-    std::array<float, fftSize> windowTable {};
-    juce::dsp::WindowingFunction<float>::fillWindowingTables (
-        windowTable.data(),
-        fftSize,
-        juce::dsp::WindowingFunction<float>::hann,
-        true);
+    // The filters that ran on the first channel; the second shares their coefficients.
+    filterResponse.reset();
+    const auto addFilter = [this] (const juce::dsp::IIR::Filter<float>& filter)
+    {
+        if (filter.coefficients != nullptr)
+            filterResponse.addSection (*filter.coefficients);
+    };
+
+    if (suppressorConfig.enabled && getSuppressorCurve().hasData)
+        for (const auto& band : resonanceBands)
+            if (band.currentGainDb < -0.05f)
+                addFilter (band.filters[0]);
+
+    switch (soloBand)
+    {
+        case 0:
+            addFilter (soloLowPass200[0]);
+            break;
+
+        case 1:
+            addFilter (soloHighPass200[0]);
+            addFilter (soloLowPass2k[0]);
+            break;
+
+        case 2:
+            addFilter (soloHighPass2k[0]);
+            addFilter (soloLowPass5k[0]);
+            break;
+
+        case 3:
+            addFilter (soloHighPass5k[0]);
+            break;
 
-    double windowSum = 0.0;
-    for (const auto w : windowTable)
-        windowSum += static_cast<double> (w);
+        default:
+            break;
+    }
 
-    const double coherentGain = windowSum / static_cast<double> (fftSize);
-    const double safeGain = juce::jmax (coherentGain, 1.0e-9);
-    return static_cast<float> (2.0 / (static_cast<double> (fftSize) * safeGain));
+    filterResponse.getResponseDb (filterResponseDb.data());
+    for (size_t i = 0; i < filterResponseDb.size(); ++i)
+        filterResponseData[i].store (filterResponseDb[i], std::memory_order_relaxed);
 }
 
-void SpecraumAudioProcessor::pushAnalyserSample (float sample) noexcept
+void SpecraumAudioProcessor::updateLiveReference() noexcept
 {
-    fifo[static_cast<size_t> (fifoIndex)] = sample;
-    ++fifoIndex;
+    const float powerScale = fftMagnitudeToDbScale * fftMagnitudeToDbScale;
+    double frameEnergy = 0.0;
+    for (const auto p : sidechainPower)
+        frameEnergy += static_cast<double> (p * powerScale);
 
-    if (fifoIndex >= fftSize)
+    // Hold the last reference through silence instead of letting it decay to nothing.
+    if (frameEnergy < 1.0e-9)
+        return;
+
+    const double coefficient = liveReferenceFrames == 0 ? 1.0 : liveReferenceAverageCoefficient;
+    for (size_t k = 0; k < sidechainPowerAverage.size(); ++k)
+        sidechainPowerAverage[k] += coefficient * (static_cast<double> (sidechainPower[k]) - sidechainPowerAverage[k]);
+    ++liveReferenceFrames;
+
+    liveReferenceSamplesSincePublish += fftSize;
+    if (liveReferenceSamplesSincePublish < liveReferencePublishIntervalSamples)
+        return;
+    liveReferenceSamplesSincePublish = 0;
+
+    for (size_t k = 0; k < sidechainPowerAverage.size(); ++k)
+        sidechainPower[k] = static_cast<float> (sidechainPowerAverage[k]);
+    spectrumSmoother.process (sidechainPower.data(), liveReferenceBands.data(), spectrumBins, liveReferencePower.data());
+
+    float maxChange = 0.0f;
+    std::array<float, spectrumBins> next {};
+    for (int i = 0; i < spectrumBins; ++i)
     {
-        buildSpectrumFrame();
-        fifoIndex = 0;
+        const auto idx = static_cast<size_t> (i);
+        const float amplitude = std::sqrt (liveReferencePower[idx]) * fftMagnitudeToDbScale;
+        const float dB = juce::Decibels::gainToDecibels (amplitude, -120.0f);
+        next[idx] = juce::jlimit (0.0f, 1.0f, juce::jmap (dB, -96.0f, 0.0f, 0.0f, 1.0f));
+        maxChange = juce::jmax (maxChange, std::abs (next[idx] - getActiveReferenceCurve().bins[idx]));
     }
+
+    if (maxChange < kLiveReferenceMinChange && liveReferenceCurve.hasData)
+        return;
+
+    liveReferenceCurve.bins = next;
+    liveReferenceCurve.hasData = true;
+    postDerivedReference (next, true);
 }
 
-void SpecraumAudioProcessor::buildSpectrumFrame() noexcept
+void SpecraumAudioProcessor::updateNoiseFloor() noexcept
 {
-    std::fill (fftData.begin(), fftData.end(), 0.0f);
-    std::copy (fifo.begin(), fifo.end(), fftData.begin());
-    window.multiplyWithWindowingTable (fftData.data(), fftSize);
-    fft.performFrequencyOnlyForwardTransform (fftData.data());
+    const float powerScale = fftMagnitudeToDbScale * fftMagnitudeToDbScale;
+    double frameEnergy = 0.0;
+    for (const auto p : linearPower)
+        frameEnergy += static_cast<double> (p * powerScale);
 
-    const int maxIndex = (fftSize / 2) - 1;
-    auto readMagnitude = [&] (float fftBin) -> float
+    // Digital silence between takes would otherwise become the floor.
+    if (frameEnergy < 1.0e-9)
+        return;
+
+    noiseFloor.process (linearPower.data());
+
+    noiseFloorSamplesSincePublish += fftSize;
+    if (noiseFloorSamplesSincePublish < liveReferencePublishIntervalSamples || ! noiseFloor.isReady())
+        return;
+    noiseFloorSamplesSincePublish = 0;
+
+    spectrumSmoother.process (noiseFloor.getFloor(), liveReferenceBands.data(), spectrumBins, noiseFloorBandPower.data());
+    for (int i = 0; i < spectrumBins; ++i)
     {
-        const float clamped = juce::jlimit (1.0f, static_cast<float> (maxIndex - 1), fftBin);
-        const int index = static_cast<int> (clamped);
-        const float frac = clamped - static_cast<float> (index);
-        const float magA = fftData[static_cast<size_t> (index)];
-        const float magB = fftData[static_cast<size_t> (juce::jmin (index + 1, maxIndex))];
-        return juce::jmax (0.0f, magA + frac * (magB - magA));
-    };
+        const auto idx = static_cast<size_t> (i);
+        const float amplitude = std::sqrt (noiseFloorBandPower[idx]) * fftMagnitudeToDbScale;
+        const float dB = juce::Decibels::gainToDecibels (amplitude, -120.0f);
+        noiseFloorCurve.bins[idx] = juce::jlimit (0.0f, 1.0f, juce::jmap (dB, -96.0f, 0.0f, 0.0f, 1.0f));
+    }
+    noiseFloorCurve.hasData = true;
+
+    if (autoReferenceRequested)
+        postDerivedReference (noiseFloorCurve.bins, false);
+}
+
+void SpecraumAudioProcessor::postDerivedReference (const std::array<float, spectrumBins>& bins, bool isLive) noexcept
+{
+    const auto revision = derivedReferenceRevision.load (std::memory_order_relaxed);
+    derivedReferenceRevision.store (revision + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    for (size_t i = 0; i < bins.size(); ++i)
+        derivedReferenceData[i].store (bins[i], std::memory_order_relaxed);
+    derivedReferenceIsLive.store (isLive, std::memory_order_relaxed);
+
+    derivedReferenceRevision.store (revision + 2u, std::memory_order_release);
+}
+
+void SpecraumAudioProcessor::updateDerivedReference()
+{
+    const auto revision = derivedReferenceRevision.load (std::memory_order_acquire);
+    if ((revision & 1u) != 0 || revision == lastDerivedReferenceRevision)
+        return;
+
+    std::array<float, spectrumBins> bins {};
+    for (size_t i = 0; i < bins.size(); ++i)
+        bins[i] = derivedReferenceData[i].load (std::memory_order_relaxed);
+    const bool isLive = derivedReferenceIsLive.load (std::memory_order_relaxed);
+
+    // Overwritten while being copied; the next call picks up the newer curve.
+    std::atomic_thread_fence (std::memory_order_acquire);
+    if (derivedReferenceRevision.load (std::memory_order_relaxed) != revision)
+        return;
+    lastDerivedReferenceRevision = revision;
+
+    // A curve posted just before its source was switched off is stale.
+    if (isLive && liveReferenceEnabled.load (std::memory_order_relaxed))
+        submitReferenceCurve (bins, true);
+    else if (! isLive && autoReferenceEnabled.load (std::memory_order_relaxed))
+        publishReferenceSpectrum (bins, true);
+}
+
+const SpecraumAudioProcessor::ReferenceCurve& SpecraumAudioProcessor::getActiveReferenceCurve() const noexcept
+{
+    return liveReferenceActive && liveReferenceCurve.hasData ? liveReferenceCurve : *referenceCurve;
+}
+
+const SpecraumAudioProcessor::ReferenceCurve& SpecraumAudioProcessor::getSuppressorCurve() const noexcept
+{
+    // The noise floor replaces the reference while selected, and stands in while there is none.
+    const auto& reference = getActiveReferenceCurve();
+    if ((autoReferenceRequested || ! reference.hasData) && noiseFloorCurve.hasData)
+        return noiseFloorCurve;
+    return reference;
+}
+
+void SpecraumAudioProcessor::updateLongTermSpectrum() noexcept
+{
+    const float powerScale = fftMagnitudeToDbScale * fftMagnitudeToDbScale;
+    double frameEnergy = 0.0;
+    for (const auto p : linearPower)
+        frameEnergy += static_cast<double> (p * powerScale);
+
+    // Pauses would otherwise pull the long-term average down and boost the noise floor.
+    if (frameEnergy < 1.0e-9)
+        return;
+
+    const double coefficient = longTermFrames == 0 ? 1.0 : longTermAverageCoefficient;
+    for (size_t k = 0; k < longTermPowerAverage.size(); ++k)
+        longTermPowerAverage[k] += coefficient * (static_cast<double> (linearPower[k]) - longTermPowerAverage[k]);
+    ++longTermFrames;
+
+    longTermSamplesSincePublish += fftSize;
+    if (longTermSamplesSincePublish < liveReferencePublishIntervalSamples)
+        return;
+    longTermSamplesSincePublish = 0;
+
+    for (size_t k = 0; k < longTermPowerAverage.size(); ++k)
+        longTermPower[k] = static_cast<float> (longTermPowerAverage[k]);
+    spectrumSmoother.process (longTermPower.data(), liveReferenceBands.data(), spectrumBins, longTermBandPower.data());
 
     for (int i = 0; i < spectrumBins; ++i)
     {
-        const float pos = spectrumBinPosition[static_cast<size_t> (i)];
-        const float centerMag = readMagnitude (pos);
-        const float leftMag = readMagnitude (pos - 0.5f);
-        const float rightMag = readMagnitude (pos + 0.5f);
-        const float blendedMag = centerMag * 0.60f + leftMag * 0.20f + rightMag * 0.20f;
-
-        const float scaledMag = blendedMag * fftMagnitudeToDbScale;
-        const float dB = juce::Decibels::gainToDecibels (scaledMag, -120.0f);
-        const float normalized = juce::jlimit (0.0f, 1.0f, juce::jmap (dB, -96.0f, 0.0f, 0.0f, 1.0f));
-
-        float& smoothed = smoothedSpectrum[static_cast<size_t> (i)];
-        if (normalized >= smoothed)
-            smoothed = smoothed * 0.25f + normalized * 0.75f;
-        else
-            smoothed = smoothed * 0.90f + normalized * 0.10f;
+        const auto idx = static_cast<size_t> (i);
+        const float amplitude = std::sqrt (longTermBandPower[idx]) * fftMagnitudeToDbScale;
+        const float dB = juce::Decibels::gainToDecibels (amplitude, -120.0f);
+        longTermSpectrumData[idx].store (juce::jlimit (0.0f, 1.0f, juce::jmap (dB, -96.0f, 0.0f, 0.0f, 1.0f)),
+                                         std::memory_order_relaxed);
+    }
+
+    if (! matchEqActive)
+        return;
 
-        spectrumData[static_cast<size_t> (i)].store (smoothed, std::memory_order_relaxed);
+    for (int i = 0; i < spectrumBins; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        const float amplitude = std::sqrt (longTermBandPower[idx]) * fftMagnitudeToDbScale;
+        const float liveDb = juce::Decibels::gainToDecibels (amplitude, -120.0f);
+        const float referenceNorm = getActiveReferenceCurve().bins[idx];
+
+        // Points where either curve sits on the display floor carry no usable shape; a cleared
+        // reference therefore flattens the EQ.
+        matchEqDifferenceDb[idx] = (referenceNorm > 0.0f && liveDb > -96.0f) ? normToDb (referenceNorm) - liveDb : 0.0f;
     }
+
+    matchEq.submitDifference (matchEqDifferenceDb.data());
 }
 
 void SpecraumAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
     juce::ScopedNoDenormals noDenormals;
+    sessionCapture.beginBlock (*this, buffer, midiMessages);
+    applyControlCommands();
 
     bool hasHostPpq = false;
     bool hostTransportIsPlaying = false;
@@ -239,66 +579,122 @@ void SpecraumAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (int ch = totalNumInputChannels; ch < totalNumOutputChannels; ++ch)
         buffer.clear (ch, 0, numSamples);
 
-    applyResonanceSuppressorToBuffer (buffer);
+    auto mainBuffer = getBusBuffer (buffer, false, 0);
+    const float* sidechainL = nullptr;
+    const float* sidechainR = nullptr;
+    if (auto* sidechainBus = getBus (true, 1); sidechainBus != nullptr && sidechainBus->isEnabled())
+    {
+        auto sidechainBuffer = getBusBuffer (buffer, true, 1);
+        if (sidechainBuffer.getNumChannels() > 0)
+        {
+            sidechainL = sidechainBuffer.getReadPointer (0);
+            sidechainR = sidechainBuffer.getNumChannels() > 1 ? sidechainBuffer.getReadPointer (1) : sidechainL;
+        }
+    }
+
+    const bool followSidechain = sidechainL != nullptr && liveReferenceRequested;
+    if (followSidechain != liveReferenceActive)
+    {
+        liveReferenceActive = followSidechain;
+        liveReferenceFrames = 0;
+        liveReferenceCurve.hasData = false;
+        liveReferenceSamplesSincePublish = liveReferencePublishIntervalSamples;
+
+        // The sidechain chain only runs while it is followed; restart both so they stay in phase.
+        analysisDecimator.reset();
+        sideDecimator.reset();
+        sidechainDecimator.reset();
+        preSuppressorDecimator.reset();
+    }
+
+    // The suppressor only changes the signal while it has a reference to work against.
+    const bool tapPreSuppressor = suppressorConfig.enabled && getSuppressorCurve().hasData;
+    if (tapPreSuppressor != gainReductionActive)
+    {
+        gainReductionActive = tapPreSuppressor;
+        gainReduction.reset();
+
+        // As for the sidechain, keep the tapped chains in phase.
+        analysisDecimator.reset();
+        sideDecimator.reset();
+        sidechainDecimator.reset();
+        preSuppressorDecimator.reset();
+    }
+
+    // Hosts occasionally exceed the announced block size; samples past the buffer are analysed
+    // as unsuppressed and read as no reduction.
+    const int numPreSuppressorSamples = gainReductionActive ? juce::jmin (numSamples, static_cast<int> (preSuppressorMono.size())) : 0;
+    if (numPreSuppressorSamples > 0)
+    {
+        const float* preL = mainBuffer.getReadPointer (0);
+        const float* preR = mainBuffer.getNumChannels() > 1 ? mainBuffer.getReadPointer (1) : preL;
+        for (int i = 0; i < numPreSuppressorSamples; ++i)
+            preSuppressorMono[static_cast<size_t> (i)] = 0.5f * (preL[i] + preR[i]);
+    }
 
-    const float* inL = buffer.getReadPointer (0);
-    const float* inR = buffer.getNumChannels() > 1 ? buffer.getReadPointer (1) : inL;
-    const int lengthMode = oscilloscopeLengthMode.load (std::memory_order_relaxed);
-    if (lengthMode != oscilloscopeLastLengthMode)
+    if (matchEqRequested != matchEqActive)
     {
-        oscilloscopeLastLengthMode = lengthMode;
-        oscilloscopeLastBin = -1;
-        oscilloscopeQuarterPositionSamples = 0.0;
-        for (auto& v : oscilloscopeData)
-            v.store (0.0f, std::memory_order_relaxed);
-        for (auto& v : oscilloscopeDataRight)
-            v.store (0.0f, std::memory_order_relaxed);
+        matchEqActive = matchEqRequested;
+        // The long-term average is already settled; publish a target from it straight away.
+        longTermSamplesSincePublish = liveReferencePublishIntervalSamples;
+        matchEq.reset();
     }
 
+    applyResonanceSuppressorToBuffer (mainBuffer);
+
+    const float* inL = mainBuffer.getReadPointer (0);
+    const float* inR = mainBuffer.getNumChannels() > 1 ? mainBuffer.getReadPointer (1) : inL;
+    const int lengthMode = oscilloscopeMode;
+
     const float bpm = juce::jlimit (30.0f, 300.0f, currentTempoBpm.load (std::memory_order_relaxed));
     const double samplesPerQuarter = juce::jmax (
         1.0,
         currentSampleRate.load() * (60.0 / static_cast<double> (bpm)));
-    const double cycleQuarterNotes = (lengthMode == 0)
-        ? 1.0
-        : juce::jlimit (1.0, 16.0, hostQuarterNotesPerBar);
+    const double cycleQuarterNotes = (lengthMode == static_cast<int> (OscilloscopeCapture::Mode::bar))
+        ? juce::jlimit (1.0, 16.0, hostQuarterNotesPerBar)
+        : 1.0;
     const double samplesPerCycle = samplesPerQuarter * cycleQuarterNotes;
 
+    OscilloscopeCapture::TempoSync tempoSync;
+    tempoSync.samplesPerCycle = samplesPerCycle;
+    tempoSync.hasHostPosition = hasHostPpq;
     if (hasHostPpq)
     {
         double phaseInCycle = std::fmod (hostPpq, cycleQuarterNotes);
         if (phaseInCycle < 0.0)
             phaseInCycle += cycleQuarterNotes;
-        oscilloscopeQuarterPositionSamples = (phaseInCycle / cycleQuarterNotes) * samplesPerCycle;
+        tempoSync.hostSamplesIntoCycle = (phaseInCycle / cycleQuarterNotes) * samplesPerCycle;
     }
 
+    oscilloscopeCapture.process (inL, inR, numSamples, tempoSync);
+
     double sumSquares = 0.0;
     double weightedSumSquares = 0.0;
+    std::array<float, 256> analysisChunk;
+    std::array<float, 256> sideChunk;
+    std::array<float, 256> sidechainChunk;
+    std::array<float, 256> preSuppressorChunk;
+    size_t analysisChunkSize = 0;
 
     for (int i = 0; i < numSamples; ++i)
     {
         const float mono = 0.5f * (inL[i] + inR[i]);
-        const float oscSampleLeft = juce::jlimit (-1.0f, 1.0f, inL[i]);
-        const float oscSampleRight = juce::jlimit (-1.0f, 1.0f, inR[i]);
-        pushAnalyserSample (mono);
-
-        const double phase = juce::jlimit (0.0, 0.999999, oscilloscopeQuarterPositionSamples / samplesPerCycle);
-        const int bin = juce::jlimit (
-            0,
-            oscilloscopeSamples - 1,
-            static_cast<int> (phase * static_cast<double> (oscilloscopeSamples)));
-
-        oscilloscopeData[static_cast<size_t> (bin)].store (oscSampleLeft, std::memory_order_relaxed);
-        oscilloscopeDataRight[static_cast<size_t> (bin)].store (oscSampleRight, std::memory_order_relaxed);
-        oscilloscopeLastBin = bin;
-        oscilloscopeQuarterPositionSamples += 1.0;
-        while (oscilloscopeQuarterPositionSamples >= samplesPerCycle)
-            oscilloscopeQuarterPositionSamples -= samplesPerCycle;
+        analysisChunk[analysisChunkSize] = mono;
+        sideChunk[analysisChunkSize] = 0.5f * (inL[i] - inR[i]);
+        sidechainChunk[analysisChunkSize] = liveReferenceActive ? 0.5f * (sidechainL[i] + sidechainR[i]) : 0.0f;
+        preSuppressorChunk[analysisChunkSize] = i < numPreSuppressorSamples ? preSuppressorMono[static_cast<size_t> (i)] : mono;
+        if (++analysisChunkSize == analysisChunk.size() || i == numSamples - 1)
+        {
+            pushAnalysisChunk (analysisChunk.data(), sideChunk.data(), sidechainChunk.data(), preSuppressorChunk.data(),
+                               static_cast<int> (analysisChunkSize));
+            analysisChunkSize = 0;
+        }
         sumSquares += static_cast<double> (mono * mono);
 
         float weighted = lufsHighPass.processSample (mono);
         weighted = lufsHighShelf.processSample (weighted);
         weightedSumSquares += static_cast<double> (weighted * weighted);
+        loudnessTimeline.addSample (weighted, juce::jmax (std::abs (inL[i]), std::abs (inR[i])));
     }
 
     const float blockRms = static_cast<float> (std::sqrt (sumSquares / static_cast<double> (numSamples)));
@@ -314,14 +710,25 @@ void SpecraumAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
         static_cast<float> (std::sqrt (integratedMs)), -96.0f) - 0.691f;
     lufsIntegrated.store (integratedLufs, std::memory_order_relaxed);
 
-    applySoloBandToBuffer (buffer);
+    // After the analysis taps, so the long-term spectrum the EQ is designed from never
+    // contains the EQ itself.
+    if (matchEqActive)
+        matchEq.process (mainBuffer);
+
+    applySoloBandToBuffer (mainBuffer);
+    sessionCapture.endBlock (buffer);
 }
 
+#if SPECRAUM_HEADLESS
+bool SpecraumAudioProcessor::hasEditor() const { return false; }
+juce::AudioProcessorEditor* SpecraumAudioProcessor::createEditor() { return nullptr; }
+#else
 bool SpecraumAudioProcessor::hasEditor() const { return true; }
 juce::AudioProcessorEditor* SpecraumAudioProcessor::createEditor()
 {
     return new SpecraumAudioProcessorEditor (*this);
 }
+#endif
 
 void SpecraumAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
@@ -337,43 +744,371 @@ void SpecraumAudioProcessor::setStateInformation (const void* data, int sizeInBy
         parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
 }
 
-std::array<float, SpecraumAudioProcessor::spectrumBins> SpecraumAudioProcessor::getSpectrumSnapshot() const
+int SpecraumAudioProcessor::getSpectrumSnapshot (std::vector<float>& out) const
+{
+    const int resolutionIndex = spectrumResolutionIndex.load (std::memory_order_relaxed);
+    spectrumDisplays.copyPublished (resolutionIndex, out);
+
+    // The editor can open before the first prepareToPlay, when there is no axis to map onto.
+    const float* frequencies = spectrumDisplays.getFrequencies (resolutionIndex);
+    if (frequencies != nullptr && rtaModeIndex.load (std::memory_order_relaxed) != static_cast<int> (ThirdOctaveRta::Weighting::off))
+        thirdOctaveRta.copyDisplay (frequencies, static_cast<int> (out.size()), out.data());
+    return static_cast<int> (out.size());
+}
+
+std::array<float, SpecraumAudioProcessor::spectrumBins> SpecraumAudioProcessor::getReferenceSpectrumSnapshot() const
 {
     std::array<float, spectrumBins> out {};
     for (int i = 0; i < spectrumBins; ++i)
-        out[static_cast<size_t> (i)] = spectrumData[static_cast<size_t> (i)].load (std::memory_order_relaxed);
+        out[static_cast<size_t> (i)] = referenceSpectrumData[static_cast<size_t> (i)].load (std::memory_order_relaxed);
     return out;
 }
 
-std::array<float, SpecraumAudioProcessor::spectrumBins> SpecraumAudioProcessor::getReferenceSpectrumSnapshot() const
+std::array<float, SpecraumAudioProcessor::spectrumBins> SpecraumAudioProcessor::getLongTermSpectrumSnapshot() const
 {
     std::array<float, spectrumBins> out {};
     for (int i = 0; i < spectrumBins; ++i)
-        out[static_cast<size_t> (i)] = referenceSpectrumData[static_cast<size_t> (i)].load (std::memory_order_relaxed);
+        out[static_cast<size_t> (i)] = longTermSpectrumData[static_cast<size_t> (i)].load (std::memory_order_relaxed);
     return out;
 }
 
-std::array<float, SpecraumAudioProcessor::oscilloscopeSamples> SpecraumAudioProcessor::getOscilloscopeSnapshot() const
+int SpecraumAudioProcessor::getOscilloscopeSnapshot (std::vector<float>& left,
+                                                     std::vector<float>& right,
+                                                     std::uint32_t& sequence) const
 {
-    std::array<float, oscilloscopeSamples> out {};
-    for (int i = 0; i < oscilloscopeSamples; ++i)
-        out[static_cast<size_t> (i)] = oscilloscopeData[static_cast<size_t> (i)].load (std::memory_order_relaxed);
+    return oscilloscopeCapture.copyLatestCycle (left, right, sequence);
+}
 
-    return out;
+std::uint32_t SpecraumAudioProcessor::getOscilloscopeSequence() const noexcept
+{
+    return oscilloscopeCapture.getPublishedSequence();
 }
 
-std::array<float, SpecraumAudioProcessor::oscilloscopeSamples> SpecraumAudioProcessor::getOscilloscopeSnapshotRight() const
+void SpecraumAudioProcessor::pushControlCommand (const ControlCommand& command) noexcept
 {
-    std::array<float, oscilloscopeSamples> out {};
-    for (int i = 0; i < oscilloscopeSamples; ++i)
-        out[static_cast<size_t> (i)] = oscilloscopeDataRight[static_cast<size_t> (i)].load (std::memory_order_relaxed);
+    // Control threads serialise here; the audio thread only ever takes the latest values.
+    const juce::SpinLock::ScopedLockType lock (controlProducerLock);
+    freeRetiredReferenceCurves();
+
+    const auto slot = static_cast<size_t> (getControlSlot (command));
+    auto& pending = pendingControls[slot];
+    // A curve the audio thread never picked up is superseded and was never shared.
+    if (pendingControlSet[slot] && pending.curve != command.curve)
+        delete pending.curve;
+
+    pending = command;
+    pendingControlSet[slot] = true;
+    hasPendingControls.store (true, std::memory_order_release);
+}
 
-    return out;
+int SpecraumAudioProcessor::getControlSlot (const ControlCommand& command) noexcept
+{
+    if (command.type == ControlCommand::Type::markerProbe)
+        return ControlCommand::numTypes + juce::jlimit (0, MarkerProbes::maxProbes - 1, command.intValue);
+    return static_cast<int> (command.type);
+}
+
+void SpecraumAudioProcessor::freeRetiredReferenceCurves() noexcept
+{
+    retiredReferenceCurves.drain ([] (ReferenceCurve* curve) { delete curve; });
+}
+
+void SpecraumAudioProcessor::applyControlCommands() noexcept
+{
+    if (! hasPendingControls.load (std::memory_order_acquire))
+        return;
+
+    std::array<ControlCommand, numControlSlots> commands;
+    std::array<bool, numControlSlots> isSet {};
+    {
+        // A control thread holds the lock only while storing one value; whatever it is storing
+        // is picked up by the next block.
+        const juce::SpinLock::ScopedTryLockType lock (controlProducerLock);
+        if (! lock.isLocked())
+            return;
+
+        commands = pendingControls;
+        isSet = pendingControlSet;
+        for (size_t slot = 0; slot < pendingControls.size(); ++slot)
+        {
+            pendingControls[slot].curve = nullptr;
+            pendingControlSet[slot] = false;
+        }
+        hasPendingControls.store (false, std::memory_order_relaxed);
+    }
+
+    for (size_t slot = 0; slot < commands.size(); ++slot)
+    {
+        if (! isSet[slot])
+            continue;
+
+        captureControlCommand (commands[slot]);
+        applyControlCommand (commands[slot]);
+    }
+}
+
+void SpecraumAudioProcessor::captureControlCommand (const ControlCommand& command) noexcept
+{
+    if (! sessionCapture.isCapturing())
+        return;
+
+    CapturedControlCommand captured;
+    captured.type = static_cast<std::int32_t> (command.type);
+    captured.intValue = command.intValue;
+    captured.enabled = command.enabled ? 1 : 0;
+    std::copy (command.values.begin(), command.values.end(), captured.values);
+    if (command.curve != nullptr)
+    {
+        captured.hasCurve = command.curve->hasData ? 1 : 0;
+        std::copy (command.curve->bins.begin(), command.curve->bins.end(), captured.curveBins);
+    }
+
+    sessionCapture.addCommand (&captured, sizeof (captured));
+}
+
+// Audio stopped. Records the control state a new capture starts from, which the host's saved
+// state does not include.
+void SpecraumAudioProcessor::captureControlState() noexcept
+{
+    using Type = ControlCommand::Type;
+
+    auto capture = [this] (Type type, int intValue, bool enabled, std::array<float, 3> values = {})
+    {
+        ControlCommand command;
+        command.type = type;
+        command.intValue = intValue;
+        command.enabled = enabled;
+        command.values = values;
+        command.curve = type == Type::referenceCurve ? referenceCurve.get() : nullptr;
+        captureControlCommand (command);
+    };
+
+    capture (Type::soloBand, soloBand, false);
+    capture (Type::referenceCurve, 0, false);
+    capture (Type::suppressorConfig, 0, suppressorConfig.enabled,
+             { suppressorConfig.overlayLevelDb, suppressorConfig.overlayWidthDb, suppressorConfig.tiltDb });
+    capture (Type::oscilloscopeMode, oscilloscopeMode, false);
+    capture (Type::oscilloscopeResolution, oscilloscopeCapture.getResolution(), false);
+    capture (Type::oscilloscopeTrigger, 0, false,
+             { oscilloscopeCapture.getTriggerLevel(), static_cast<float> (1000.0 * oscilloscopeCapture.getWindowSeconds()), 0.0f });
+    capture (Type::analyzerSmoothing, static_cast<int> (spectrumSmoothingIndex), false);
+    capture (Type::spectrumResolution, spectrumDisplayIndex, false);
+    capture (Type::liveReference, 0, liveReferenceRequested);
+    capture (Type::autoReference, 0, autoReferenceRequested);
+    capture (Type::stereoField, 0, stereoFieldRequested);
+    capture (Type::matchEq, static_cast<int> (matchEq.getPhase()), matchEqRequested, { matchEq.getAmount(), 0.0f, 0.0f });
+    for (int i = 0; i < MarkerProbes::maxProbes; ++i)
+    {
+        const auto& probe = markerProbes.getProbe (i);
+        capture (Type::markerProbe, i, probe.enabled, { probe.frequencyHz, probe.bandwidthHz, 0.0f });
+    }
+    capture (Type::rtaMode, static_cast<int> (thirdOctaveRta.getWeighting()), false);
+}
+
+void SpecraumAudioProcessor::setSessionCaptureEnabled (bool enabled) noexcept
+{
+    sessionCaptureEnabled = enabled;
+}
+
+void SpecraumAudioProcessor::replayControlCommand (const juce::MemoryBlock& data)
+{
+    using Type = ControlCommand::Type;
+
+    CapturedControlCommand captured;
+    if (data.getSize() != sizeof (captured))
+        return;
+
+    // Captures may be damaged or from another build; nothing is trusted, and every command
+    // goes through the setter a control thread would use, which validates it.
+    data.copyTo (&captured, 0, sizeof (captured));
+    if (captured.type < 0 || captured.type >= ControlCommand::numTypes
+        || ! std::all_of (std::begin (captured.values), std::end (captured.values), [] (float v) { return std::isfinite (v); }))
+        return;
+
+    const bool enabled = captured.enabled != 0;
+    const int intValue = captured.intValue;
+    const auto* values = captured.values;
+    switch (static_cast<Type> (captured.type))
+    {
+        case Type::soloBand:
+            setSoloBand (intValue);
+            break;
+
+        case Type::referenceCurve:
+        {
+            std::array<float, spectrumBins> bins {};
+            std::copy (std::begin (captured.curveBins), std::end (captured.curveBins), bins.begin());
+            submitReferenceCurve (bins, captured.hasCurve != 0);
+            break;
+        }
+
+        case Type::suppressorConfig:
+            setResonanceSuppressorConfig (enabled, values[0], values[1], values[2]);
+            break;
+
+        case Type::oscilloscopeMode:
+            setOscilloscopeLengthMode (intValue);
+            break;
+
+        case Type::oscilloscopeResolution:
+            setOscilloscopeResolution (intValue);
+            break;
+
+        case Type::oscilloscopeTrigger:
+            setOscilloscopeTrigger (values[0], values[1]);
+            break;
+
+        // These two are recorded as the index the audio thread applies.
+        case Type::analyzerSmoothing:
+            if (juce::isPositiveAndBelow (intValue, static_cast<int> (FractionalOctaveSmoother::standardFractions.size())))
+                setAnalyzerSmoothingFraction (FractionalOctaveSmoother::standardFractions[static_cast<size_t> (intValue)]);
+            break;
+
+        case Type::spectrumResolution:
+            if (juce::isPositiveAndBelow (intValue, static_cast<int> (SpectrumDisplaySet::resolutions.size())))
+                setSpectrumResolution (SpectrumDisplaySet::resolutions[static_cast<size_t> (intValue)]);
+            break;
+
+        case Type::liveReference:
+            setLiveReferenceEnabled (enabled);
+            break;
+
+        case Type::matchEq:
+            setMatchEqConfig (enabled, intValue, values[0]);
+            break;
+
+        case Type::resetLoudnessTimeline:
+            resetLoudnessTimeline();
+            break;
+
+        case Type::markerProbe:
+            setMarkerProbe (intValue, enabled, values[0], values[1]);
+            break;
+
+        case Type::rtaMode:
+            setRtaMode (intValue);
+            break;
+
+        case Type::autoReference:
+            setAutoReferenceEnabled (enabled);
+            break;
+
+        case Type::stereoField:
+            setStereoFieldEnabled (enabled);
+            break;
+    }
+}
+
+void SpecraumAudioProcessor::applyControlCommand (const ControlCommand& command) noexcept
+{
+    using Type = ControlCommand::Type;
+
+    switch (command.type)
+    {
+        case Type::soloBand:
+            if (command.intValue != soloBand)
+            {
+                soloBand = command.intValue;
+                resetSoloBandFilters();
+            }
+            break;
+
+        case Type::referenceCurve:
+        {
+            // Only one curve is ever pending and each retires at most one, so the retire queue
+            // cannot overflow.
+            ReferenceCurve* previous = referenceCurve.release();
+            referenceCurve.reset (command.curve);
+            retiredReferenceCurves.push (previous);
+            break;
+        }
+
+        case Type::suppressorConfig:
+            if (command.enabled && ! suppressorConfig.enabled)
+                peakTracker.reset();
+            suppressorConfig.enabled = command.enabled;
+            suppressorConfig.overlayLevelDb = command.values[0];
+            suppressorConfig.overlayWidthDb = command.values[1];
+            suppressorConfig.tiltDb = command.values[2];
+            break;
+
+        case Type::oscilloscopeMode:
+            oscilloscopeMode = command.intValue;
+            oscilloscopeCapture.setMode (static_cast<OscilloscopeCapture::Mode> (command.intValue));
+            break;
+
+        case Type::oscilloscopeResolution:
+            oscilloscopeCapture.setResolution (command.intValue);
+            break;
+
+        case Type::oscilloscopeTrigger:
+            oscilloscopeCapture.setTriggerLevel (command.values[0]);
+            oscilloscopeCapture.setWindowSeconds (0.001 * static_cast<double> (command.values[1]));
+            break;
+
+        case Type::analyzerSmoothing:
+            spectrumSmoothingIndex = static_cast<size_t> (command.intValue);
+            break;
+
+        case Type::spectrumResolution:
+            if (command.intValue != spectrumDisplayIndex)
+            {
+                // The newly selected trace has not been updated since it was last shown.
+                spectrumDisplays.resetResolution (command.intValue);
+                spectrumDisplayIndex = command.intValue;
+            }
+            break;
+
+        case Type::liveReference:
+            liveReferenceRequested = command.enabled;
+            break;
+
+        case Type::matchEq:
+            matchEqRequested = command.enabled;
+            break;
+
+        case Type::resetLoudnessTimeline:
+            loudnessTimeline.reset();
+            break;
+
+        case Type::markerProbe:
+        {
+            MarkerProbes::Probe probe;
+            probe.enabled = command.enabled;
+            probe.frequencyHz = command.values[0];
+            probe.bandwidthHz = command.values[1];
+            markerProbes.setProbe (command.intValue, probe);
+            break;
+        }
+
+        case Type::rtaMode:
+            thirdOctaveRta.setWeighting (static_cast<ThirdOctaveRta::Weighting> (command.intValue));
+            break;
+
+        case Type::autoReference:
+            if (command.enabled && ! autoReferenceRequested)
+                noiseFloorSamplesSincePublish = liveReferencePublishIntervalSamples;
+            autoReferenceRequested = command.enabled;
+            break;
+
+        case Type::stereoField:
+            // Start from a fresh average rather than the one left over from the last time.
+            if (command.enabled && ! stereoFieldRequested)
+                stereoField.reset();
+            stereoFieldRequested = command.enabled;
+            break;
+    }
 }
 
 void SpecraumAudioProcessor::setOscilloscopeLengthMode (int mode) noexcept
 {
-    oscilloscopeLengthMode.store (mode == 0 ? 0 : 1, std::memory_order_relaxed);
+    const int clamped = (mode >= 0 && mode < OscilloscopeCapture::numModes) ? mode : 0;
+    oscilloscopeLengthMode.store (clamped, std::memory_order_relaxed);
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::oscilloscopeMode;
+    command.intValue = clamped;
+    pushControlCommand (command);
 }
 
 int SpecraumAudioProcessor::getOscilloscopeLengthMode() const noexcept
@@ -381,17 +1116,85 @@ int SpecraumAudioProcessor::getOscilloscopeLengthMode() const noexcept
     return oscilloscopeLengthMode.load (std::memory_order_relaxed);
 }
 
+void SpecraumAudioProcessor::setOscilloscopeResolution (int points) noexcept
+{
+    ControlCommand command;
+    command.type = ControlCommand::Type::oscilloscopeResolution;
+    command.intValue = juce::jlimit (OscilloscopeCapture::minResolution, OscilloscopeCapture::maxResolution, points);
+    pushControlCommand (command);
+}
+
+void SpecraumAudioProcessor::setOscilloscopeTrigger (float level, float windowMs) noexcept
+{
+    ControlCommand command;
+    command.type = ControlCommand::Type::oscilloscopeTrigger;
+    command.values = { juce::jlimit (-1.0f, 1.0f, level), juce::jlimit (1.0f, 1000.0f, windowMs), 0.0f };
+    pushControlCommand (command);
+}
+
 void SpecraumAudioProcessor::setSoloBand (int bandIndex) noexcept
 {
-    const int clamped = (bandIndex >= 0 && bandIndex <= 3) ? bandIndex : -1;
-    const int previous = soloBand.exchange (clamped, std::memory_order_relaxed);
-    if (previous != clamped)
-        resetSoloBandFilters();
+    ControlCommand command;
+    command.type = ControlCommand::Type::soloBand;
+    command.intValue = (bandIndex >= 0 && bandIndex <= 3) ? bandIndex : -1;
+    pushControlCommand (command);
+}
+
+void SpecraumAudioProcessor::setAnalyzerSmoothingFraction (int octaveFraction) noexcept
+{
+    const int index = FractionalOctaveSmoother::getFractionIndex (octaveFraction);
+    analyzerSmoothingIndex.store (index, std::memory_order_relaxed);
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::analyzerSmoothing;
+    command.intValue = index;
+    pushControlCommand (command);
+}
+
+int SpecraumAudioProcessor::getAnalyzerSmoothingFraction() const noexcept
+{
+    const auto index = static_cast<size_t> (analyzerSmoothingIndex.load (std::memory_order_relaxed));
+    return FractionalOctaveSmoother::standardFractions[index];
+}
+
+void SpecraumAudioProcessor::setSpectrumResolution (int numBins) noexcept
+{
+    const int index = SpectrumDisplaySet::getResolutionIndex (numBins);
+    spectrumResolutionIndex.store (index, std::memory_order_relaxed);
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::spectrumResolution;
+    command.intValue = index;
+    pushControlCommand (command);
+}
+
+int SpecraumAudioProcessor::getSpectrumResolution() const noexcept
+{
+    const auto index = static_cast<size_t> (spectrumResolutionIndex.load (std::memory_order_relaxed));
+    return SpectrumDisplaySet::resolutions[index];
+}
+
+void SpecraumAudioProcessor::setRtaMode (int mode) noexcept
+{
+    const int index = juce::jlimit (static_cast<int> (ThirdOctaveRta::Weighting::off),
+                                    static_cast<int> (ThirdOctaveRta::Weighting::slow),
+                                    mode);
+    rtaModeIndex.store (index, std::memory_order_relaxed);
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::rtaMode;
+    command.intValue = index;
+    pushControlCommand (command);
+}
+
+int SpecraumAudioProcessor::getRtaMode() const noexcept
+{
+    return rtaModeIndex.load (std::memory_order_relaxed);
 }
 
 double SpecraumAudioProcessor::getCurrentAnalysisSampleRate() const noexcept
 {
-    return currentSampleRate.load();
+    return analysisSampleRate.load();
 }
 
 float SpecraumAudioProcessor::getRmsDb() const noexcept
@@ -404,6 +1207,92 @@ float SpecraumAudioProcessor::getLufsIntegrated() const noexcept
     return lufsIntegrated.load (std::memory_order_relaxed);
 }
 
+int SpecraumAudioProcessor::getLoudnessTimeline (int level, std::vector<LoudnessTimeline::Point>& out) const
+{
+    return loudnessTimeline.read (level, out);
+}
+
+void SpecraumAudioProcessor::resetLoudnessTimeline() noexcept
+{
+    ControlCommand command;
+    command.type = ControlCommand::Type::resetLoudnessTimeline;
+    pushControlCommand (command);
+}
+
+void SpecraumAudioProcessor::setMarkerProbe (int index, bool enabled, float frequencyHz, float bandwidthHz) noexcept
+{
+    if (index < 0 || index >= MarkerProbes::maxProbes)
+        return;
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::markerProbe;
+    command.intValue = index;
+    command.enabled = enabled && std::isfinite (frequencyHz) && frequencyHz > 0.0f;
+    command.values = { command.enabled ? frequencyHz : 0.0f,
+                       juce::jlimit (MarkerProbes::minBandwidthHz, MarkerProbes::maxBandwidthHz, bandwidthHz),
+                       0.0f };
+    pushControlCommand (command);
+}
+
+int SpecraumAudioProcessor::readMarkerProbes (std::uint64_t& nextPoint, std::vector<float>& out) const
+{
+    return markerProbes.read (nextPoint, out);
+}
+
+void SpecraumAudioProcessor::setSpectrumFrameCallback (SpectrumFrameCallback callback)
+{
+    spectrumFrameCallback = std::move (callback);
+}
+
+SpecraumAudioProcessor::PitchReadout SpecraumAudioProcessor::getPitchReadout() const noexcept
+{
+    const auto estimate = analysisWorker.getPitchEstimate();
+
+    PitchReadout readout;
+    readout.confidence = estimate.confidence;
+    if (estimate.frequencyHz <= 0.0f)
+        return readout;
+
+    const float noteNumber = 69.0f + 12.0f * std::log2 (estimate.frequencyHz / 440.0f);
+    readout.frequencyHz = estimate.frequencyHz;
+    readout.midiNote = static_cast<int> (std::lround (noteNumber));
+    readout.cents = (noteNumber - static_cast<float> (readout.midiNote)) * 100.0f;
+    return readout;
+}
+
+void SpecraumAudioProcessor::setSpectrogramMode (int mode) noexcept
+{
+    const int clamped = juce::jlimit (static_cast<int> (ReassignedSpectrogram::Mode::off),
+                                      static_cast<int> (ReassignedSpectrogram::Mode::reassigned),
+                                      mode);
+    analysisWorker.setSpectrogramMode (static_cast<ReassignedSpectrogram::Mode> (clamped));
+}
+
+int SpecraumAudioProcessor::readSpectrogram (std::uint64_t& nextColumn, std::vector<float>& out) const
+{
+    return analysisWorker.readSpectrogram (nextColumn, out);
+}
+
+void SpecraumAudioProcessor::setZoomRange (float minHz, float maxHz) noexcept
+{
+    analysisWorker.setZoomRange (minHz, maxHz);
+}
+
+std::uint32_t SpecraumAudioProcessor::readZoomSpectrum (std::vector<float>& out, float& minHz, float& maxHz) const
+{
+    return analysisWorker.readZoomSpectrum (out, minHz, maxHz);
+}
+
+void SpecraumAudioProcessor::setSpectralFeaturesEnabled (bool enabled) noexcept
+{
+    analysisWorker.setFeaturesEnabled (enabled);
+}
+
+std::uint32_t SpecraumAudioProcessor::readSpectralFeatures (SpectralFeatures::Values& out) const noexcept
+{
+    return analysisWorker.readSpectralFeatures (out);
+}
+
 void SpecraumAudioProcessor::updateSoloBandFilters (double sampleRate) noexcept
 {
     const float safeSampleRate = juce::jmax (1000.0f, static_cast<float> (sampleRate));
@@ -449,7 +1338,7 @@ void SpecraumAudioProcessor::resetSoloBandFilters() noexcept
 
 void SpecraumAudioProcessor::applySoloBandToBuffer (juce::AudioBuffer<float>& buffer) noexcept
 {
-    const int activeBand = soloBand.load (std::memory_order_relaxed);
+    const int activeBand = soloBand;
     if (activeBand < 0 || activeBand > 3)
         return;
 
@@ -503,6 +1392,8 @@ void SpecraumAudioProcessor::applySoloBandToBuffer (juce::AudioBuffer<float>& bu
 void SpecraumAudioProcessor::resetResonanceSuppressor() noexcept
 {
     const double sampleRate = juce::jmax (1000.0, currentSampleRate.load());
+    suppressorUpdateIntervalSamples = juce::jmax (1, static_cast<int> (std::lround (kSuppressorUpdateSeconds * sampleRate)));
+    suppressorSamplesUntilUpdate = 0;
 
     for (int bandIndex = 0; bandIndex < resonanceSuppressorBands; ++bandIndex)
     {
@@ -515,6 +1406,10 @@ void SpecraumAudioProcessor::resetResonanceSuppressor() noexcept
         band.currentFrequencyHz = startHz * std::pow (endHz / startHz, t);
         band.currentGainDb = 0.0f;
         band.currentQ = 5.0f;
+        band.designedFrequencyHz = band.currentFrequencyHz;
+        band.designedGainDb = band.currentGainDb;
+        band.designedQ = band.currentQ;
+        band.trackId = -1;
 
         auto coeff = juce::dsp::IIR::Coefficients<float>::makePeakFilter (
             sampleRate,
@@ -536,12 +1431,15 @@ void SpecraumAudioProcessor::resetResonanceSuppressor() noexcept
 void SpecraumAudioProcessor::updateResonanceSuppressorTargets (int numSamples) noexcept
 {
     const double sampleRate = juce::jmax (1000.0, currentSampleRate.load());
-    const float overlayLevelDb = juce::jlimit (-23.0f, 0.0f, resonanceOverlayLevelDb.load (std::memory_order_relaxed));
-    const float overlayWidthDb = juce::jlimit (3.0f, 18.0f, resonanceOverlayWidthDb.load (std::memory_order_relaxed));
-    const float overlayTiltDb = juce::jlimit (-24.0f, 24.0f, resonanceOverlayTiltDb.load (std::memory_order_relaxed));
+    const float overlayLevelDb = suppressorConfig.overlayLevelDb;
+    const float overlayWidthDb = suppressorConfig.overlayWidthDb;
+    const float overlayTiltDb = suppressorConfig.tiltDb;
     constexpr float warningStartDb = 0.08f;
     constexpr float redStartDb = 3.0f;
     const float halfWidthDb = 0.5f * overlayWidthDb;
+    const auto& spectrumBinFrequencyHz = spectrumDisplays.getBase().getFrequencies();
+    const auto& smoothedSpectrum = spectrumDisplays.getBase().getValues();
+    const auto& thresholdCurve = getSuppressorCurve();
 
     std::array<float, spectrumBins> thresholdUpperDb {};
     float maxUpperDb = -std::numeric_limits<float>::infinity();
@@ -549,7 +1447,7 @@ void SpecraumAudioProcessor::updateResonanceSuppressorTargets (int numSamples) n
     for (int i = 0; i < spectrumBins; ++i)
     {
         const size_t idx = static_cast<size_t> (i);
-        const float referenceNorm = referenceSpectrumData[idx].load (std::memory_order_relaxed);
+        const float referenceNorm = thresholdCurve.bins[idx];
         const float freqHz = juce::jmax (20.0f, spectrumBinFrequencyHz[idx]);
         const float octaveFrom1k = std::log2 (freqHz / 1000.0f);
         const float centerDb = normToDb (referenceNorm) + (overlayTiltDb * octaveFrom1k) + kOverlayLiftDb;
@@ -565,85 +1463,123 @@ void SpecraumAudioProcessor::updateResonanceSuppressorTargets (int numSamples) n
     for (int i = 0; i < spectrumBins; ++i)
         thresholdUpperDb[static_cast<size_t> (i)] += alignToZeroDb + overlayLevelDb;
 
+    // Candidates are confirmed spectral peak tracks, measured against the overlay at their
+    // interpolated frequency rather than at the nearest display bin.
+    const float lowestHz = spectrumBinFrequencyHz.front();
+    const float highestHz = spectrumBinFrequencyHz.back();
+    const float binsPerLogHz = static_cast<float> (spectrumBins - 1) / std::log (highestHz / lowestHz);
+    auto interpolateAt = [] (const auto& values, float position) noexcept
+    {
+        const int lower = juce::jlimit (0, spectrumBins - 2, static_cast<int> (position));
+        const float frac = juce::jlimit (0.0f, 1.0f, position - static_cast<float> (lower));
+        return values[static_cast<size_t> (lower)] + frac * (values[static_cast<size_t> (lower + 1)] - values[static_cast<size_t> (lower)]);
+    };
+
     struct Candidate
     {
-        int bin = 0;
+        int trackId = -1;
+        float frequencyHz = 0.0f;
         float exceedDb = 0.0f;
         float score = 0.0f;
     };
 
-    std::array<Candidate, spectrumBins> candidates {};
+    std::array<Candidate, SpectralPeakTracker::maxTracks> candidates {};
     int candidateCount = 0;
-    for (int i = 1; i < spectrumBins - 1; ++i)
+    for (const auto& track : peakTracker.getTracks())
     {
-        const size_t idx = static_cast<size_t> (i);
-        const float frequencyHz = juce::jmax (20.0f, spectrumBinFrequencyHz[idx]);
-        const float octaveFrom1k = std::log2 (frequencyHz / 1000.0f);
-        const float currentDb = normToDb (smoothedSpectrum[idx]) + (overlayTiltDb * octaveFrom1k);
-        const float exceedDb = currentDb - thresholdUpperDb[idx];
-
-        const float prevFreqHz = juce::jmax (20.0f, spectrumBinFrequencyHz[static_cast<size_t> (i - 1)]);
-        const float prevOctaveFrom1k = std::log2 (prevFreqHz / 1000.0f);
-        const float prevDb = (normToDb (smoothedSpectrum[static_cast<size_t> (i - 1)]) + (overlayTiltDb * prevOctaveFrom1k))
-            - thresholdUpperDb[static_cast<size_t> (i - 1)];
+        if (! track.isConfirmed() || track.frequencyHz < lowestHz || track.frequencyHz > highestHz)
+            continue;
 
-        const float nextFreqHz = juce::jmax (20.0f, spectrumBinFrequencyHz[static_cast<size_t> (i + 1)]);
-        const float nextOctaveFrom1k = std::log2 (nextFreqHz / 1000.0f);
-        const float nextDb = (normToDb (smoothedSpectrum[static_cast<size_t> (i + 1)]) + (overlayTiltDb * nextOctaveFrom1k))
-            - thresholdUpperDb[static_cast<size_t> (i + 1)];
+        const float position = std::log (track.frequencyHz / lowestHz) * binsPerLogHz;
+        const float octaveFrom1k = std::log2 (track.frequencyHz / 1000.0f);
+        const float currentDb = normToDb (interpolateAt (smoothedSpectrum, position)) + (overlayTiltDb * octaveFrom1k);
+        const float exceedDb = currentDb - interpolateAt (thresholdUpperDb, position);
+        if (exceedDb <= warningStartDb)
+            continue;
 
         const float highAssist = juce::jmap (
-            juce::jlimit (0.0f, 1.0f, (std::log2 (frequencyHz / 600.0f) + 1.0f) / 4.0f),
+            juce::jlimit (0.0f, 1.0f, (std::log2 (track.frequencyHz / 600.0f) + 1.0f) / 4.0f),
             0.0f,
             1.0f,
             0.0f,
             0.12f);
-        if (exceedDb <= warningStartDb)
-            continue;
-        if (exceedDb < prevDb || exceedDb < nextDb)
-            continue;
-
-        candidates[static_cast<size_t> (candidateCount++)] = { i, exceedDb, exceedDb + highAssist };
+        candidates[static_cast<size_t> (candidateCount++)] = { track.id, track.frequencyHz, exceedDb, exceedDb + highAssist };
     }
 
     std::sort (candidates.begin(),
                candidates.begin() + candidateCount,
                [] (const Candidate& a, const Candidate& b) { return a.score > b.score; });
 
-    std::array<float, resonanceSuppressorBands> targetFrequencyHz {};
-    std::array<float, resonanceSuppressorBands> targetGainDb {};
-    std::array<float, resonanceSuppressorBands> targetQ {};
-    std::array<float, resonanceSuppressorBands> selectedFreqHz {};
+    std::array<Candidate, resonanceSuppressorBands> selected {};
     int selectedCount = 0;
-
-    for (int bandIndex = 0; bandIndex < resonanceSuppressorBands; ++bandIndex)
+    for (int i = 0; i < candidateCount && selectedCount < resonanceSuppressorBands; ++i)
     {
-        const auto& band = resonanceBands[static_cast<size_t> (bandIndex)];
-        targetFrequencyHz[static_cast<size_t> (bandIndex)] = band.currentFrequencyHz;
-        targetGainDb[static_cast<size_t> (bandIndex)] = 0.0f;
-        targetQ[static_cast<size_t> (bandIndex)] = band.currentQ;
+        const auto& candidate = candidates[static_cast<size_t> (i)];
+        bool farEnough = true;
+        for (int s = 0; s < selectedCount; ++s)
+            if (std::abs (std::log2 (candidate.frequencyHz / selected[static_cast<size_t> (s)].frequencyHz)) < 0.16f)
+                farEnough = false;
+
+        if (farEnough)
+            selected[static_cast<size_t> (selectedCount++)] = candidate;
     }
 
-    auto canSelectFrequency = [&selectedFreqHz, &selectedCount] (float frequencyHz) -> bool
+    // A track keeps the band it was given, so a resonance only ever glides its own filter;
+    // new tracks take the quietest free band.
+    std::array<int, resonanceSuppressorBands> bandCandidate {};
+    bandCandidate.fill (-1);
+    std::array<bool, resonanceSuppressorBands> placed {};
+    for (int s = 0; s < selectedCount; ++s)
     {
-        for (int s = 0; s < selectedCount; ++s)
+        for (int bandIndex = 0; bandIndex < resonanceSuppressorBands; ++bandIndex)
         {
-            const float octaveDistance = std::abs (std::log2 (frequencyHz / juce::jmax (20.0f, selectedFreqHz[static_cast<size_t> (s)])));
-            if (octaveDistance < 0.16f)
-                return false;
+            if (resonanceBands[static_cast<size_t> (bandIndex)].trackId == selected[static_cast<size_t> (s)].trackId)
+            {
+                bandCandidate[static_cast<size_t> (bandIndex)] = s;
+                placed[static_cast<size_t> (s)] = true;
+                break;
+            }
         }
-        return true;
-    };
+    }
 
-    auto assignCandidateToSlot = [&] (const Candidate& candidate)
+    for (int s = 0; s < selectedCount; ++s)
     {
-        if (selectedCount >= resonanceSuppressorBands)
-            return;
+        if (placed[static_cast<size_t> (s)])
+            continue;
 
-        const float frequencyHz = juce::jmax (20.0f, spectrumBinFrequencyHz[static_cast<size_t> (candidate.bin)]);
-        if (! canSelectFrequency (frequencyHz))
-            return;
+        int freeBand = -1;
+        for (int bandIndex = 0; bandIndex < resonanceSuppressorBands; ++bandIndex)
+        {
+            if (bandCandidate[static_cast<size_t> (bandIndex)] >= 0)
+                continue;
+            if (freeBand < 0
+                || resonanceBands[static_cast<size_t> (bandIndex)].currentGainDb > resonanceBands[static_cast<size_t> (freeBand)].currentGainDb)
+                freeBand = bandIndex;
+        }
+
+        if (freeBand < 0)
+            break;
+
+        bandCandidate[static_cast<size_t> (freeBand)] = s;
+        resonanceBands[static_cast<size_t> (freeBand)].trackId = selected[static_cast<size_t> (s)].trackId;
+    }
+
+    std::array<float, resonanceSuppressorBands> targetFrequencyHz {};
+    std::array<float, resonanceSuppressorBands> targetGainDb {};
+    std::array<float, resonanceSuppressorBands> targetQ {};
+    for (int bandIndex = 0; bandIndex < resonanceSuppressorBands; ++bandIndex)
+    {
+        const auto& band = resonanceBands[static_cast<size_t> (bandIndex)];
+        const int s = bandCandidate[static_cast<size_t> (bandIndex)];
+        if (s < 0)
+        {
+            targetFrequencyHz[static_cast<size_t> (bandIndex)] = band.currentFrequencyHz;
+            targetGainDb[static_cast<size_t> (bandIndex)] = 0.0f;
+            targetQ[static_cast<size_t> (bandIndex)] = band.currentQ;
+            continue;
+        }
 
+        const auto& candidate = selected[static_cast<size_t> (s)];
         float reductionDb = 0.0f;
         if (candidate.exceedDb <= redStartDb)
         {
@@ -656,17 +1592,9 @@ void SpecraumAudioProcessor::updateResonanceSuppressorTargets (int numSamples) n
             reductionDb = 3.0f + (candidate.exceedDb - redStartDb) * 1.35f;
         }
 
-        const int slot = selectedCount++;
-        selectedFreqHz[static_cast<size_t> (slot)] = frequencyHz;
-        targetFrequencyHz[static_cast<size_t> (slot)] = frequencyHz;
-        targetGainDb[static_cast<size_t> (slot)] = -juce::jlimit (0.0f, 18.0f, reductionDb);
-        targetQ[static_cast<size_t> (slot)] = juce::jlimit (2.0f, 14.0f, 4.0f + candidate.exceedDb * 1.1f);
-    };
-
-    for (int i = 0; i < candidateCount && selectedCount < resonanceSuppressorBands; ++i)
-    {
-        const auto& candidate = candidates[static_cast<size_t> (i)];
-        assignCandidateToSlot (candidate);
+        targetFrequencyHz[static_cast<size_t> (bandIndex)] = candidate.frequencyHz;
+        targetGainDb[static_cast<size_t> (bandIndex)] = -juce::jlimit (0.0f, 18.0f, reductionDb);
+        targetQ[static_cast<size_t> (bandIndex)] = juce::jlimit (2.0f, 14.0f, 4.0f + candidate.exceedDb * 1.1f);
     }
 
     const float blockDurationSec = static_cast<float> (numSamples / sampleRate);
@@ -687,14 +1615,26 @@ void SpecraumAudioProcessor::updateResonanceSuppressorTargets (int numSamples) n
         band.currentQ = paramCoeff * band.currentQ
             + (1.0f - paramCoeff) * juce::jlimit (1.5f, 16.0f, targetQ[static_cast<size_t> (bandIndex)]);
 
-        auto coeff = juce::dsp::IIR::Coefficients<float>::makePeakFilter (
-            sampleRate,
-            band.currentFrequencyHz,
-            band.currentQ,
-            juce::Decibels::decibelsToGain (band.currentGainDb));
-
-        for (auto& filter : band.filters)
-            filter.coefficients = coeff;
+        // Gliding parameters settle long before their last few cents matter; skip the redesign
+        // until one of them has moved audibly.
+        const bool retune = std::abs (band.currentFrequencyHz - band.designedFrequencyHz) > kRetuneFrequencyRatio * band.designedFrequencyHz
+                         || std::abs (band.currentGainDb - band.designedGainDb) > kRetuneGainDb
+                         || std::abs (band.currentQ - band.designedQ) > kRetuneQRatio * band.designedQ;
+        if (retune)
+        {
+            auto coeff = juce::dsp::IIR::Coefficients<float>::makePeakFilter (
+                sampleRate,
+                band.currentFrequencyHz,
+                band.currentQ,
+                juce::Decibels::decibelsToGain (band.currentGainDb));
+
+            for (auto& filter : band.filters)
+                filter.coefficients = coeff;
+
+            band.designedFrequencyHz = band.currentFrequencyHz;
+            band.designedGainDb = band.currentGainDb;
+            band.designedQ = band.currentQ;
+        }
 
         resonanceBandFrequencyUi[static_cast<size_t> (bandIndex)].store (band.currentFrequencyHz, std::memory_order_relaxed);
         resonanceBandGainUi[static_cast<size_t> (bandIndex)].store (band.currentGainDb, std::memory_order_relaxed);
@@ -703,12 +1643,11 @@ void SpecraumAudioProcessor::updateResonanceSuppressorTargets (int numSamples) n
 
 void SpecraumAudioProcessor::applyResonanceSuppressorToBuffer (juce::AudioBuffer<float>& buffer) noexcept
 {
-    const bool enabled = resonanceSuppressorEnabled.load (std::memory_order_relaxed);
-    const bool hasReference = hasReferenceSpectrum.load (std::memory_order_relaxed);
-    if (! enabled || ! hasReference)
+    if (! suppressorConfig.enabled || ! getSuppressorCurve().hasData)
     {
         for (int bandIndex = 0; bandIndex < resonanceSuppressorBands; ++bandIndex)
             resonanceBandGainUi[static_cast<size_t> (bandIndex)].store (0.0f, std::memory_order_relaxed);
+        suppressorSamplesUntilUpdate = 0;
         return;
     }
 
@@ -717,22 +1656,33 @@ void SpecraumAudioProcessor::applyResonanceSuppressorToBuffer (juce::AudioBuffer
     if (channels <= 0 || samples <= 0)
         return;
 
-    updateResonanceSuppressorTargets (samples);
-
-    for (int ch = 0; ch < channels; ++ch)
+    for (int start = 0; start < samples;)
     {
-        float* data = buffer.getWritePointer (ch);
-        for (int i = 0; i < samples; ++i)
+        if (suppressorSamplesUntilUpdate <= 0)
         {
-            float sample = data[i];
-            for (int bandIndex = 0; bandIndex < resonanceSuppressorBands; ++bandIndex)
+            updateResonanceSuppressorTargets (suppressorUpdateIntervalSamples);
+            suppressorSamplesUntilUpdate = suppressorUpdateIntervalSamples;
+        }
+
+        const int count = juce::jmin (samples - start, suppressorSamplesUntilUpdate);
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            float* data = buffer.getWritePointer (ch, start);
+            for (int i = 0; i < count; ++i)
             {
-                const auto& band = resonanceBands[static_cast<size_t> (bandIndex)];
-                if (band.currentGainDb < -0.05f)
-                    sample = resonanceBands[static_cast<size_t> (bandIndex)].filters[static_cast<size_t> (ch)].processSample (sample);
+                float sample = data[i];
+                for (int bandIndex = 0; bandIndex < resonanceSuppressorBands; ++bandIndex)
+                {
+                    const auto& band = resonanceBands[static_cast<size_t> (bandIndex)];
+                    if (band.currentGainDb < -0.05f)
+                        sample = resonanceBands[static_cast<size_t> (bandIndex)].filters[static_cast<size_t> (ch)].processSample (sample);
+                }
+                data[i] = sample;
             }
-            data[i] = sample;
         }
+
+        start += count;
+        suppressorSamplesUntilUpdate -= count;
     }
 }
 
@@ -804,33 +1754,18 @@ bool SpecraumAudioProcessor::buildSmoothPresetFromFolder (const juce::File& fold
     constexpr int analysisLinearBins = (analysisFftSize / 2) + 1;
     constexpr int analysisHopSize = analysisFftSize / 4;
 
-    juce::dsp::FFT localFft { analysisFftOrder };
-    juce::dsp::WindowingFunction<float> localWindow {
-        analysisFftSize,
-        juce::dsp::WindowingFunction<float>::hann,
-        true
-    };
+    RealFftBatch localFft { analysisFftOrder };
+    const auto localWindow = SharedDspTables::getWindow (SharedDspTables::WindowKind::hann, analysisFftSize);
     std::array<float, analysisFftSize> localFifo {};
-    std::array<float, analysisFftSize * 2> localFftData {};
+    std::array<float, analysisFftSize> localFrame {};
+    std::array<float, analysisLinearBins> localPower {};
+    const float localPowerScale = localWindow->magnitudeScale * localWindow->magnitudeScale;
 
-    auto computeLocalMagnitudeScale = []()
-    {
-        std::array<float, analysisFftSize> windowTable {};
-        juce::dsp::WindowingFunction<float>::fillWindowingTables (
-            windowTable.data(),
-            analysisFftSize,
-            juce::dsp::WindowingFunction<float>::hann,
-            true);
-
-        double windowSum = 0.0;
-        for (const auto w : windowTable)
-            windowSum += static_cast<double> (w);
-
-        const double coherentGain = windowSum / static_cast<double> (analysisFftSize);
-        const double safeGain = juce::jmax (coherentGain, 1.0e-9);
-        return static_cast<float> (2.0 / (static_cast<double> (analysisFftSize) * safeGain));
-    };
-    const float localMagnitudeScale = computeLocalMagnitudeScale();
+    // Smoothing amount N averages power over N/24 octave around each display point.
+    const double smoothingOctaves = static_cast<double> (smoothingAmountClamped) / 24.0;
+    FractionalOctaveSmoother presetSmoother;
+    presetSmoother.prepare (analysisLinearBins);
+    std::array<FractionalOctaveSmoother::Band, spectrumBins> smoothingBands {};
 
     for (const auto& file : audioFiles)
     {
@@ -848,16 +1783,11 @@ bool SpecraumAudioProcessor::buildSmoothPresetFromFolder (const juce::File& fold
 
         auto analyseFrame = [&]()
         {
-            std::fill (localFftData.begin(), localFftData.end(), 0.0f);
-            std::copy (localFifo.begin(), localFifo.end(), localFftData.begin());
-            localWindow.multiplyWithWindowingTable (localFftData.data(), analysisFftSize);
-            localFft.performFrequencyOnlyForwardTransform (localFftData.data());
+            juce::FloatVectorOperations::multiply (localFrame.data(), localFifo.data(), localWindow->values.data(), analysisFftSize);
+            localFft.computePowerSpectrum (localFrame.data(), localPower.data());
 
             for (int i = 0; i < analysisLinearBins; ++i)
-            {
-                const float mag = juce::jmax (0.0f, localFftData[static_cast<size_t> (i)]) * localMagnitudeScale;
-                fileLinearPowerAccum[static_cast<size_t> (i)] += static_cast<double> (mag * mag);
-            }
+                fileLinearPowerAccum[static_cast<size_t> (i)] += static_cast<double> (localPower[static_cast<size_t> (i)] * localPowerScale);
         };
 
         int localFifoIndex = 0;
@@ -907,29 +1837,25 @@ bool SpecraumAudioProcessor::buildSmoothPresetFromFolder (const juce::File& fold
         if (fileFramesAnalysed <= 0)
             continue;
 
-        const float minFreq = 20.0f;
-        const float maxFreq = juce::jlimit (minFreq + 1.0f, static_cast<float> (reader->sampleRate * 0.5), 20000.0f);
-        const float ratio = maxFreq / minFreq;
-        const float analysisBinHz = static_cast<float> (reader->sampleRate / static_cast<double> (analysisFftSize));
+        std::array<float, analysisLinearBins> fileLinearPower {};
+        for (int k = 0; k < analysisLinearBins; ++k)
+            fileLinearPower[static_cast<size_t> (k)] = static_cast<float> (
+                fileLinearPowerAccum[static_cast<size_t> (k)] / static_cast<double> (fileFramesAnalysed));
+
+        const auto axis = SharedDspTables::getDisplayAxis<spectrumBins> (reader->sampleRate, analysisFftSize);
+        FractionalOctaveSmoother::computeBands (axis->frequencyHz.data(),
+                                                spectrumBins,
+                                                reader->sampleRate / static_cast<double> (analysisFftSize),
+                                                smoothingOctaves,
+                                                analysisLinearBins,
+                                                smoothingBands.data());
+        std::array<float, spectrumBins> smoothedFilePower {};
+        presetSmoother.process (fileLinearPower.data(), smoothingBands.data(), spectrumBins, smoothedFilePower.data());
 
         for (int i = 0; i < spectrumBins; ++i)
         {
-            const float t = static_cast<float> (i) / static_cast<float> (spectrumBins - 1);
-            const float freq = minFreq * std::pow (ratio, t);
-            const float binPos = freq / analysisBinHz;
-            const float clamped = juce::jlimit (
-                0.0f,
-                static_cast<float> (analysisLinearBins - 1),
-                binPos);
-            const int idxA = static_cast<int> (clamped);
-            const int idxB = juce::jmin (idxA + 1, analysisLinearBins - 1);
-            const float frac = clamped - static_cast<float> (idxA);
-
-            const double powA = fileLinearPowerAccum[static_cast<size_t> (idxA)] / static_cast<double> (fileFramesAnalysed);
-            const double powB = fileLinearPowerAccum[static_cast<size_t> (idxB)] / static_cast<double> (fileFramesAnalysed);
-            const double interpPower = juce::jmax (0.0, powA + (powB - powA) * static_cast<double> (frac));
-
-            const float amplitude = static_cast<float> (std::sqrt (juce::jmax (interpPower, 1.0e-20)));
+            const double power = static_cast<double> (smoothedFilePower[static_cast<size_t> (i)]);
+            const float amplitude = static_cast<float> (std::sqrt (juce::jmax (power, 1.0e-20)));
             const float dB = juce::Decibels::gainToDecibels (amplitude, -120.0f);
             fileCurve[static_cast<size_t> (i)] = juce::jlimit (
                 0.0f,
@@ -937,36 +1863,6 @@ bool SpecraumAudioProcessor::buildSmoothPresetFromFolder (const juce::File& fold
                 juce::jmap (dB, -96.0f, 0.0f, 0.0f, 1.0f));
         }
 
-        const int smoothingPasses = juce::jlimit (0, 40, smoothingAmountClamped * 2);
-        const float targetSide = juce::jmap (
-            static_cast<float> (smoothingAmountClamped),
-            0.0f,
-            16.0f,
-            0.04f,
-            0.34f);
-        const float targetCenter = juce::jmax (0.08f, 1.0f - 2.0f * targetSide);
-        const float normalizer = juce::jmax (1.0e-6f, targetCenter + 2.0f * targetSide);
-        const float sideWeight = targetSide / normalizer;
-        const float centerWeight = targetCenter / normalizer;
-
-        auto smoothCurve = [sideWeight, centerWeight] (std::array<float, spectrumBins>& curve)
-        {
-            std::array<float, spectrumBins> work {};
-            for (int i = 0; i < spectrumBins; ++i)
-            {
-                const int leftIdx = juce::jlimit (0, spectrumBins - 1, i - 1);
-                const int rightIdx = juce::jlimit (0, spectrumBins - 1, i + 1);
-                const float left = curve[static_cast<size_t> (leftIdx)];
-                const float center = curve[static_cast<size_t> (i)];
-                const float right = curve[static_cast<size_t> (rightIdx)];
-                work[static_cast<size_t> (i)] = left * sideWeight + center * centerWeight + right * sideWeight;
-            }
-            curve = work;
-        };
-
-        for (int pass = 0; pass < smoothingPasses; ++pass)
-            smoothCurve (fileCurve);
-
         for (int i = 0; i < spectrumBins; ++i)
             accumulatedPerFileAverage[static_cast<size_t> (i)] += static_cast<double> (fileCurve[static_cast<size_t> (i)]);
 
@@ -984,14 +1880,9 @@ bool SpecraumAudioProcessor::buildSmoothPresetFromFolder (const juce::File& fold
         averagedPerFile[static_cast<size_t> (i)] = static_cast<float> (
             accumulatedPerFileAverage[static_cast<size_t> (i)] / static_cast<double> (filesAnalysed));
 
-    for (int i = 0; i < spectrumBins; ++i)
-    {
-        const float v = juce::jlimit (0.0f, 1.0f, averagedPerFile[static_cast<size_t> (i)]);
-        referenceSpectrumData[static_cast<size_t> (i)].store (v, std::memory_order_relaxed);
-    }
-
-    hasReferenceSpectrum.store (true, std::memory_order_relaxed);
-    referenceSpectrumRevision.fetch_add (1, std::memory_order_relaxed);
+    for (auto& v : averagedPerFile)
+        v = juce::jlimit (0.0f, 1.0f, v);
+    submitReferenceCurve (averagedPerFile, true);
 
     juce::String truncationNote;
     if (hitAudioFileLimit || hitCandidateFileLimit)
@@ -1016,16 +1907,17 @@ std::uint32_t SpecraumAudioProcessor::getReferenceSpectrumRevision() const noexc
     return referenceSpectrumRevision.load (std::memory_order_relaxed);
 }
 
-void SpecraumAudioProcessor::clearReferenceSpectrum() noexcept
+void SpecraumAudioProcessor::clearReferenceSpectrum()
 {
-    for (auto& v : referenceSpectrumData)
-        v.store (0.0f, std::memory_order_relaxed);
-    hasReferenceSpectrum.store (false, std::memory_order_relaxed);
-    referenceSpectrumRevision.fetch_add (1, std::memory_order_relaxed);
+    submitReferenceCurve ({}, false);
 }
 
-void SpecraumAudioProcessor::setReferenceSpectrumFromUi (const std::array<float, spectrumBins>& bins, bool hasData) noexcept
+void SpecraumAudioProcessor::setReferenceSpectrumFromUi (const std::array<float, spectrumBins>& bins, bool hasData)
 {
+    // While following the sidechain or the noise floor the audio thread owns the reference.
+    if (liveReferenceEnabled.load (std::memory_order_relaxed) || autoReferenceEnabled.load (std::memory_order_relaxed))
+        return;
+
     bool incomingHasData = hasData;
     if (incomingHasData)
     {
@@ -1052,22 +1944,116 @@ void SpecraumAudioProcessor::setReferenceSpectrumFromUi (const std::array<float,
     if (! changed)
         return;
 
-    for (int i = 0; i < spectrumBins; ++i)
-        referenceSpectrumData[static_cast<size_t> (i)].store (nextBins[static_cast<size_t> (i)], std::memory_order_relaxed);
+    submitReferenceCurve (nextBins, incomingHasData);
+}
+
+void SpecraumAudioProcessor::submitReferenceCurve (const std::array<float, spectrumBins>& bins, bool hasData)
+{
+    auto curve = std::make_unique<ReferenceCurve>();
+    curve->bins = bins;
+    curve->hasData = hasData;
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::referenceCurve;
+    command.curve = curve.release();
+    pushControlCommand (command);
 
-    hasReferenceSpectrum.store (incomingHasData, std::memory_order_relaxed);
+    publishReferenceSpectrum (bins, hasData);
+}
+
+void SpecraumAudioProcessor::publishReferenceSpectrum (const std::array<float, spectrumBins>& bins, bool hasData) noexcept
+{
+    for (int i = 0; i < spectrumBins; ++i)
+        referenceSpectrumData[static_cast<size_t> (i)].store (bins[static_cast<size_t> (i)], std::memory_order_relaxed);
+    hasReferenceSpectrum.store (hasData, std::memory_order_relaxed);
     referenceSpectrumRevision.fetch_add (1, std::memory_order_relaxed);
 }
 
+void SpecraumAudioProcessor::setLiveReferenceEnabled (bool enabled) noexcept
+{
+    liveReferenceEnabled.store (enabled, std::memory_order_relaxed);
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::liveReference;
+    command.enabled = enabled;
+    pushControlCommand (command);
+}
+
+bool SpecraumAudioProcessor::isLiveReferenceEnabled() const noexcept
+{
+    return liveReferenceEnabled.load (std::memory_order_relaxed);
+}
+
+void SpecraumAudioProcessor::setAutoReferenceEnabled (bool enabled) noexcept
+{
+    autoReferenceEnabled.store (enabled, std::memory_order_relaxed);
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::autoReference;
+    command.enabled = enabled;
+    pushControlCommand (command);
+}
+
+bool SpecraumAudioProcessor::isAutoReferenceEnabled() const noexcept
+{
+    return autoReferenceEnabled.load (std::memory_order_relaxed);
+}
+
+void SpecraumAudioProcessor::setStereoFieldEnabled (bool enabled) noexcept
+{
+    stereoFieldEnabled.store (enabled, std::memory_order_relaxed);
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::stereoField;
+    command.enabled = enabled;
+    pushControlCommand (command);
+}
+
+bool SpecraumAudioProcessor::isStereoFieldEnabled() const noexcept
+{
+    return stereoFieldEnabled.load (std::memory_order_relaxed);
+}
+
+void SpecraumAudioProcessor::setMatchEqConfig (bool enabled, int phaseMode, float amount)
+{
+    const auto phase = phaseMode == static_cast<int> (MatchEq::Phase::minimum) ? MatchEq::Phase::minimum
+                                                                              : MatchEq::Phase::linear;
+    matchEq.setPhase (phase);
+    matchEq.setAmount (amount);
+    matchEqEnabled.store (enabled, std::memory_order_relaxed);
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::matchEq;
+    command.enabled = enabled;
+    command.intValue = static_cast<int> (phase);
+    command.values[0] = matchEq.getAmount();
+    pushControlCommand (command);
+
+    if (enabled)
+        matchEq.start();
+    else
+        matchEq.stop();
+
+    setLatencySamples (enabled ? MatchEq::getLatencySamples (phase) : 0);
+}
+
+bool SpecraumAudioProcessor::isMatchEqEnabled() const noexcept
+{
+    return matchEqEnabled.load (std::memory_order_relaxed);
+}
+
 void SpecraumAudioProcessor::setResonanceSuppressorConfig (bool enabled,
                                                         float overlayLevelDb,
                                                         float overlayWidthDb,
                                                         float tiltDb) noexcept
 {
-    resonanceSuppressorEnabled.store (enabled, std::memory_order_relaxed);
-    resonanceOverlayLevelDb.store (juce::jlimit (-23.0f, 0.0f, overlayLevelDb), std::memory_order_relaxed);
-    resonanceOverlayWidthDb.store (juce::jlimit (3.0f, 18.0f, overlayWidthDb), std::memory_order_relaxed);
-    resonanceOverlayTiltDb.store (juce::jlimit (-24.0f, 24.0f, tiltDb), std::memory_order_relaxed);
+    ControlCommand command;
+    command.type = ControlCommand::Type::suppressorConfig;
+    command.enabled = enabled;
+    command.values = { juce::jlimit (-23.0f, 0.0f, overlayLevelDb),
+                       juce::jlimit (3.0f, 18.0f, overlayWidthDb),
+                       juce::jlimit (-24.0f, 24.0f, tiltDb) };
+    pushControlCommand (command);
 
     if (! enabled)
     {
@@ -1092,6 +2078,24 @@ std::array<float, 6> SpecraumAudioProcessor::getResonanceSuppressorGainSnapshot(
     return out;
 }
 
+void SpecraumAudioProcessor::getStereoFieldSnapshot (StereoFieldAnalyzer::Values& coherence,
+                                                    StereoFieldAnalyzer::Values& correlation,
+                                                    StereoFieldAnalyzer::Values& width) const noexcept
+{
+    stereoField.copySnapshot (coherence, correlation, width);
+}
+
+void SpecraumAudioProcessor::getGainReductionSnapshot (GainReductionSpectrum::Values& reductionDb) const noexcept
+{
+    gainReduction.copySnapshot (reductionDb);
+}
+
+void SpecraumAudioProcessor::getFilterResponseSnapshot (std::array<float, spectrumBins>& responseDb) const noexcept
+{
+    for (size_t i = 0; i < responseDb.size(); ++i)
+        responseDb[i] = filterResponseData[i].load (std::memory_order_relaxed);
+}
+
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new SpecraumAudioProcessor();
@@ -2,16 +2,51 @@
 
 #include <array>
 #include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include "SessionCapture.h"
+
+#include "dsp/AnalysisDecimator.h"
+#include "dsp/AnalysisWorker.h"
+#include "dsp/CommandQueue.h"
+#include "dsp/FilterResponse.h"
+#include "dsp/FractionalOctaveSmoother.h"
+#include "dsp/GainReductionSpectrum.h"
+#include "dsp/LoudnessTimeline.h"
+#include "dsp/MarkerProbes.h"
+#include "dsp/MatchEq.h"
+#include "dsp/NoiseFloorTracker.h"
+#include "dsp/OscilloscopeCapture.h"
+#include "dsp/RealFftBatch.h"
+#include "dsp/SharedDspTables.h"
+#include "dsp/SpectralPeakTracker.h"
+#include "dsp/SpectrumDisplay.h"
+#include "dsp/StereoFieldAnalyzer.h"
+#include "dsp/ThirdOctaveRta.h"
+
 class SpecraumAudioProcessor : public juce::AudioProcessor
 {
 public:
-    static constexpr int spectrumBins = 256;
-    static constexpr int oscilloscopeSamples = 256;
+    static constexpr int spectrumBins = SpectrumDisplaySet::baseBins;
     static constexpr int fftOrder = 11;
     static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int linearSpectrumBins = (fftSize / 2) + 1;
+
+    struct PitchReadout
+    {
+        float frequencyHz = 0.0f;
+        int midiNote = -1;
+        float cents = 0.0f;
+        float confidence = 0.0f;
+    };
+
+    // Called from processBlock with every analyzer frame at the base resolution. Offline hosts such
+    // as the analysis CLI use this to capture the full frame sequence; set it before processing starts.
+    using SpectrumFrameCallback = std::function<void (const std::array<float, spectrumBins>&)>;
 
     SpecraumAudioProcessor();
     ~SpecraumAudioProcessor() override;
@@ -38,60 +73,260 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-    std::array<float, spectrumBins> getSpectrumSnapshot() const;
+    // Copies the trace at the selected display resolution and returns its point count. With the
+    // 1/3-octave RTA on, the points show its bands instead of the FFT trace.
+    int getSpectrumSnapshot (std::vector<float>& out) const;
     std::array<float, spectrumBins> getReferenceSpectrumSnapshot() const;
-    std::array<float, oscilloscopeSamples> getOscilloscopeSnapshot() const;
-    std::array<float, oscilloscopeSamples> getOscilloscopeSnapshotRight() const;
+    // The main input averaged over several seconds, smoothed and normalised like the reference.
+    std::array<float, spectrumBins> getLongTermSpectrumSnapshot() const;
+    int getOscilloscopeSnapshot (std::vector<float>& left, std::vector<float>& right, std::uint32_t& sequence) const;
+    std::uint32_t getOscilloscopeSequence() const noexcept;
     void setOscilloscopeLengthMode (int mode) noexcept;
     int getOscilloscopeLengthMode() const noexcept;
+    void setOscilloscopeResolution (int points) noexcept;
+    void setOscilloscopeTrigger (float level, float windowMs) noexcept;
     void setSoloBand (int bandIndex) noexcept;
+    void setAnalyzerSmoothingFraction (int octaveFraction) noexcept;
+    int getAnalyzerSmoothingFraction() const noexcept;
+    void setSpectrumResolution (int numBins) noexcept;
+    int getSpectrumResolution() const noexcept;
+    // ThirdOctaveRta::Weighting: off shows the FFT trace.
+    void setRtaMode (int mode) noexcept;
+    int getRtaMode() const noexcept;
     double getCurrentAnalysisSampleRate() const noexcept;
     float getRmsDb() const noexcept;
     float getLufsIntegrated() const noexcept;
+    int getLoudnessTimeline (int level, std::vector<LoudnessTimeline::Point>& out) const;
+    void resetLoudnessTimeline() noexcept;
+    // Level history at up to MarkerProbes::maxProbes exact frequencies, see MarkerProbes::read.
+    void setMarkerProbe (int index, bool enabled, float frequencyHz, float bandwidthHz) noexcept;
+    int readMarkerProbes (std::uint64_t& nextPoint, std::vector<float>& out) const;
+    PitchReadout getPitchReadout() const noexcept;
+    void setSpectrogramMode (int mode) noexcept;
+    int readSpectrogram (std::uint64_t& nextColumn, std::vector<float>& out) const;
+    // High-resolution trace of one frequency window; an empty range turns it off.
+    void setZoomRange (float minHz, float maxHz) noexcept;
+    std::uint32_t readZoomSpectrum (std::vector<float>& out, float& minHz, float& maxHz) const;
+    // Centroid, rolloff, flatness, flux and chroma of every analyzer frame, see SpectralFeatures.
+    // Offline they are computed before the spectrum frame callback, so it can read them.
+    void setSpectralFeaturesEnabled (bool enabled) noexcept;
+    std::uint32_t readSpectralFeatures (SpectralFeatures::Values& out) const noexcept;
+    void setSpectrumFrameCallback (SpectrumFrameCallback callback);
     bool buildSmoothPresetFromFolder (const juce::File& folder, juce::String& outMessage, int smoothingAmount);
     bool hasReferenceSpectrumData() const noexcept;
     std::uint32_t getReferenceSpectrumRevision() const noexcept;
-    void clearReferenceSpectrum() noexcept;
-    void setReferenceSpectrumFromUi (const std::array<float, spectrumBins>& bins, bool hasData) noexcept;
+    // Message thread. Takes over the latest curve the audio thread derived itself: a live
+    // reference becomes the reference, a noise floor only the UI copy of it.
+    void updateDerivedReference();
+    void clearReferenceSpectrum();
+    void setReferenceSpectrumFromUi (const std::array<float, spectrumBins>& bins, bool hasData);
+    void setLiveReferenceEnabled (bool enabled) noexcept;
+    bool isLiveReferenceEnabled() const noexcept;
+    // Uses the input's own noise floor as the reference and publishes it like one. Without
+    // any reference the suppressor falls back to that floor regardless.
+    void setAutoReferenceEnabled (bool enabled) noexcept;
+    bool isAutoReferenceEnabled() const noexcept;
+    // Message thread; also reports the resulting latency to the host.
+    void setMatchEqConfig (bool enabled, int phaseMode, float amount);
+    bool isMatchEqEnabled() const noexcept;
     void setResonanceSuppressorConfig (bool enabled,
                                        float overlayLevelDb,
                                        float overlayWidthDb,
                                        float tiltDb) noexcept;
     std::array<float, 6> getResonanceSuppressorFrequencySnapshot() const noexcept;
     std::array<float, 6> getResonanceSuppressorGainSnapshot() const noexcept;
+    // Per-band coherence, correlation and width; only computed while enabled.
+    void setStereoFieldEnabled (bool enabled) noexcept;
+    bool isStereoFieldEnabled() const noexcept;
+    void getStereoFieldSnapshot (StereoFieldAnalyzer::Values& coherence,
+                                 StereoFieldAnalyzer::Values& correlation,
+                                 StereoFieldAnalyzer::Values& width) const noexcept;
+    // Per display band, how far the resonance suppressor pulled the signal down; zero while off.
+    void getGainReductionSnapshot (GainReductionSpectrum::Values& reductionDb) const noexcept;
+    // Combined suppressor and solo crossover magnitude in dB at the base display frequencies.
+    void getFilterResponseSnapshot (std::array<float, spectrumBins>& responseDb) const noexcept;
+
+    // Message thread, before prepareToPlay. The replay tool turns capture off for its own runs.
+    void setSessionCaptureEnabled (bool enabled) noexcept;
+    // Message thread. Re-issues a control command recorded by a session capture through the
+    // matching setter; malformed commands are ignored.
+    void replayControlCommand (const juce::MemoryBlock& data);
 
 private:
+    // Reference curves are handed to the audio thread by pointer and handed back for deletion,
+    // so the audio thread reads a plain array and never allocates or frees.
+    struct ReferenceCurve
+    {
+        std::array<float, spectrumBins> bins {};
+        bool hasData = false;
+    };
+
+    // Control changes from the UI and other non-audio threads, applied at the start of processBlock.
+    // Every type is a latest-value state (a timeline reset is idempotent), so pending commands
+    // coalesce per control and none can be lost however long the audio thread is away.
+    struct ControlCommand
+    {
+        enum class Type
+        {
+            soloBand,
+            referenceCurve,
+            suppressorConfig,
+            oscilloscopeMode,
+            oscilloscopeResolution,
+            oscilloscopeTrigger,
+            analyzerSmoothing,
+            spectrumResolution,
+            liveReference,
+            matchEq,
+            resetLoudnessTimeline,
+            markerProbe,
+            rtaMode,
+            autoReference,
+            stereoField
+        };
+        static constexpr int numTypes = static_cast<int> (Type::stereoField) + 1;
+
+        Type type = Type::soloBand;
+        int intValue = 0;
+        bool enabled = false;
+        std::array<float, 3> values {};
+        ReferenceCurve* curve = nullptr;
+    };
+
+    // A control command as written to a session capture, with the curve inlined.
+    struct CapturedControlCommand
+    {
+        std::int32_t type = 0;
+        std::int32_t intValue = 0;
+        std::int32_t enabled = 0;
+        std::int32_t hasCurve = 0;
+        float values[3] {};
+        float curveBins[spectrumBins] {};
+    };
+
+    struct SuppressorConfig
+    {
+        bool enabled = false;
+        float overlayLevelDb = 0.0f;
+        float overlayWidthDb = 12.0f;
+        float tiltDb = 5.0f;
+    };
+
+    static constexpr int controlQueueCapacity = 256;
+
     juce::AudioProcessorValueTreeState parameters;
 
-    juce::dsp::FFT fft { fftOrder };
-    juce::dsp::WindowingFunction<float> window { fftSize, juce::dsp::WindowingFunction<float>::hann, true };
+    RealFftBatch analysisFft { fftOrder };
+    std::shared_ptr<const SharedDspTables::Window> hannWindow = SharedDspTables::getWindow (SharedDspTables::WindowKind::hann, fftSize);
     std::array<float, fftSize> fifo {};
-    std::array<float, fftSize * 2> fftData {};
-    std::array<float, spectrumBins> smoothedSpectrum {};
-    std::array<std::atomic<float>, spectrumBins> spectrumData {};
+    std::array<float, fftSize> sideFifo {};
+    std::array<float, fftSize> sidechainFifo {};
+    std::array<float, fftSize> preSuppressorFifo {};
+    std::array<float, fftSize> analysisFrame {};
+    std::array<float, fftSize> sideFrame {};
+    std::array<float, fftSize> sidechainFrame {};
+    std::array<float, fftSize> preSuppressorFrame {};
+    std::array<RealFftBatch::Complex, linearSpectrumBins> midSpectrum {};
+    std::array<RealFftBatch::Complex, linearSpectrumBins> sideSpectrum {};
+    std::array<RealFftBatch::Complex, linearSpectrumBins> sidechainSpectrum {};
+    std::array<RealFftBatch::Complex, linearSpectrumBins> preSuppressorSpectrum {};
+    SpectrumDisplaySet spectrumDisplays;
+    // UI-facing copy of the reference; the audio thread works from referenceCurve.
     std::array<std::atomic<float>, spectrumBins> referenceSpectrumData {};
-    std::array<std::atomic<float>, oscilloscopeSamples> oscilloscopeData {};
-    std::array<std::atomic<float>, oscilloscopeSamples> oscilloscopeDataRight {};
-    std::array<float, spectrumBins> spectrumBinPosition {};
+    FractionalOctaveSmoother spectrumSmoother;
+    std::array<float, linearSpectrumBins> linearPower {};
+    std::array<float, linearSpectrumBins> leftPower {};
+    std::array<float, linearSpectrumBins> rightPower {};
+    std::array<float, linearSpectrumBins> crossPowerReal {};
+    std::array<float, linearSpectrumBins> crossPowerImag {};
+    StereoFieldAnalyzer stereoField;
+    std::atomic<bool> stereoFieldEnabled { false };
+    bool stereoFieldRequested = false;
+    SpectralPeakTracker peakTracker;
+    std::array<float, linearSpectrumBins> sidechainPower {};
+    std::array<float, linearSpectrumBins> preSuppressorPower {};
+    // Mono input ahead of the suppressor, for the gain-reduction spectrum; sized in prepareToPlay.
+    std::vector<float> preSuppressorMono;
+    GainReductionSpectrum gainReduction;
+    bool gainReductionActive = false;
+    FilterResponse filterResponse;
+    std::array<float, spectrumBins> filterResponseDb {};
+    std::array<std::atomic<float>, spectrumBins> filterResponseData {};
+    std::array<double, linearSpectrumBins> sidechainPowerAverage {};
+    std::array<FractionalOctaveSmoother::Band, spectrumBins> liveReferenceBands {};
+    std::array<float, spectrumBins> liveReferencePower {};
+    std::atomic<bool> liveReferenceEnabled { false };
+    bool liveReferenceRequested = false;
+    bool liveReferenceActive = false;
+    int liveReferenceFrames = 0;
+    int liveReferenceSamplesSincePublish = 0;
+    int liveReferencePublishIntervalSamples = 11025;
+    double liveReferenceAverageCoefficient = 0.015;
+    std::array<double, linearSpectrumBins> longTermPowerAverage {};
+    std::array<float, linearSpectrumBins> longTermPower {};
+    std::array<float, spectrumBins> longTermBandPower {};
+    std::array<std::atomic<float>, spectrumBins> longTermSpectrumData {};
+    int longTermFrames = 0;
+    int longTermSamplesSincePublish = 0;
+    double longTermAverageCoefficient = 0.01;
+    NoiseFloorTracker noiseFloor;
+    std::array<float, spectrumBins> noiseFloorBandPower {};
+    int noiseFloorSamplesSincePublish = 0;
+    std::atomic<bool> autoReferenceEnabled { false };
+    bool autoReferenceRequested = false;
+    std::array<float, spectrumBins> matchEqDifferenceDb {};
+    std::atomic<bool> matchEqEnabled { false };
+    bool matchEqRequested = false;
+    bool matchEqActive = false;
+    std::atomic<int> analyzerSmoothingIndex { FractionalOctaveSmoother::getFractionIndex (FractionalOctaveSmoother::defaultFraction) };
+    size_t spectrumSmoothingIndex = static_cast<size_t> (FractionalOctaveSmoother::getFractionIndex (FractionalOctaveSmoother::defaultFraction));
+    std::atomic<int> spectrumResolutionIndex { 0 };
+    int spectrumDisplayIndex = 0;
+    std::atomic<int> rtaModeIndex { 0 };
     std::atomic<bool> hasReferenceSpectrum { false };
     std::atomic<std::uint32_t> referenceSpectrumRevision { 0 };
-    int oscilloscopeLastBin = -1;
-    double oscilloscopeQuarterPositionSamples = 0.0;
-    int oscilloscopeLastLengthMode = 0;
+    OscilloscopeCapture oscilloscopeCapture;
+    AnalysisDecimator analysisDecimator;
+    AnalysisDecimator sideDecimator;
+    AnalysisDecimator sidechainDecimator;
+    AnalysisDecimator preSuppressorDecimator;
+    AnalysisWorker analysisWorker;
+    MatchEq matchEq;
+    SpectrumFrameCallback spectrumFrameCallback;
+    SessionCapture sessionCapture;
+    bool sessionCaptureEnabled = true;
+    // One slot per control type, plus one per marker probe after them. Guarded by
+    // controlProducerLock, which the audio thread only ever try-locks.
+    static constexpr int numControlSlots = ControlCommand::numTypes + MarkerProbes::maxProbes;
+    std::array<ControlCommand, numControlSlots> pendingControls {};
+    std::array<bool, numControlSlots> pendingControlSet {};
+    std::atomic<bool> hasPendingControls { false };
+    CommandQueue<ReferenceCurve*> retiredReferenceCurves { controlQueueCapacity };
+    juce::SpinLock controlProducerLock;
+    std::unique_ptr<ReferenceCurve> referenceCurve = std::make_unique<ReferenceCurve>();
+    // Audio thread only. Stands in for, or replaces, referenceCurve in the suppressor.
+    ReferenceCurve noiseFloorCurve;
+    // Audio thread only. Replaces referenceCurve while following the sidechain, until the
+    // message thread has handed the same curve over as the reference.
+    ReferenceCurve liveReferenceCurve;
+    // The latest live reference or noise floor, from the audio thread to updateDerivedReference().
+    // An odd revision marks a write in progress.
+    std::array<std::atomic<float>, spectrumBins> derivedReferenceData {};
+    std::atomic<std::uint32_t> derivedReferenceRevision { 0 };
+    std::atomic<bool> derivedReferenceIsLive { false };
+    std::uint32_t lastDerivedReferenceRevision = 0;
+    int oscilloscopeMode = 0;
     int fifoIndex = 0;
     float fftMagnitudeToDbScale = 1.0f;
     std::atomic<double> currentSampleRate { 44100.0 };
+    std::atomic<double> analysisSampleRate { 44100.0 };
     std::atomic<float> currentTempoBpm { 120.0f };
     std::atomic<int> oscilloscopeLengthMode { 0 };
     std::atomic<float> rmsDb { -96.0f };
     std::atomic<float> lufsIntegrated { -96.0f };
-    std::atomic<int> soloBand { -1 };
+    int soloBand = -1;
     float rmsSmoothedDb = -96.0f;
-    std::array<float, spectrumBins> spectrumBinFrequencyHz {};
-    std::atomic<bool> resonanceSuppressorEnabled { false };
-    std::atomic<float> resonanceOverlayLevelDb { 0.0f };
-    std::atomic<float> resonanceOverlayWidthDb { 12.0f };
-    std::atomic<float> resonanceOverlayTiltDb { 5.0f };
+    SuppressorConfig suppressorConfig;
 
     static constexpr int resonanceSuppressorBands = 6;
     struct ResonanceSuppressorBandState
@@ -100,8 +335,17 @@ private:
         float currentFrequencyHz = 1000.0f;
         float currentGainDb = 0.0f;
         float currentQ = 5.0f;
+        // The parameters the filters were last designed with, and the peak track the band follows.
+        float designedFrequencyHz = 1000.0f;
+        float designedGainDb = 0.0f;
+        float designedQ = 5.0f;
+        int trackId = -1;
     };
     std::array<ResonanceSuppressorBandState, resonanceSuppressorBands> resonanceBands;
+    // Detection and smoothing run every suppressorUpdateIntervalSamples, whatever the host's
+    // block size; blocks are split at the update points.
+    int suppressorUpdateIntervalSamples = 240;
+    int suppressorSamplesUntilUpdate = 0;
     std::array<std::atomic<float>, resonanceSuppressorBands> resonanceBandFrequencyUi {};
     std::array<std::atomic<float>, resonanceSuppressorBands> resonanceBandGainUi {};
 
@@ -115,19 +359,38 @@ private:
     std::array<juce::dsp::IIR::Filter<float>, 2> soloLowPass5k;
     double lufsWeightedEnergySum = 0.0;
     double lufsWeightedSampleCount = 0.0;
+    LoudnessTimeline loudnessTimeline;
+    MarkerProbes markerProbes;
+    ThirdOctaveRta thirdOctaveRta;
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    void pushAnalyserSample (float sample) noexcept;
+    void pushControlCommand (const ControlCommand& command) noexcept;
+    static int getControlSlot (const ControlCommand& command) noexcept;
+    // Control threads only; the audio thread posts its own curves with postDerivedReference().
+    void submitReferenceCurve (const std::array<float, spectrumBins>& bins, bool hasData);
+    void publishReferenceSpectrum (const std::array<float, spectrumBins>& bins, bool hasData) noexcept;
+    void applyControlCommands() noexcept;
+    void applyControlCommand (const ControlCommand& command) noexcept;
+    void freeRetiredReferenceCurves() noexcept;
+    void captureControlCommand (const ControlCommand& command) noexcept;
+    void captureControlState() noexcept;
+    void pushAnalyserSample (float sample, float sideSample, float sidechainSample, float preSuppressorSample) noexcept;
+    void pushAnalysisChunk (float* samples, float* sideSamples, float* sidechainSamples, float* preSuppressorSamples, int numSamples) noexcept;
     void buildSpectrumFrame() noexcept;
-    void updateSpectrumLayout (double sampleRate) noexcept;
+    void publishFilterResponse() noexcept;
+    void updateLiveReference() noexcept;
+    void updateLongTermSpectrum() noexcept;
+    void updateNoiseFloor() noexcept;
+    void postDerivedReference (const std::array<float, spectrumBins>& bins, bool isLive) noexcept;
+    const ReferenceCurve& getActiveReferenceCurve() const noexcept;
+    const ReferenceCurve& getSuppressorCurve() const noexcept;
+    void updateSpectrumLayout (double sampleRate);
     void updateSoloBandFilters (double sampleRate) noexcept;
     void resetSoloBandFilters() noexcept;
     void applySoloBandToBuffer (juce::AudioBuffer<float>& buffer) noexcept;
     void resetResonanceSuppressor() noexcept;
     void updateResonanceSuppressorTargets (int numSamples) noexcept;
     void applyResonanceSuppressorToBuffer (juce::AudioBuffer<float>& buffer) noexcept;
-    static std::array<float, spectrumBins> buildSpectrumBinPositions (double sampleRate) noexcept;
-    static float computeFftMagnitudeScale();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpecraumAudioProcessor)
 };
@@ -0,0 +1,48 @@
+#include "AnalysisDecimator.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr double kMinimumOutputRate = 44100.0;
+} // namespace
+
+void AnalysisDecimator::prepare (double sampleRate) noexcept
+{
+    numStages = 0;
+    outputSampleRate = sampleRate;
+    while (numStages < maxStages && outputSampleRate * 0.5 >= kMinimumOutputRate)
+    {
+        outputSampleRate *= 0.5;
+        ++numStages;
+    }
+
+    reset();
+}
+
+void AnalysisDecimator::reset() noexcept
+{
+    for (auto& stage : earlyStages)
+        stage.reset();
+    finalStage.reset();
+}
+
+int AnalysisDecimator::process (const float* input, int numSamples, float* output) noexcept
+{
+    if (numStages == 0)
+    {
+        if (input != output)
+            std::copy (input, input + numSamples, output);
+        return numSamples;
+    }
+
+    const float* source = input;
+    int numRemaining = numSamples;
+    for (int stage = 0; stage < numStages - 1; ++stage)
+    {
+        numRemaining = earlyStages[static_cast<size_t> (stage)].process (source, numRemaining, output);
+        source = output;
+    }
+
+    return finalStage.process (source, numRemaining, output);
+}
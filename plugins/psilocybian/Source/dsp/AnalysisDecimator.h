@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+
+#include "HalfBandDecimator.h"
+
+// Cascade of half-band decimators that brings high session rates down to 44.1/48 kHz before
+// spectrum analysis, so the fixed-size FFT keeps its low-end resolution and frame rate at 96
+// and 192 kHz. The last stage has the narrow transition band needed to keep aliasing about
+// 80 dB down below 20 kHz; the earlier stages only need to clear the much wider gap above it.
+class AnalysisDecimator
+{
+public:
+    static constexpr int maxStages = 3;
+
+    // Message thread, audio stopped. Rates below 88.2 kHz pass through unchanged.
+    void prepare (double sampleRate) noexcept;
+
+    int getNumStages() const noexcept { return numStages; }
+    double getOutputSampleRate() const noexcept { return outputSampleRate; }
+
+    // Audio thread. process() returns the number of samples written to output, at most
+    // numSamples / 2^stages rounded up. Input and output may alias.
+    void reset() noexcept;
+    int process (const float* input, int numSamples, float* output) noexcept;
+
+private:
+    std::array<HalfBandDecimator<19>, maxStages - 1> earlyStages;
+    HalfBandDecimator<111> finalStage;
+    int numStages = 0;
+    double outputSampleRate = 44100.0;
+};
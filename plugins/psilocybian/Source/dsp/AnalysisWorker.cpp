@@ -0,0 +1,92 @@
+#include "AnalysisWorker.h"
+
+#include <cmath>
+
+namespace
+{
+// The stream arrives decimated to 44.1/48 kHz; two seconds of it covers any realistic worker stall.
+constexpr double kFifoSeconds = 2.0;
+// Fifteen frames of the 2048-point analyzer FFT, over half a second of frames at 48 kHz.
+constexpr int kSpectrumFifoCapacity = 1 << 14;
+constexpr double kIdleWaitMs = 5.0;
+} // namespace
+
+AnalysisWorker::AnalysisWorker()
+    : juce::Thread ("SPECRAUM analysis"),
+      fifo (0),
+      spectrumFifo (kSpectrumFifoCapacity)
+{
+}
+
+AnalysisWorker::~AnalysisWorker()
+{
+    stop();
+}
+
+void AnalysisWorker::prepare (double sampleRate, int fftSize, bool realtime)
+{
+    stop();
+    // Offline nothing drains the sample stream, so it is not kept at all.
+    fifo.setCapacity (realtime ? static_cast<int> (std::ceil (kFifoSeconds * sampleRate)) : 0);
+    spectrumFifo.reset();
+    pitchDetector.prepare (sampleRate, readChunkSize);
+    spectrogram.prepare (sampleRate);
+    zoomSpectrum.prepare (sampleRate);
+    spectralFeatures.prepare (sampleRate, fftSize);
+    spectrumFrame.assign (static_cast<size_t> (spectralFeatures.getNumBins()), 0.0f);
+
+    runsInline = ! realtime;
+    if (realtime)
+        startThread (juce::Thread::Priority::low);
+}
+
+void AnalysisWorker::stop()
+{
+    stopThread (1000);
+}
+
+void AnalysisWorker::pushSamples (const float* samples, int numSamples) noexcept
+{
+    if (! runsInline)
+        fifo.push (samples, numSamples);
+}
+
+void AnalysisWorker::pushSpectrum (const float* linearPower) noexcept
+{
+    if (! featuresEnabled.load (std::memory_order_relaxed))
+        return;
+
+    const int numBins = spectralFeatures.getNumBins();
+    if (runsInline)
+        spectralFeatures.process (linearPower);
+    else if (spectrumFifo.getFreeSpace() >= numBins)
+        spectrumFifo.push (linearPower, numBins);
+}
+
+void AnalysisWorker::run()
+{
+    const int numSpectrumBins = spectralFeatures.getNumBins();
+
+    while (! threadShouldExit())
+    {
+        if (fifo.takeDroppedSampleCount() > 0)
+            pitchDetector.reset();
+
+        while (spectrumFifo.getNumReady() >= numSpectrumBins)
+        {
+            spectrumFifo.pop (spectrumFrame.data(), numSpectrumBins);
+            spectralFeatures.process (spectrumFrame.data());
+        }
+
+        const int numRead = fifo.pop (readChunk.data(), readChunkSize);
+        if (numRead == 0)
+        {
+            wait (kIdleWaitMs);
+            continue;
+        }
+
+        pitchDetector.process (readChunk.data(), numRead);
+        spectrogram.process (readChunk.data(), numRead);
+        zoomSpectrum.process (readChunk.data(), numRead);
+    }
+}
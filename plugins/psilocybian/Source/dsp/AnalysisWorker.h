@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include "PitchDetector.h"
+#include "ReassignedSpectrogram.h"
+#include "SampleFifo.h"
+#include "SpectralFeatures.h"
+#include "ZoomSpectrum.h"
+
+// Background thread for analysis that is too heavy or too irregular for the audio callback.
+// The audio thread only copies its mono analysis stream into a lock-free FIFO; the worker
+// drains it and feeds the detectors, which publish their results through atomics. Linear
+// power spectra from the analyzer's own FFT take a second FIFO, whole frames at a time, to
+// the spectral feature stage while it is enabled.
+class AnalysisWorker : private juce::Thread
+{
+public:
+    AnalysisWorker();
+    ~AnalysisWorker() override;
+
+    // Message thread (prepareToPlay / releaseResources). Stops the worker while detectors are
+    // reconfigured and sizes the sample FIFO from the analysis rate. Offline renders outrun the
+    // worker, so without realtime the thread stays stopped, no sample FIFO is kept and only the
+    // feature stage runs, inline on the pushing thread.
+    void prepare (double sampleRate, int fftSize, bool realtime);
+    void stop();
+
+    // Audio thread.
+    void pushSamples (const float* samples, int numSamples) noexcept;
+    // fftSize / 2 + 1 bins. Frames that do not fit are dropped whole.
+    void pushSpectrum (const float* linearPower) noexcept;
+
+    // Any thread.
+    PitchDetector::Estimate getPitchEstimate() const noexcept { return pitchDetector.getEstimate(); }
+    void setSpectrogramMode (ReassignedSpectrogram::Mode mode) noexcept { spectrogram.setMode (mode); }
+    int readSpectrogram (std::uint64_t& nextColumn, std::vector<float>& out) const { return spectrogram.read (nextColumn, out); }
+    void setZoomRange (float minHz, float maxHz) noexcept { zoomSpectrum.setRange (minHz, maxHz); }
+    std::uint32_t readZoomSpectrum (std::vector<float>& out, float& minHz, float& maxHz) const { return zoomSpectrum.read (out, minHz, maxHz); }
+    void setFeaturesEnabled (bool enabled) noexcept { featuresEnabled.store (enabled, std::memory_order_relaxed); }
+    bool areFeaturesEnabled() const noexcept { return featuresEnabled.load (std::memory_order_relaxed); }
+    std::uint32_t readSpectralFeatures (SpectralFeatures::Values& out) const noexcept { return spectralFeatures.read (out); }
+
+private:
+    static constexpr int readChunkSize = 1024;
+
+    void run() override;
+
+    SampleFifo fifo;
+    std::array<float, readChunkSize> readChunk {};
+    SampleFifo spectrumFifo;
+    std::vector<float> spectrumFrame;
+    std::atomic<bool> featuresEnabled { false };
+    bool runsInline = true;
+    SpectralFeatures spectralFeatures;
+    PitchDetector pitchDetector;
+    ReassignedSpectrogram spectrogram;
+    ZoomSpectrum zoomSpectrum;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+// Bounded single-producer/single-consumer queue of small copyable commands with preallocated
+// storage. Neither side blocks or allocates; push() fails when the queue is full. Callers with
+// several producer threads serialise them on their side.
+template <typename Command>
+class CommandQueue
+{
+public:
+    explicit CommandQueue (int capacity)
+        : fifo (capacity + 1),
+          slots (static_cast<size_t> (capacity + 1))
+    {
+    }
+
+    bool push (const Command& command) noexcept
+    {
+        const auto scope = fifo.write (1);
+        if (scope.blockSize1 + scope.blockSize2 == 0)
+            return false;
+
+        slots[static_cast<size_t> (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = command;
+        return true;
+    }
+
+    // Hands every queued command to apply() in order.
+    template <typename Apply>
+    void drain (Apply&& apply) noexcept
+    {
+        const auto scope = fifo.read (fifo.getNumReady());
+        for (int i = 0; i < scope.blockSize1; ++i)
+            apply (slots[static_cast<size_t> (scope.startIndex1 + i)]);
+        for (int i = 0; i < scope.blockSize2; ++i)
+            apply (slots[static_cast<size_t> (scope.startIndex2 + i)]);
+    }
+
+private:
+    juce::AbstractFifo fifo;
+    std::vector<Command> slots;
+};
@@ -0,0 +1,220 @@
+#include "FftEngine.h"
+
+#include <cmath>
+#include <utility>
+
+namespace
+{
+// One radix-4 decimation-in-frequency butterfly (forward, W4 = -i), written once for plain
+// floats and for SIMD registers holding several independent butterflies.
+template <typename Value>
+inline void radix4Butterfly (const Value& ar, const Value& ai, const Value& br, const Value& bi,
+                             const Value& cr, const Value& ci, const Value& dr, const Value& di,
+                             const Value& w1r, const Value& w1i, const Value& w2r, const Value& w2i,
+                             const Value& w3r, const Value& w3i,
+                             Value* outR, Value* outI) noexcept
+{
+    const Value apcR = ar + cr, apcI = ai + ci;
+    const Value amcR = ar - cr, amcI = ai - ci;
+    const Value bpdR = br + dr, bpdI = bi + di;
+    const Value bmdR = br - dr, bmdI = bi - di;
+
+    outR[0] = apcR + bpdR;
+    outI[0] = apcI + bpdI;
+
+    // (a - c) - i (b - d)
+    const Value t1r = amcR + bmdI, t1i = amcI - bmdR;
+    outR[1] = t1r * w1r - t1i * w1i;
+    outI[1] = t1r * w1i + t1i * w1r;
+
+    const Value t2r = apcR - bpdR, t2i = apcI - bpdI;
+    outR[2] = t2r * w2r - t2i * w2i;
+    outI[2] = t2r * w2i + t2i * w2r;
+
+    // (a - c) + i (b - d)
+    const Value t3r = amcR - bmdI, t3i = amcI + bmdR;
+    outR[3] = t3r * w3r - t3i * w3i;
+    outI[3] = t3r * w3i + t3i * w3r;
+}
+} // namespace
+
+const char* FftEngine::getBackendName (Backend backendToName) noexcept
+{
+    return backendToName == Backend::juce ? "juce" : "bundled";
+}
+
+FftEngine::FftEngine (int order, Backend backendToUse)
+    : backend (backendToUse),
+      size (1 << order)
+{
+    if (backend == Backend::juce)
+    {
+        juceFft = std::make_unique<juce::dsp::FFT> (order);
+        return;
+    }
+
+    // Radix-4 passes while at least four points remain, then one radix-2 pass for odd orders.
+    int length = size;
+    int stride = 1;
+    size_t twiddleCount = 0;
+    while (length >= 4)
+    {
+        passes.push_back ({ length, stride, twiddleCount });
+        twiddleCount += static_cast<size_t> (6 * (length / 4));
+        length /= 4;
+        stride *= 4;
+    }
+    finalRadix2 = length == 2;
+
+    twiddles.resize (twiddleCount);
+    for (const auto& pass : passes)
+    {
+        const int m = pass.length / 4;
+        float* w = twiddles.data() + pass.twiddleOffset;
+        for (int p = 0; p < m; ++p)
+        {
+            for (int k = 1; k <= 3; ++k)
+            {
+                const double angle = -juce::MathConstants<double>::twoPi * static_cast<double> (k * p) / static_cast<double> (pass.length);
+                w[(2 * (k - 1)) * m + p] = static_cast<float> (std::cos (angle));
+                w[(2 * (k - 1) + 1) * m + p] = static_cast<float> (std::sin (angle));
+            }
+        }
+    }
+
+    const auto lanes = Register::size();
+    const auto bufferSize = ((static_cast<size_t> (size) + lanes - 1) / lanes) * lanes;
+    storage.assign (4 * bufferSize + lanes, 0.0f);
+    float* aligned = Register::getNextSIMDAlignedPtr (storage.data());
+    for (size_t b = 0; b < 4; ++b)
+        buffers[b] = aligned + b * bufferSize;
+}
+
+void FftEngine::perform (const Complex* input, Complex* output) noexcept
+{
+    if (juceFft != nullptr)
+    {
+        juceFft->perform (input, output, false);
+        return;
+    }
+
+    float* re = buffers[0];
+    float* im = buffers[1];
+    for (int n = 0; n < size; ++n)
+    {
+        re[n] = input[n].real();
+        im[n] = input[n].imag();
+    }
+
+    performBundled();
+
+    // An odd number of passes leaves the result in the second pair of buffers.
+    const size_t numPasses = passes.size() + (finalRadix2 ? 1u : 0u);
+    const size_t result = (numPasses % 2) * 2;
+    re = buffers[result];
+    im = buffers[result + 1];
+    for (int n = 0; n < size; ++n)
+        output[n] = Complex (re[n], im[n]);
+}
+
+void FftEngine::performBundled() noexcept
+{
+    float* xr = buffers[0];
+    float* xi = buffers[1];
+    float* yr = buffers[2];
+    float* yi = buffers[3];
+
+    for (const auto& pass : passes)
+    {
+        radix4Pass (pass, twiddles.data() + pass.twiddleOffset, xr, xi, yr, yi);
+        std::swap (xr, yr);
+        std::swap (xi, yi);
+    }
+
+    if (finalRadix2)
+        radix2Pass (size / 2, xr, xi, yr, yi);
+}
+
+void FftEngine::radix4Pass (const Pass& pass, const float* w,
+                            const float* xr, const float* xi, float* yr, float* yi) noexcept
+{
+    const int s = pass.stride;
+    const int m = pass.length / 4;
+    const int lanes = static_cast<int> (Register::size());
+
+    for (int p = 0; p < m; ++p)
+    {
+        const int in0 = s * p;
+        const int in1 = s * (p + m);
+        const int in2 = s * (p + 2 * m);
+        const int in3 = s * (p + 3 * m);
+        const int out = s * 4 * p;
+
+        if (s % lanes == 0)
+        {
+            const auto w1r = Register::expand (w[p]), w1i = Register::expand (w[m + p]);
+            const auto w2r = Register::expand (w[2 * m + p]), w2i = Register::expand (w[3 * m + p]);
+            const auto w3r = Register::expand (w[4 * m + p]), w3i = Register::expand (w[5 * m + p]);
+
+            for (int q = 0; q < s; q += lanes)
+            {
+                Register outR[4], outI[4];
+                radix4Butterfly (Register::fromRawArray (xr + in0 + q), Register::fromRawArray (xi + in0 + q),
+                                 Register::fromRawArray (xr + in1 + q), Register::fromRawArray (xi + in1 + q),
+                                 Register::fromRawArray (xr + in2 + q), Register::fromRawArray (xi + in2 + q),
+                                 Register::fromRawArray (xr + in3 + q), Register::fromRawArray (xi + in3 + q),
+                                 w1r, w1i, w2r, w2i, w3r, w3i, outR, outI);
+
+                for (int k = 0; k < 4; ++k)
+                {
+                    outR[k].copyToRawArray (yr + out + k * s + q);
+                    outI[k].copyToRawArray (yi + out + k * s + q);
+                }
+            }
+            continue;
+        }
+
+        for (int q = 0; q < s; ++q)
+        {
+            float outR[4], outI[4];
+            radix4Butterfly (xr[in0 + q], xi[in0 + q], xr[in1 + q], xi[in1 + q],
+                             xr[in2 + q], xi[in2 + q], xr[in3 + q], xi[in3 + q],
+                             w[p], w[m + p], w[2 * m + p], w[3 * m + p], w[4 * m + p], w[5 * m + p],
+                             outR, outI);
+
+            for (int k = 0; k < 4; ++k)
+            {
+                yr[out + k * s + q] = outR[k];
+                yi[out + k * s + q] = outI[k];
+            }
+        }
+    }
+}
+
+void FftEngine::radix2Pass (int stride, const float* xr, const float* xi, float* yr, float* yi) noexcept
+{
+    const int lanes = static_cast<int> (Register::size());
+    int q = 0;
+    if (stride % lanes == 0)
+    {
+        for (; q < stride; q += lanes)
+        {
+            const auto ar = Register::fromRawArray (xr + q), ai = Register::fromRawArray (xi + q);
+            const auto br = Register::fromRawArray (xr + stride + q), bi = Register::fromRawArray (xi + stride + q);
+            (ar + br).copyToRawArray (yr + q);
+            (ai + bi).copyToRawArray (yi + q);
+            (ar - br).copyToRawArray (yr + stride + q);
+            (ai - bi).copyToRawArray (yi + stride + q);
+        }
+    }
+
+    for (; q < stride; ++q)
+    {
+        const float ar = xr[q], ai = xi[q];
+        const float br = xr[stride + q], bi = xi[stride + q];
+        yr[q] = ar + br;
+        yi[q] = ai + bi;
+        yr[stride + q] = ar - br;
+        yi[stride + q] = ai - bi;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+// Chooses the FFT behind FftEngine by default. 0 uses the bundled transform; 1 routes through
+// juce::dsp::FFT and whichever engine JUCE was configured with (FFTW, IPP, Accelerate or its
+// scalar fallback). Set from CMake with SPECRAUM_FFT_BACKEND.
+#ifndef SPECRAUM_USE_JUCE_FFT
+ #define SPECRAUM_USE_JUCE_FFT 0
+#endif
+
+// Forward complex FFT of 2^order points, unnormalised like juce::dsp::FFT. The bundled backend
+// is a radix-4 Stockham transform on split real/imaginary buffers: every pass reads and writes
+// contiguous runs, so all but the first pass run on juce::dsp::SIMDRegister, and the output
+// comes out in natural order without a bit-reversal pass. It needs nothing beyond JUCE's SIMD
+// wrapper, so analysis costs the same on every machine.
+class FftEngine
+{
+public:
+    using Complex = std::complex<float>;
+
+    enum class Backend
+    {
+        bundled,
+        juce
+    };
+
+    static constexpr Backend defaultBackend = SPECRAUM_USE_JUCE_FFT ? Backend::juce : Backend::bundled;
+
+    explicit FftEngine (int order, Backend backend = defaultBackend);
+
+    int getSize() const noexcept { return size; }
+    Backend getBackend() const noexcept { return backend; }
+    static const char* getBackendName (Backend backend) noexcept;
+
+    // Realtime safe. Input and output hold getSize() values and must not overlap.
+    void perform (const Complex* input, Complex* output) noexcept;
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    struct Pass
+    {
+        int length = 0;    // points per sub-transform at this pass
+        int stride = 0;    // interleaved sub-transforms
+        size_t twiddleOffset = 0;
+    };
+
+    void performBundled() noexcept;
+    static void radix4Pass (const Pass& pass, const float* twiddles,
+                            const float* xr, const float* xi, float* yr, float* yi) noexcept;
+    static void radix2Pass (int stride, const float* xr, const float* xi, float* yr, float* yi) noexcept;
+
+    Backend backend = defaultBackend;
+    int size = 0;
+    std::unique_ptr<juce::dsp::FFT> juceFft;
+
+    std::vector<Pass> passes;
+    bool finalRadix2 = false;
+    // Per radix-4 pass: W^p, W^2p, W^3p for every p, as six runs of re/im.
+    std::vector<float> twiddles;
+    std::vector<float> storage;
+    float* buffers[4] {};   // re A, im A, re B, im B; SIMD aligned
+};
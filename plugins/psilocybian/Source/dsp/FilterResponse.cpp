@@ -0,0 +1,82 @@
+#include "FilterResponse.h"
+
+#include <cmath>
+
+void FilterResponse::prepare (double sampleRate, const float* frequenciesHz, int numPointsToUse)
+{
+    const auto lanes = static_cast<int> (Register::size());
+    numPoints = numPointsToUse;
+    paddedPoints = ((numPoints + lanes - 1) / lanes) * lanes;
+
+    storage.assign (static_cast<size_t> (numTables * paddedPoints + lanes), 0.0f);
+    float* aligned = Register::getNextSIMDAlignedPtr (storage.data());
+    for (int t = 0; t < numTables; ++t)
+        tables[t] = aligned + t * paddedPoints;
+
+    // Padding points sit at DC, where every table entry is finite.
+    for (int i = 0; i < paddedPoints; ++i)
+    {
+        const double frequency = i < numPoints ? static_cast<double> (frequenciesHz[i]) : 0.0;
+        const double w = juce::MathConstants<double>::twoPi * frequency / juce::jmax (1.0, sampleRate);
+        const double sinHalf = std::sin (0.5 * w);
+        const double sinW = std::sin (w);
+        tables[oneMinusCos1][i] = static_cast<float> (2.0 * sinHalf * sinHalf);
+        tables[sin1][i] = static_cast<float> (sinW);
+        tables[oneMinusCos2][i] = static_cast<float> (2.0 * sinW * sinW);
+    }
+
+    reset();
+}
+
+void FilterResponse::reset() noexcept
+{
+    for (int i = 0; i < paddedPoints; ++i)
+        tables[power][i] = 1.0f;
+}
+
+void FilterResponse::addSection (const juce::dsp::IIR::Coefficients<float>& coefficients) noexcept
+{
+    // Stored normalised as b0..bN, a1..aN.
+    const float* c = coefficients.getRawCoefficients();
+    const bool secondOrder = coefficients.getFilterOrder() == 2;
+    const double b[] = { c[0], c[1], secondOrder ? c[2] : 0.0f };
+    const double a[] = { 1.0, secondOrder ? c[3] : c[2], secondOrder ? c[4] : 0.0f };
+
+    // The coefficient sums are where the cancellation happens, so they are formed in double.
+    const auto numDc = Register::expand (static_cast<float> (b[0] + b[1] + b[2]));
+    const auto numSlope = Register::expand (static_cast<float> (b[1] + 2.0 * b[2]));
+    const auto denDc = Register::expand (static_cast<float> (a[0] + a[1] + a[2]));
+    const auto denSlope = Register::expand (static_cast<float> (a[1] + 2.0 * a[2]));
+    const auto negB1 = Register::expand (static_cast<float> (-b[1]));
+    const auto negB2 = Register::expand (static_cast<float> (-b[2]));
+    const auto negTwoB2 = Register::expand (static_cast<float> (-2.0 * b[2]));
+    const auto negA1 = Register::expand (static_cast<float> (-a[1]));
+    const auto negA2 = Register::expand (static_cast<float> (-a[2]));
+    const auto negTwoA2 = Register::expand (static_cast<float> (-2.0 * a[2]));
+
+    const auto lanes = static_cast<int> (Register::size());
+    for (int i = 0; i < paddedPoints; i += lanes)
+    {
+        const auto m1 = Register::fromRawArray (tables[oneMinusCos1] + i);
+        const auto s1 = Register::fromRawArray (tables[sin1] + i);
+        const auto m2 = Register::fromRawArray (tables[oneMinusCos2] + i);
+
+        const auto numRe = Register::multiplyAdd (Register::multiplyAdd (numDc, negB1, m1), negB2, m2);
+        const auto numIm = s1 * Register::multiplyAdd (numSlope, negTwoB2, m1);
+        const auto denRe = Register::multiplyAdd (Register::multiplyAdd (denDc, negA1, m1), negA2, m2);
+        const auto denIm = s1 * Register::multiplyAdd (denSlope, negTwoA2, m1);
+
+        Register::multiplyAdd (numRe * numRe, numIm, numIm).copyToRawArray (tables[numerator] + i);
+        Register::multiplyAdd (denRe * denRe, denIm, denIm).copyToRawArray (tables[denominator] + i);
+    }
+
+    for (int i = 0; i < numPoints; ++i)
+        tables[power][i] *= tables[numerator][i] / juce::jmax (1.0e-30f, tables[denominator][i]);
+}
+
+void FilterResponse::getResponseDb (float* responseDb) const noexcept
+{
+    const float floorPower = std::pow (10.0f, 0.1f * floorDb);
+    for (int i = 0; i < numPoints; ++i)
+        responseDb[i] = 10.0f * std::log10 (juce::jmax (floorPower, tables[power][i]));
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+// Magnitude response of a cascade of biquads at a fixed set of frequencies, for drawing the
+// filters the processor is actually running. Each section's
+//   |H(e^jw)|^2 = |b0 + b1 e^-jw + b2 e^-2jw|^2 / |1 + a1 e^-jw + a2 e^-2jw|^2
+// is a handful of multiply-adds per point on juce::dsp::SIMDRegister, written around DC as
+//   Re = (b0 + b1 + b2) - b1 (1 - cos w) - b2 (1 - cos 2w),  Im = sin w (b1 + 2 b2 - 2 b2 (1 - cos w))
+// with 1 - cos w tabulated as 2 sin^2 (w/2): low-frequency sections have both polynomials close
+// to zero there, and the direct form loses them to cancellation. Those small values would also
+// underflow if multiplied across sections, so each section's ratio is folded into the running
+// response on its own, in a scalar pass since the SIMD wrapper has no division.
+class FilterResponse
+{
+public:
+    static constexpr float floorDb = -120.0f;
+
+    // Message thread, audio stopped.
+    void prepare (double sampleRate, const float* frequenciesHz, int numPoints);
+
+    int getNumPoints() const noexcept { return numPoints; }
+
+    // Audio thread.
+    void reset() noexcept;
+    // First- or second-order sections, as designed by juce::dsp::IIR::Coefficients.
+    void addSection (const juce::dsp::IIR::Coefficients<float>& coefficients) noexcept;
+    void getResponseDb (float* responseDb) const noexcept;
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    enum Table
+    {
+        oneMinusCos1,
+        sin1,
+        oneMinusCos2,
+        numerator,
+        denominator,
+        power,
+        numTables
+    };
+
+    int numPoints = 0;
+    int paddedPoints = 0;
+    std::vector<float> storage;
+    float* tables[numTables] {};
+};
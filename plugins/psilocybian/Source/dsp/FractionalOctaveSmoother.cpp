@@ -0,0 +1,111 @@
+#include "FractionalOctaveSmoother.h"
+
+#include <cmath>
+
+#include <juce_core/juce_core.h>
+
+int FractionalOctaveSmoother::sanitizeFraction (int fraction) noexcept
+{
+    return standardFractions[static_cast<size_t> (getFractionIndex (fraction))];
+}
+
+int FractionalOctaveSmoother::getFractionIndex (int fraction) noexcept
+{
+    int bestIndex = 0;
+    for (size_t i = 1; i < standardFractions.size(); ++i)
+    {
+        if (std::abs (standardFractions[i] - fraction) < std::abs (standardFractions[static_cast<size_t> (bestIndex)] - fraction))
+            bestIndex = static_cast<int> (i);
+    }
+    return bestIndex;
+}
+
+void FractionalOctaveSmoother::computeBands (const float* centreFrequenciesHz,
+                                             int numCentres,
+                                             double binWidthHz,
+                                             double bandwidthOctaves,
+                                             int numLinearBins,
+                                             Band* bands) noexcept
+{
+    const double halfWidthRatio = std::pow (2.0, 0.5 * juce::jmax (0.0, bandwidthOctaves));
+    const double safeBinWidth = juce::jmax (1.0e-6, binWidthHz);
+    const double lowestEdge = 0.5;
+    const double highestEdge = static_cast<double> (numLinearBins) - 0.5;
+
+    for (int i = 0; i < numCentres; ++i)
+    {
+        const double centre = static_cast<double> (centreFrequenciesHz[i]) / safeBinWidth;
+        double lower = centre / halfWidthRatio;
+        double upper = centre * halfWidthRatio;
+
+        if (upper - lower < 1.0)
+        {
+            lower = centre - 0.5;
+            upper = centre + 0.5;
+        }
+
+        if (lower < lowestEdge)
+        {
+            upper += lowestEdge - lower;
+            lower = lowestEdge;
+        }
+        if (upper > highestEdge)
+        {
+            lower -= upper - highestEdge;
+            upper = highestEdge;
+        }
+
+        auto& band = bands[i];
+        band.lowerBin = static_cast<float> (juce::jlimit (lowestEdge, highestEdge - 1.0, lower));
+        band.upperBin = static_cast<float> (juce::jlimit (static_cast<double> (band.lowerBin) + 1.0, highestEdge, upper));
+    }
+}
+
+void FractionalOctaveSmoother::prepare (int numLinearBins)
+{
+    numBins = juce::jmax (2, numLinearBins);
+    prefix.assign (static_cast<size_t> (numBins + 1), 0.0);
+}
+
+void FractionalOctaveSmoother::process (const float* linearPower, const Band* bands, int numBands, float* output) noexcept
+{
+    integrateBands (linearPower, bands, numBands, output, true);
+}
+
+void FractionalOctaveSmoother::processSigned (const float* linearValues, const Band* bands, int numBands, float* output) noexcept
+{
+    integrateBands (linearValues, bands, numBands, output, false);
+}
+
+void FractionalOctaveSmoother::integrateBands (const float* linearValues,
+                                               const Band* bands,
+                                               int numBands,
+                                               float* output,
+                                               bool clampToZero) noexcept
+{
+    double running = 0.0;
+    prefix[0] = 0.0;
+    for (int k = 0; k < numBins; ++k)
+    {
+        running += static_cast<double> (linearValues[k]);
+        prefix[static_cast<size_t> (k + 1)] = running;
+    }
+
+    for (int i = 0; i < numBands; ++i)
+    {
+        const auto& band = bands[i];
+        const double width = static_cast<double> (band.upperBin - band.lowerBin);
+        const double mean = (integrateTo (linearValues, band.upperBin) - integrateTo (linearValues, band.lowerBin))
+                          / juce::jmax (1.0e-9, width);
+        output[i] = static_cast<float> (clampToZero ? juce::jmax (0.0, mean) : mean);
+    }
+}
+
+double FractionalOctaveSmoother::integrateTo (const float* linearPower, float position) const noexcept
+{
+    // prefix[k] is the integral up to the lower edge of bin k, i.e. position k - 0.5.
+    const double shifted = juce::jlimit (0.0, static_cast<double> (numBins), static_cast<double> (position) + 0.5);
+    const int k = juce::jmin (numBins - 1, static_cast<int> (shifted));
+    const double frac = shifted - static_cast<double> (k);
+    return prefix[static_cast<size_t> (k)] + frac * static_cast<double> (linearPower[k]);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+// Fractional-octave power smoothing of a linear FFT spectrum, evaluated at arbitrary centre
+// frequencies. The power spectrum is integrated once per frame into a prefix sum, so every band
+// mean is two interpolated lookups and the cost per output point does not depend on the width.
+class FractionalOctaveSmoother
+{
+public:
+    static constexpr std::array<int, 6> standardFractions { 24, 12, 6, 3, 2, 1 };
+    static constexpr int defaultFraction = 24;
+
+    // Band edges in linear-bin units; bin k covers [k - 0.5, k + 0.5).
+    struct Band
+    {
+        float lowerBin = 0.5f;
+        float upperBin = 1.5f;
+    };
+
+    static int sanitizeFraction (int fraction) noexcept;
+    static int getFractionIndex (int fraction) noexcept;
+
+    // Bands narrower than one FFT bin are widened to one bin around the centre, and DC is excluded.
+    static void computeBands (const float* centreFrequenciesHz,
+                              int numCentres,
+                              double binWidthHz,
+                              double bandwidthOctaves,
+                              int numLinearBins,
+                              Band* bands) noexcept;
+
+    // Allocates the prefix buffer; call outside the audio callback.
+    void prepare (int numLinearBins);
+
+    // Realtime safe. linearPower holds the numLinearBins values passed to prepare();
+    // output receives one mean power per band.
+    void process (const float* linearPower, const Band* bands, int numBands, float* output) noexcept;
+
+    // As process(), for signed spectra such as the parts of a cross-spectrum.
+    void processSigned (const float* linearValues, const Band* bands, int numBands, float* output) noexcept;
+
+private:
+    void integrateBands (const float* linearValues, const Band* bands, int numBands, float* output, bool clampToZero) noexcept;
+    double integrateTo (const float* linearPower, float position) const noexcept;
+
+    std::vector<double> prefix;
+    int numBins = 0;
+};
@@ -0,0 +1,56 @@
+#include "GainReductionSpectrum.h"
+
+#include <cmath>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace
+{
+constexpr float kFloorDb = -96.0f;
+} // namespace
+
+void GainReductionSpectrum::reset() noexcept
+{
+    hasAverage = false;
+    for (auto& value : publishedReductionDb)
+        value.store (0.0f, std::memory_order_relaxed);
+}
+
+void GainReductionSpectrum::process (FractionalOctaveSmoother& smoother,
+                                     const float* powerBefore,
+                                     const float* powerAfter,
+                                     const FractionalOctaveSmoother::Band* bands,
+                                     float magnitudeScale) noexcept
+{
+    smoother.process (powerBefore, bands, numBands, bandBefore.data());
+    smoother.process (powerAfter, bands, numBands, bandAfter.data());
+
+    // Averaged like the trace, so the reduction moves with the spectrum it is drawn over.
+    const float coefficient = hasAverage ? SpectrumDisplaySet::Base::releaseCoefficient : 1.0f;
+    hasAverage = true;
+
+    const float floorAmplitude = juce::Decibels::decibelsToGain (kFloorDb) / juce::jmax (1.0e-20f, magnitudeScale);
+    const float floorPower = floorAmplitude * floorAmplitude;
+
+    for (int i = 0; i < numBands; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        averageBefore[idx] += (bandBefore[idx] - averageBefore[idx]) * coefficient;
+        averageAfter[idx] += (bandAfter[idx] - averageAfter[idx]) * coefficient;
+
+        float reductionDb = 0.0f;
+        if (averageBefore[idx] > floorPower)
+        {
+            const float ratio = averageBefore[idx] / juce::jmax (floorPower * 1.0e-3f, averageAfter[idx]);
+            reductionDb = juce::jlimit (0.0f, maxReductionDb, 10.0f * std::log10 (ratio));
+        }
+
+        publishedReductionDb[idx].store (reductionDb, std::memory_order_relaxed);
+    }
+}
+
+void GainReductionSpectrum::copySnapshot (Values& reductionDb) const noexcept
+{
+    for (int i = 0; i < numBands; ++i)
+        reductionDb[static_cast<size_t> (i)] = publishedReductionDb[static_cast<size_t> (i)].load (std::memory_order_relaxed);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "FractionalOctaveSmoother.h"
+#include "SpectrumDisplay.h"
+
+// What the resonance suppressor removed, per display band: the analyzer's pre- and
+// post-suppressor power spectra are smoothed onto the display bands, averaged with the trace's
+// release coefficient, and published as pre / post in dB. Bands where the input sits below the
+// display floor read as no reduction.
+class GainReductionSpectrum
+{
+public:
+    static constexpr int numBands = SpectrumDisplaySet::baseBins;
+    static constexpr float maxReductionDb = 24.0f;
+    using Values = std::array<float, numBands>;
+
+    // Audio thread. The linear arrays hold one value per FFT bin; magnitudeScale is the
+    // analyzer's FFT magnitude to full-scale factor.
+    void reset() noexcept;
+    void process (FractionalOctaveSmoother& smoother,
+                  const float* powerBefore,
+                  const float* powerAfter,
+                  const FractionalOctaveSmoother::Band* bands,
+                  float magnitudeScale) noexcept;
+
+    // Any thread.
+    void copySnapshot (Values& reductionDb) const noexcept;
+
+private:
+    Values bandBefore {};
+    Values bandAfter {};
+    Values averageBefore {};
+    Values averageAfter {};
+    bool hasAverage = false;
+
+    std::array<std::atomic<float>, numBands> publishedReductionDb {};
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+// Streaming 2:1 decimator built from a Kaiser-windowed half-band FIR. Every second tap of a
+// half-band filter is zero, so each output only needs the centre tap plus (numTaps + 1) / 4
+// symmetric pairs.
+template <int numTaps>
+class HalfBandDecimator
+{
+    static_assert (numTaps % 4 == 3, "Half-band decimators need 4k + 3 taps");
+
+public:
+    static constexpr int centre = numTaps / 2;
+    static constexpr int numPairs = (numTaps + 1) / 4;
+
+    HalfBandDecimator() noexcept
+    {
+        designCoefficients();
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        history.fill (0.0f);
+        writeIndex = 0;
+        oddInput = false;
+    }
+
+    // Returns the number of samples written to output, which is at most (numSamples + 1) / 2.
+    // Input and output may alias.
+    int process (const float* input, int numSamples, float* output) noexcept
+    {
+        int numOut = 0;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = input[i];
+            history[static_cast<size_t> (writeIndex)] = x;
+            history[static_cast<size_t> (writeIndex + numTaps)] = x;
+            writeIndex = writeIndex + 1 < numTaps ? writeIndex + 1 : 0;
+
+            oddInput = ! oddInput;
+            if (oddInput)
+                continue;
+
+            // history[writeIndex .. writeIndex + numTaps) now holds the last numTaps samples, oldest first.
+            const float* h = history.data() + writeIndex;
+            float sum = centreGain * h[centre];
+            for (int p = 0; p < numPairs; ++p)
+            {
+                const int offset = 2 * p + 1;
+                sum += pairGains[static_cast<size_t> (p)] * (h[centre - offset] + h[centre + offset]);
+            }
+
+            output[numOut++] = sum;
+        }
+
+        return numOut;
+    }
+
+    // Group delay in input samples.
+    static constexpr int getLatencySamples() noexcept { return centre; }
+
+private:
+    void designCoefficients() noexcept
+    {
+        constexpr double beta = 8.0;
+        const double denominator = besselI0 (beta);
+        double dcGain = 0.5;
+        for (int p = 0; p < numPairs; ++p)
+        {
+            const double offset = static_cast<double> (2 * p + 1);
+            const double ratio = offset / static_cast<double> (centre + 1);
+            const double windowValue = besselI0 (beta * std::sqrt (1.0 - ratio * ratio)) / denominator;
+            const double sinc = std::sin (0.5 * 3.14159265358979323846 * offset) / (3.14159265358979323846 * offset);
+            pairGains[static_cast<size_t> (p)] = static_cast<float> (sinc * windowValue);
+            dcGain += 2.0 * sinc * windowValue;
+        }
+
+        // Normalise to unity at DC so levels measured after decimation match the input.
+        centreGain = static_cast<float> (0.5 / dcGain);
+        for (auto& g : pairGains)
+            g = static_cast<float> (static_cast<double> (g) / dcGain);
+    }
+
+    static double besselI0 (double x) noexcept
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        const double halfX = 0.5 * x;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (halfX / static_cast<double> (k)) * (halfX / static_cast<double> (k));
+            sum += term;
+            if (term < sum * 1.0e-12)
+                break;
+        }
+        return sum;
+    }
+
+    std::array<float, numPairs> pairGains {};
+    float centreGain = 0.5f;
+    std::array<float, 2 * numTaps> history {};
+    int writeIndex = 0;
+    bool oddInput = false;
+};
@@ -0,0 +1,149 @@
+#include "LoudnessTimeline.h"
+
+#include <cmath>
+
+#include <juce_core/juce_core.h>
+
+namespace
+{
+float energyToLufs (double meanSquare) noexcept
+{
+    if (meanSquare <= 1.0e-12)
+        return LoudnessTimeline::floorDb;
+    return juce::jmax (LoudnessTimeline::floorDb, static_cast<float> (10.0 * std::log10 (meanSquare)) - 0.691f);
+}
+
+float amplitudeToDb (float amplitude) noexcept
+{
+    if (amplitude <= 1.0e-6f)
+        return LoudnessTimeline::floorDb;
+    return juce::jmax (LoudnessTimeline::floorDb, 20.0f * std::log10 (amplitude));
+}
+} // namespace
+
+void LoudnessTimeline::prepare (double sampleRate) noexcept
+{
+    samplesPerBasePoint = juce::jmax (1, static_cast<int> (std::lround (sampleRate * secondsPerBasePoint)));
+    reset();
+}
+
+void LoudnessTimeline::reset() noexcept
+{
+    for (auto& level : levels)
+    {
+        level.numWritten.store (0, std::memory_order_release);
+        level.momentaryEnergy = 0.0;
+        level.shortTermEnergy = 0.0;
+        level.peak = 0.0f;
+        level.numMerged = 0;
+    }
+
+    blockEnergies.fill (0.0);
+    blockEnergyIndex = 0;
+    numBlockEnergies = 0;
+    blockEnergy = 0.0;
+    blockPeak = 0.0f;
+    blockSampleCount = 0;
+}
+
+double LoudnessTimeline::getSecondsPerPoint (int level) noexcept
+{
+    double seconds = secondsPerBasePoint;
+    for (int i = 0; i < juce::jlimit (0, numLevels - 1, level); ++i)
+        seconds *= static_cast<double> (decimation);
+    return seconds;
+}
+
+void LoudnessTimeline::completeBasePoint() noexcept
+{
+    blockEnergies[static_cast<size_t> (blockEnergyIndex)] = blockEnergy / static_cast<double> (blockSampleCount);
+    blockEnergyIndex = (blockEnergyIndex + 1) % shortTermBlocks;
+    numBlockEnergies = juce::jmin (numBlockEnergies + 1, shortTermBlocks);
+
+    // Windows shorter than their nominal length at the very start average what exists.
+    double momentarySum = 0.0;
+    double shortTermSum = 0.0;
+    for (int i = 0; i < numBlockEnergies; ++i)
+    {
+        const double energy = blockEnergies[static_cast<size_t> ((blockEnergyIndex - 1 - i + shortTermBlocks) % shortTermBlocks)];
+        shortTermSum += energy;
+        if (i < momentaryBlocks)
+            momentarySum += energy;
+    }
+
+    append (0,
+            momentarySum / static_cast<double> (juce::jmin (numBlockEnergies, momentaryBlocks)),
+            shortTermSum / static_cast<double> (numBlockEnergies),
+            blockPeak);
+
+    blockEnergy = 0.0;
+    blockPeak = 0.0f;
+    blockSampleCount = 0;
+}
+
+void LoudnessTimeline::append (int levelIndex, double momentaryEnergy, double shortTermEnergy, float peak) noexcept
+{
+    auto& level = levels[static_cast<size_t> (levelIndex)];
+    const auto written = level.numWritten.load (std::memory_order_relaxed);
+    const auto slot = static_cast<size_t> (written % pointsPerLevel);
+    level.momentaryLufs[slot].store (energyToLufs (momentaryEnergy), std::memory_order_relaxed);
+    level.shortTermLufs[slot].store (energyToLufs (shortTermEnergy), std::memory_order_relaxed);
+    level.peakDb[slot].store (amplitudeToDb (peak), std::memory_order_relaxed);
+    level.numWritten.store (written + 1, std::memory_order_release);
+
+    if (levelIndex + 1 >= numLevels)
+        return;
+
+    level.momentaryEnergy += momentaryEnergy;
+    level.shortTermEnergy += shortTermEnergy;
+    level.peak = juce::jmax (level.peak, peak);
+    if (++level.numMerged < decimation)
+        return;
+
+    const double scale = 1.0 / static_cast<double> (decimation);
+    const double mergedMomentary = level.momentaryEnergy * scale;
+    const double mergedShortTerm = level.shortTermEnergy * scale;
+    const float mergedPeak = level.peak;
+    level.momentaryEnergy = 0.0;
+    level.shortTermEnergy = 0.0;
+    level.peak = 0.0f;
+    level.numMerged = 0;
+    append (levelIndex + 1, mergedMomentary, mergedShortTerm, mergedPeak);
+}
+
+int LoudnessTimeline::read (int levelIndex, std::vector<Point>& out) const
+{
+    const auto& level = levels[static_cast<size_t> (juce::jlimit (0, numLevels - 1, levelIndex))];
+    const auto end = level.numWritten.load (std::memory_order_acquire);
+    const auto begin = end > static_cast<std::uint64_t> (pointsPerLevel) ? end - pointsPerLevel : 0;
+
+    out.resize (static_cast<size_t> (end - begin));
+    for (auto index = begin; index < end; ++index)
+    {
+        const auto slot = static_cast<size_t> (index % pointsPerLevel);
+        auto& point = out[static_cast<size_t> (index - begin)];
+        point.momentaryLufs = level.momentaryLufs[slot].load (std::memory_order_relaxed);
+        point.shortTermLufs = level.shortTermLufs[slot].load (std::memory_order_relaxed);
+        point.peakDb = level.peakDb[slot].load (std::memory_order_relaxed);
+    }
+
+    // Points the writer lapped during the copy may be torn; drop them. A reset in the
+    // meantime invalidates the whole copy.
+    std::atomic_thread_fence (std::memory_order_acquire);
+    const auto after = level.numWritten.load (std::memory_order_relaxed);
+    if (after < end)
+    {
+        out.clear();
+        return 0;
+    }
+
+    // The writer fills slot (after % pointsPerLevel) before publishing it.
+    const auto overwritten = after + 1 > static_cast<std::uint64_t> (pointsPerLevel) ? after + 1 - pointsPerLevel : 0;
+    if (overwritten > begin)
+    {
+        const auto numStale = static_cast<std::ptrdiff_t> (juce::jmin (overwritten, end) - begin);
+        out.erase (out.begin(), out.begin() + numStale);
+    }
+
+    return static_cast<int> (out.size());
+}
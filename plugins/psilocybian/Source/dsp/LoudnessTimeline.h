@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Loudness history for whole-song overviews. Every 100 ms the audio thread appends the
+// momentary (400 ms) and short-term (3 s) loudness of the K-weighted signal and the sample
+// peak. Level 0 keeps the last minute at full resolution; each further level merges four
+// points of the level below (energy mean for loudness, max for peak), so six levels cover
+// about 17 hours in fixed memory. An append touches one extra level every fourth call, and
+// every level can be read lock-free in one pass.
+class LoudnessTimeline
+{
+public:
+    static constexpr int numLevels = 6;
+    static constexpr int pointsPerLevel = 600;
+    static constexpr int decimation = 4;
+    static constexpr double secondsPerBasePoint = 0.1;
+    static constexpr float floorDb = -120.0f;
+
+    struct Point
+    {
+        float momentaryLufs = floorDb;
+        float shortTermLufs = floorDb;
+        float peakDb = floorDb;
+    };
+
+    // Message thread, audio stopped.
+    void prepare (double sampleRate) noexcept;
+
+    // Audio thread.
+    void reset() noexcept;
+    void addSample (float weightedSample, float peak) noexcept
+    {
+        blockEnergy += static_cast<double> (weightedSample * weightedSample);
+        blockPeak = peak > blockPeak ? peak : blockPeak;
+        if (++blockSampleCount >= samplesPerBasePoint)
+            completeBasePoint();
+    }
+
+    // Any thread. Copies the level's history oldest first and returns the number of points.
+    static double getSecondsPerPoint (int level) noexcept;
+    int read (int level, std::vector<Point>& out) const;
+
+private:
+    static constexpr int momentaryBlocks = 4;
+    static constexpr int shortTermBlocks = 30;
+
+    struct Level
+    {
+        std::array<std::atomic<float>, pointsPerLevel> momentaryLufs {};
+        std::array<std::atomic<float>, pointsPerLevel> shortTermLufs {};
+        std::array<std::atomic<float>, pointsPerLevel> peakDb {};
+        std::atomic<std::uint64_t> numWritten { 0 };
+
+        // Audio thread: the points merged so far into this level's next point.
+        double momentaryEnergy = 0.0;
+        double shortTermEnergy = 0.0;
+        float peak = 0.0f;
+        int numMerged = 0;
+    };
+
+    void completeBasePoint() noexcept;
+    void append (int level, double momentaryEnergy, double shortTermEnergy, float peak) noexcept;
+
+    std::array<Level, numLevels> levels;
+    std::array<double, shortTermBlocks> blockEnergies {};
+    int blockEnergyIndex = 0;
+    int numBlockEnergies = 0;
+    double blockEnergy = 0.0;
+    float blockPeak = 0.0f;
+    int blockSampleCount = 0;
+    int samplesPerBasePoint = 4410;
+};
@@ -0,0 +1,162 @@
+#include "MarkerProbes.h"
+
+#include <cmath>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+MarkerProbes::MarkerProbes()
+{
+    float* aligned = Register::getNextSIMDAlignedPtr (storage.data());
+    for (int t = 0; t < numTables; ++t)
+        tables[t] = aligned + t * maxProbes;
+
+    prepare (48000.0);
+}
+
+void MarkerProbes::prepare (double newSampleRate)
+{
+    sampleRate = juce::jmax (1000.0, newSampleRate);
+    historyIntervalSamples = juce::jmax (1, static_cast<int> (std::lround (historyIntervalSeconds * sampleRate)));
+    for (int i = 0; i < maxProbes; ++i)
+        design (i);
+    reset();
+}
+
+void MarkerProbes::reset() noexcept
+{
+    for (int i = 0; i < maxProbes; ++i)
+        clearState (i);
+    samplesUntilPoint = historyIntervalSamples;
+}
+
+void MarkerProbes::setProbe (int index, const Probe& probe) noexcept
+{
+    if (index < 0 || index >= maxProbes)
+        return;
+
+    probes[static_cast<size_t> (index)] = probe;
+    design (index);
+    clearState (index);
+}
+
+void MarkerProbes::clearState (int index) noexcept
+{
+    tables[firstReal][index] = 0.0f;
+    tables[firstImag][index] = 0.0f;
+    tables[secondReal][index] = 0.0f;
+    tables[secondImag][index] = 0.0f;
+}
+
+void MarkerProbes::design (int index) noexcept
+{
+    auto& probe = probes[static_cast<size_t> (index)];
+    const double nyquist = 0.5 * sampleRate;
+    const bool usable = probe.enabled && probe.frequencyHz > 0.0f && static_cast<double> (probe.frequencyHz) < nyquist;
+
+    // Unused slots keep a zero gain and read as the floor.
+    double radius = 0.0;
+    double w = 0.0;
+    if (usable)
+    {
+        // Two equal poles are 3 dB down where each alone is 1.5 dB down, at sqrt (sqrt 2 - 1)
+        // of a single pole's half bandwidth.
+        const double bandwidth = static_cast<double> (juce::jlimit (minBandwidthHz, maxBandwidthHz, probe.bandwidthHz));
+        const double poleBandwidth = bandwidth / std::sqrt (std::sqrt (2.0) - 1.0);
+        radius = juce::jlimit (0.0, 0.999999, 1.0 - juce::MathConstants<double>::pi * poleBandwidth / sampleRate);
+        w = juce::MathConstants<double>::twoPi * static_cast<double> (probe.frequencyHz) / sampleRate;
+    }
+
+    tables[poleReal][index] = static_cast<float> (radius * std::cos (w));
+    tables[poleImag][index] = static_cast<float> (radius * std::sin (w));
+    tables[gain][index] = usable ? static_cast<float> (2.0 * (1.0 - radius) * (1.0 - radius)) : 0.0f;
+
+    // Only the lane groups up to the highest probe in use run.
+    numActive = 0;
+    for (int i = 0; i < maxProbes; ++i)
+        if (tables[gain][i] > 0.0f)
+            numActive = i + 1;
+}
+
+void MarkerProbes::process (const float* input, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        const int segment = juce::jmin (numSamples, samplesUntilPoint);
+        run (input, segment);
+        input += segment;
+        numSamples -= segment;
+
+        samplesUntilPoint -= segment;
+        if (samplesUntilPoint == 0)
+        {
+            publishPoint();
+            samplesUntilPoint = historyIntervalSamples;
+        }
+    }
+}
+
+void MarkerProbes::run (const float* input, int numSamples) noexcept
+{
+    const auto lanes = static_cast<int> (Register::size());
+    for (int first = 0; first < numActive; first += lanes)
+    {
+        auto ur = Register::fromRawArray (tables[firstReal] + first);
+        auto ui = Register::fromRawArray (tables[firstImag] + first);
+        auto vr = Register::fromRawArray (tables[secondReal] + first);
+        auto vi = Register::fromRawArray (tables[secondImag] + first);
+        const auto pr = Register::fromRawArray (tables[poleReal] + first);
+        const auto pi = Register::fromRawArray (tables[poleImag] + first);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto nextUr = (pr * ur) - (pi * ui) + Register::expand (input[i]);
+            ui = (pr * ui) + (pi * ur);
+            ur = nextUr;
+
+            const auto nextVr = (pr * vr) - (pi * vi) + ur;
+            vi = (pr * vi) + (pi * vr) + ui;
+            vr = nextVr;
+        }
+
+        ur.copyToRawArray (tables[firstReal] + first);
+        ui.copyToRawArray (tables[firstImag] + first);
+        vr.copyToRawArray (tables[secondReal] + first);
+        vi.copyToRawArray (tables[secondImag] + first);
+    }
+}
+
+void MarkerProbes::publishPoint() noexcept
+{
+    const auto index = numPublished.load (std::memory_order_relaxed);
+    const auto offset = static_cast<size_t> (index % static_cast<std::uint64_t> (historyLength)) * static_cast<size_t> (maxProbes);
+
+    for (int i = 0; i < maxProbes; ++i)
+    {
+        const float re = tables[secondReal][i];
+        const float im = tables[secondImag][i];
+        const float level = tables[gain][i] * std::sqrt (re * re + im * im);
+        published[offset + static_cast<size_t> (i)].store (juce::Decibels::gainToDecibels (level, floorDb),
+                                                           std::memory_order_relaxed);
+    }
+
+    numPublished.store (index + 1, std::memory_order_release);
+}
+
+int MarkerProbes::read (std::uint64_t& nextPoint, std::vector<float>& out) const
+{
+    const auto total = numPublished.load (std::memory_order_acquire);
+    const auto oldest = total > static_cast<std::uint64_t> (historyLength) ? total - static_cast<std::uint64_t> (historyLength) : 0;
+    const auto first = juce::jlimit (oldest, total, nextPoint);
+    const int count = static_cast<int> (total - first);
+
+    out.resize (static_cast<size_t> (count) * static_cast<size_t> (maxProbes));
+    for (int c = 0; c < count; ++c)
+    {
+        const auto offset = static_cast<size_t> ((first + static_cast<std::uint64_t> (c)) % static_cast<std::uint64_t> (historyLength)) * static_cast<size_t> (maxProbes);
+        for (int i = 0; i < maxProbes; ++i)
+            out[static_cast<size_t> (c * maxProbes + i)] = published[offset + static_cast<size_t> (i)].load (std::memory_order_relaxed);
+    }
+
+    nextPoint = total;
+    return count;
+}
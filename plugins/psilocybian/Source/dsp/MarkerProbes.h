@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+// Level trackers at a handful of exact frequencies. Each probe is a sliding Goertzel with a
+// two-pole exponential window, i.e. two cascaded complex resonators
+//   u[n] = p u[n-1] + x[n],   v[n] = p v[n-1] + u[n],   p = r e^jw,   level = 2 (1 - r)^2 |v|
+// which reads a sine at w as its amplitude. The cascade falls off twice as fast as a single
+// resonator, enough to split 50 from 60 Hz hum at a few hertz of bandwidth. Every probe updates
+// every sample, so levels follow within milliseconds instead of at the FFT frame rate, and the
+// probes run side by side on juce::dsp::SIMDRegister lanes: the cost scales with the number of
+// probes placed, not with any FFT size. Levels are sampled into a history every
+// historyIntervalSeconds.
+class MarkerProbes
+{
+public:
+    static constexpr int maxProbes = 8;
+    static constexpr int historyLength = 512;
+    static constexpr double historyIntervalSeconds = 0.005;
+    static constexpr float floorDb = -96.0f;
+    static constexpr float minBandwidthHz = 0.5f;
+    static constexpr float maxBandwidthHz = 200.0f;
+
+    struct Probe
+    {
+        bool enabled = false;
+        float frequencyHz = 1000.0f;
+        float bandwidthHz = 5.0f;
+    };
+
+    MarkerProbes();
+
+    // Message thread, audio stopped. Keeps the probes, redesigned for the new rate.
+    void prepare (double sampleRate);
+
+    // Audio thread.
+    void reset() noexcept;
+    void setProbe (int index, const Probe& probe) noexcept;
+    const Probe& getProbe (int index) const noexcept { return probes[static_cast<size_t> (index)]; }
+    void process (const float* input, int numSamples) noexcept;
+
+    // Any thread. Copies the history points published since nextPoint, oldest first with
+    // maxProbes levels in dBFS each (floorDb for unused slots), advances nextPoint and returns
+    // the number of points copied. Points that were already overwritten are skipped.
+    int read (std::uint64_t& nextPoint, std::vector<float>& out) const;
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    enum Table
+    {
+        firstReal,
+        firstImag,
+        secondReal,
+        secondImag,
+        poleReal,
+        poleImag,
+        gain,
+        numTables
+    };
+
+    void design (int index) noexcept;
+    void clearState (int index) noexcept;
+    void run (const float* input, int numSamples) noexcept;
+    void publishPoint() noexcept;
+
+    double sampleRate = 48000.0;
+    std::array<Probe, maxProbes> probes {};
+    int numActive = 0;
+    int historyIntervalSamples = 240;
+    int samplesUntilPoint = 240;
+
+    std::array<float, numTables * maxProbes + 16> storage {};
+    float* tables[numTables] {};
+
+    std::array<std::atomic<float>, historyLength * maxProbes> published {};
+    std::atomic<std::uint64_t> numPublished { 0 };
+};
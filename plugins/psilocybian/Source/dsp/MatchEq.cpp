@@ -0,0 +1,257 @@
+#include "MatchEq.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr int kLinearDesignOrder = 13;
+// The minimum-phase cepstrum is computed on a 4x longer grid to keep time aliasing of the
+// folded cepstrum negligible.
+constexpr int kMinimumDesignOrder = kLinearDesignOrder + 2;
+constexpr double kPollIntervalMs = 50.0;
+// The level match is taken over the range where both curves are trustworthy, so the EQ
+// corrects tonal balance without changing overall loudness.
+constexpr float kLevelMatchLowHz = 40.0f;
+constexpr float kLevelMatchHighHz = 12000.0f;
+constexpr float kMinimumPhaseTailFraction = 0.125f;
+
+static_assert ((1 << kLinearDesignOrder) == MatchEq::numTaps);
+static_assert (MatchEq::numTaps % MatchEq::partitionSize == 0);
+} // namespace
+
+MatchEq::MatchEq()
+    : juce::Thread ("SPECRAUM match EQ"),
+      linearDesignFft (kLinearDesignOrder),
+      minimumDesignFft (kMinimumDesignOrder),
+      designSpectrum (static_cast<size_t> (1 << kMinimumDesignOrder)),
+      designTime (static_cast<size_t> (1 << kMinimumDesignOrder)),
+      impulse (static_cast<size_t> (numTaps), 0.0f)
+{
+}
+
+MatchEq::~MatchEq()
+{
+    stop();
+}
+
+void MatchEq::prepare (double sampleRate, const float* curveFrequenciesHz, int newNumCurvePoints)
+{
+    stop();
+
+    currentSampleRate = sampleRate;
+    numCurvePoints = juce::jlimit (0, maxCurvePoints, newNumCurvePoints);
+    std::copy (curveFrequenciesHz, curveFrequenciesHz + numCurvePoints, curveFrequencyHz.begin());
+    for (auto& value : differenceDb)
+        value.store (0.0f, std::memory_order_relaxed);
+    differenceRevision.store (0, std::memory_order_relaxed);
+
+    convolver.prepare (partitionSize, numTaps / partitionSize);
+
+    const int delay = getFilterDelaySamples (getPhase());
+    std::fill (impulse.begin(), impulse.end(), 0.0f);
+    impulse[static_cast<size_t> (delay)] = 1.0f;
+    convolver.setFilter (convolver.createFilter (impulse.data(), delay + 1, delay));
+}
+
+void MatchEq::start()
+{
+    if (! isThreadRunning())
+        startThread (juce::Thread::Priority::low);
+}
+
+void MatchEq::stop()
+{
+    stopThread (1000);
+}
+
+void MatchEq::setPhase (Phase newPhase) noexcept
+{
+    phase.store (static_cast<int> (newPhase), std::memory_order_relaxed);
+}
+
+MatchEq::Phase MatchEq::getPhase() const noexcept
+{
+    return phase.load (std::memory_order_relaxed) == static_cast<int> (Phase::minimum) ? Phase::minimum : Phase::linear;
+}
+
+void MatchEq::setAmount (float newAmount) noexcept
+{
+    amount.store (juce::jlimit (0.0f, 1.0f, newAmount), std::memory_order_relaxed);
+}
+
+float MatchEq::getAmount() const noexcept
+{
+    return amount.load (std::memory_order_relaxed);
+}
+
+int MatchEq::getLatencySamples (Phase phase) noexcept
+{
+    return partitionSize + getFilterDelaySamples (phase);
+}
+
+int MatchEq::getFilterDelaySamples (Phase phase) noexcept
+{
+    return phase == Phase::linear ? numTaps / 2 : 0;
+}
+
+void MatchEq::submitDifference (const float* newDifferenceDb) noexcept
+{
+    for (int i = 0; i < numCurvePoints; ++i)
+        differenceDb[static_cast<size_t> (i)].store (newDifferenceDb[i], std::memory_order_relaxed);
+    differenceRevision.fetch_add (1, std::memory_order_release);
+}
+
+void MatchEq::reset() noexcept
+{
+    convolver.reset();
+}
+
+void MatchEq::process (juce::AudioBuffer<float>& buffer) noexcept
+{
+    convolver.process (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), buffer.getNumSamples());
+}
+
+void MatchEq::run()
+{
+    std::unique_ptr<PartitionedConvolver::Filter> unsentFilter;
+    std::vector<float> correctionDb;
+    std::uint32_t designedRevision = 0;
+    Phase designedPhase = getPhase();
+    float designedAmount = amount.load (std::memory_order_relaxed);
+    // The phase may have changed while the designer was stopped, so it always designs once;
+    // before the first difference arrives that is a pass-through with the phase's delay.
+    bool hasDesigned = false;
+
+    while (! threadShouldExit())
+    {
+        if (unsentFilter == nullptr)
+        {
+            const auto revision = differenceRevision.load (std::memory_order_acquire);
+            const auto designPhase = getPhase();
+            const float designAmount = amount.load (std::memory_order_relaxed);
+
+            if (! hasDesigned || revision != designedRevision || designPhase != designedPhase || designAmount != designedAmount)
+            {
+                hasDesigned = true;
+                designedRevision = revision;
+                designedPhase = designPhase;
+                designedAmount = designAmount;
+
+                buildCorrectionCurve (correctionDb);
+                designImpulse (designPhase, correctionDb);
+                unsentFilter = convolver.createFilter (impulse.data(), numTaps, getFilterDelaySamples (designPhase));
+            }
+        }
+
+        // Also frees the filter the audio thread retired after its last crossfade.
+        convolver.offerFilter (unsentFilter);
+        wait (kPollIntervalMs);
+    }
+}
+
+void MatchEq::buildCorrectionCurve (std::vector<float>& correctionDb) const
+{
+    correctionDb.resize (static_cast<size_t> (numCurvePoints));
+
+    double levelSum = 0.0;
+    int levelCount = 0;
+    for (int i = 0; i < numCurvePoints; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        correctionDb[idx] = differenceDb[idx].load (std::memory_order_relaxed);
+        if (curveFrequencyHz[idx] >= kLevelMatchLowHz && curveFrequencyHz[idx] <= kLevelMatchHighHz)
+        {
+            levelSum += static_cast<double> (correctionDb[idx]);
+            ++levelCount;
+        }
+    }
+
+    const float levelOffset = levelCount > 0 ? static_cast<float> (levelSum / levelCount) : 0.0f;
+    const float scale = amount.load (std::memory_order_relaxed);
+    for (auto& value : correctionDb)
+        value = scale * juce::jlimit (-maxCorrectionDb, maxCorrectionDb, value - levelOffset);
+}
+
+float MatchEq::interpolateCorrectionDb (const std::vector<float>& correctionDb, double frequencyHz, int& searchIndex) const noexcept
+{
+    if (numCurvePoints == 0)
+        return 0.0f;
+
+    const auto first = static_cast<double> (curveFrequencyHz[0]);
+    const auto last = static_cast<double> (curveFrequencyHz[static_cast<size_t> (numCurvePoints - 1)]);
+    if (numCurvePoints == 1 || frequencyHz <= first)
+        return correctionDb.front();
+    if (frequencyHz >= last)
+        return correctionDb.back();
+
+    // Callers walk upwards in frequency, so the search only ever moves forward.
+    while (searchIndex < numCurvePoints - 2 && static_cast<double> (curveFrequencyHz[static_cast<size_t> (searchIndex + 1)]) < frequencyHz)
+        ++searchIndex;
+
+    const auto lower = static_cast<size_t> (searchIndex);
+    const double f0 = static_cast<double> (curveFrequencyHz[lower]);
+    const double f1 = static_cast<double> (curveFrequencyHz[lower + 1]);
+    const double t = juce::jlimit (0.0, 1.0, std::log (frequencyHz / f0) / std::log (juce::jmax (f0 * 1.000001, f1) / f0));
+    return static_cast<float> (correctionDb[lower] + t * (correctionDb[lower + 1] - correctionDb[lower]));
+}
+
+void MatchEq::designImpulse (Phase designPhase, const std::vector<float>& correctionDb)
+{
+    const bool linear = designPhase == Phase::linear;
+    const int size = linear ? linearDesignFft.getSize() : minimumDesignFft.getSize();
+    const int half = size / 2;
+    auto* spectrum = designSpectrum.data();
+    auto* time = designTime.data();
+
+    // Zero-phase target on the design grid: the linear gain for linear phase, the natural log
+    // of the gain for the minimum-phase cepstrum.
+    const double dbToNeper = std::log (10.0) / 20.0;
+    int searchIndex = 0;
+    for (int k = 0; k <= half; ++k)
+    {
+        const double frequencyHz = static_cast<double> (k) * currentSampleRate / static_cast<double> (size);
+        const double correction = static_cast<double> (interpolateCorrectionDb (correctionDb, frequencyHz, searchIndex));
+        const auto value = static_cast<float> (linear ? std::exp (correction * dbToNeper) : correction * dbToNeper);
+        spectrum[k] = Complex (value, 0.0f);
+        if (k > 0 && k < half)
+            spectrum[size - k] = spectrum[k];
+    }
+
+    if (linear)
+    {
+        // Centre the symmetric response at numTaps / 2 and taper it with a Blackman window.
+        linearDesignFft.perform (spectrum, time, true);
+        const double twoPiOverN = juce::MathConstants<double>::twoPi / static_cast<double> (numTaps);
+        for (int n = 0; n < numTaps; ++n)
+        {
+            const double w = 0.42 - 0.5 * std::cos (twoPiOverN * n) + 0.08 * std::cos (2.0 * twoPiOverN * n);
+            impulse[static_cast<size_t> (n)] = static_cast<float> (w) * time[(n + half) % size].real();
+        }
+        return;
+    }
+
+    // Homomorphic minimum phase: fold the real cepstrum onto positive quefrencies, then
+    // exponentiate its spectrum.
+    minimumDesignFft.perform (spectrum, time, true);
+    spectrum[0] = Complex (time[0].real(), 0.0f);
+    for (int n = 1; n < half; ++n)
+        spectrum[n] = Complex (2.0f * time[n].real(), 0.0f);
+    spectrum[half] = Complex (time[half].real(), 0.0f);
+    std::fill (spectrum + half + 1, spectrum + size, Complex());
+
+    minimumDesignFft.perform (spectrum, time, false);
+    for (int k = 0; k < size; ++k)
+        time[k] = std::exp (time[k]);
+    minimumDesignFft.perform (time, spectrum, true);
+
+    const int tailLength = static_cast<int> (kMinimumPhaseTailFraction * static_cast<float> (numTaps));
+    const int tailStart = numTaps - tailLength;
+    for (int n = 0; n < numTaps; ++n)
+    {
+        float w = 1.0f;
+        if (n >= tailStart)
+            w = 0.5f * (1.0f + std::cos (juce::MathConstants<float>::pi * static_cast<float> (n - tailStart) / static_cast<float> (tailLength)));
+        impulse[static_cast<size_t> (n)] = w * spectrum[n].real();
+    }
+}
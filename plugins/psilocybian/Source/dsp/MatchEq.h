@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "PartitionedConvolver.h"
+
+// Match EQ: the audio thread publishes a smoothed correction curve (reference minus live
+// long-term spectrum, in dB at arbitrary log-spaced frequencies); a background thread turns
+// it into a linear- or minimum-phase FIR and hands it to a partitioned convolver, which
+// crossfades every update in.
+class MatchEq : private juce::Thread
+{
+public:
+    enum class Phase
+    {
+        linear = 0,
+        minimum
+    };
+
+    static constexpr int numTaps = 8192;
+    static constexpr int partitionSize = 256;
+    static constexpr int maxCurvePoints = 256;
+    static constexpr float maxCorrectionDb = 12.0f;
+
+    MatchEq();
+    ~MatchEq() override;
+
+    // Message thread. Stops the designer while the convolver is reallocated and installs a
+    // pass-through filter with the current phase's delay; curveFrequenciesHz are the points
+    // submitDifference() values refer to, in ascending order.
+    void prepare (double sampleRate, const float* curveFrequenciesHz, int numCurvePoints);
+    // Message thread. The designer only needs to run while the EQ is in use.
+    void start();
+    void stop();
+
+    // Any thread.
+    void setPhase (Phase newPhase) noexcept;
+    Phase getPhase() const noexcept;
+    void setAmount (float newAmount) noexcept;
+    float getAmount() const noexcept;
+    static int getLatencySamples (Phase phase) noexcept;
+
+    // Audio thread.
+    void submitDifference (const float* differenceDb) noexcept;
+    void reset() noexcept;
+    void process (juce::AudioBuffer<float>& buffer) noexcept;
+
+private:
+    using Complex = std::complex<float>;
+
+    static int getFilterDelaySamples (Phase phase) noexcept;
+
+    void run() override;
+    void buildCorrectionCurve (std::vector<float>& correctionDb) const;
+    void designImpulse (Phase designPhase, const std::vector<float>& correctionDb);
+    float interpolateCorrectionDb (const std::vector<float>& correctionDb, double frequencyHz, int& searchIndex) const noexcept;
+
+    PartitionedConvolver convolver;
+    juce::dsp::FFT linearDesignFft;
+    juce::dsp::FFT minimumDesignFft;
+    std::vector<Complex> designSpectrum;
+    std::vector<Complex> designTime;
+    std::vector<float> impulse;
+
+    std::array<std::atomic<float>, maxCurvePoints> differenceDb {};
+    std::array<float, maxCurvePoints> curveFrequencyHz {};
+    int numCurvePoints = 0;
+    double currentSampleRate = 44100.0;
+
+    std::atomic<std::uint32_t> differenceRevision { 0 };
+    std::atomic<int> phase { static_cast<int> (Phase::linear) };
+    std::atomic<float> amount { 1.0f };
+};
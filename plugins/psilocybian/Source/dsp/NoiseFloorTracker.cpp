@@ -0,0 +1,75 @@
+#include "NoiseFloorTracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <juce_core/juce_core.h>
+
+namespace
+{
+constexpr float kUnset = std::numeric_limits<float>::max();
+} // namespace
+
+void NoiseFloorTracker::prepare (int newNumBins, double frameRate)
+{
+    numBins = juce::jmax (1, newNumBins);
+    const double rate = juce::jmax (1.0, frameRate);
+    subWindowFrames = juce::jmax (1, static_cast<int> (std::lround (subWindowSeconds * rate)));
+    smoothingCoefficient = static_cast<float> (std::exp (-1.0 / (smoothingSeconds * rate)));
+
+    const auto size = static_cast<size_t> (numBins);
+    smoothed.assign (size, 0.0f);
+    currentMinimum.assign (size, kUnset);
+    storedMinimum.assign (size, kUnset);
+    subWindowMinima.assign (size * static_cast<size_t> (numSubWindows), kUnset);
+    floor.assign (size, 0.0f);
+    reset();
+}
+
+void NoiseFloorTracker::reset() noexcept
+{
+    std::fill (smoothed.begin(), smoothed.end(), 0.0f);
+    std::fill (currentMinimum.begin(), currentMinimum.end(), kUnset);
+    std::fill (storedMinimum.begin(), storedMinimum.end(), kUnset);
+    std::fill (subWindowMinima.begin(), subWindowMinima.end(), kUnset);
+    std::fill (floor.begin(), floor.end(), 0.0f);
+    framesInSubWindow = 0;
+    subWindowIndex = 0;
+    numCompleted = 0;
+    hasSmoothed = false;
+}
+
+void NoiseFloorTracker::process (const float* power) noexcept
+{
+    // The first frame seeds the smoothing instead of rising from zero.
+    const float coefficient = hasSmoothed ? smoothingCoefficient : 0.0f;
+    hasSmoothed = true;
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const auto idx = static_cast<size_t> (k);
+        smoothed[idx] = coefficient * smoothed[idx] + (1.0f - coefficient) * power[k];
+        currentMinimum[idx] = juce::jmin (currentMinimum[idx], smoothed[idx]);
+        floor[idx] = juce::jmin (storedMinimum[idx], currentMinimum[idx]);
+    }
+
+    if (++framesInSubWindow < subWindowFrames)
+        return;
+
+    // The completed sub-window replaces the oldest one.
+    framesInSubWindow = 0;
+    float* row = subWindowMinima.data() + static_cast<size_t> (subWindowIndex) * static_cast<size_t> (numBins);
+    std::copy (currentMinimum.begin(), currentMinimum.end(), row);
+    std::fill (currentMinimum.begin(), currentMinimum.end(), kUnset);
+    subWindowIndex = (subWindowIndex + 1) % numSubWindows;
+    numCompleted = juce::jmin (numCompleted + 1, numSubWindows);
+
+    std::copy (subWindowMinima.begin(), subWindowMinima.begin() + numBins, storedMinimum.begin());
+    for (int w = 1; w < numSubWindows; ++w)
+    {
+        const float* minima = subWindowMinima.data() + static_cast<size_t> (w) * static_cast<size_t> (numBins);
+        for (int k = 0; k < numBins; ++k)
+            storedMinimum[static_cast<size_t> (k)] = juce::jmin (storedMinimum[static_cast<size_t> (k)], minima[k]);
+    }
+}
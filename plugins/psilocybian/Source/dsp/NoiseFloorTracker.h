@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+// Per-bin noise floor by minimum statistics: each bin's power is smoothed over a few frames
+// and the floor is the minimum of that over the last numSubWindows sub-windows of
+// subWindowSeconds each. Only sub-window minima are stored, so a frame costs one compare
+// per bin, plus a pass over numSubWindows minima per bin whenever a sub-window completes.
+// Peaks shorter than the window never reach the floor, so it follows the steady background
+// of the programme and adapts as that changes. No bias compensation is applied: its users
+// only care about the shape, not the absolute level.
+class NoiseFloorTracker
+{
+public:
+    static constexpr int numSubWindows = 8;
+    static constexpr double subWindowSeconds = 0.4;
+    static constexpr double smoothingSeconds = 0.1;
+
+    // Message thread, audio stopped. frameRate is the number of process() calls per second.
+    void prepare (int numBins, double frameRate);
+
+    // Audio thread.
+    void reset() noexcept;
+    void process (const float* power) noexcept;
+    // True once the first sub-window has completed.
+    bool isReady() const noexcept { return numCompleted > 0; }
+    const float* getFloor() const noexcept { return floor.data(); }
+
+private:
+    int numBins = 0;
+    int subWindowFrames = 1;
+    int framesInSubWindow = 0;
+    int subWindowIndex = 0;
+    int numCompleted = 0;
+    float smoothingCoefficient = 0.5f;
+    bool hasSmoothed = false;
+
+    std::vector<float> smoothed;
+    std::vector<float> currentMinimum;
+    // Minimum over the completed sub-windows in subWindowMinima.
+    std::vector<float> storedMinimum;
+    // numSubWindows rows of numBins.
+    std::vector<float> subWindowMinima;
+    std::vector<float> floor;
+};
@@ -0,0 +1,294 @@
+#include "OscilloscopeCapture.h"
+
+#include <cmath>
+
+#include <juce_core/juce_core.h>
+
+namespace
+{
+constexpr float kTriggerHysteresis = 1.0e-4f;
+constexpr double kAutoTriggerSeconds = 0.25;
+constexpr double kHostJumpToleranceFraction = 0.02;
+constexpr int kMinCyclePoints = 16;
+} // namespace
+
+void OscilloscopeCapture::prepare (double newSampleRate) noexcept
+{
+    sampleRate = juce::jmax (1000.0, newSampleRate);
+    reset();
+}
+
+void OscilloscopeCapture::reset() noexcept
+{
+    publishedCount.fetch_add (1, std::memory_order_acq_rel);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    for (auto& slot : slots)
+    {
+        for (auto& v : slot.left)
+            v.store (0.0f, std::memory_order_relaxed);
+        for (auto& v : slot.right)
+            v.store (0.0f, std::memory_order_relaxed);
+        slot.points.store (cyclePoints, std::memory_order_relaxed);
+    }
+
+    publishedCount.fetch_add (1, std::memory_order_acq_rel);
+    writeSlot = &slots[static_cast<size_t> ((publishedCount.load (std::memory_order_relaxed) + 1u) & 1u)];
+
+    restartCycle (0.0);
+    capturing = false;
+    triggerArmed = false;
+    previousTriggerSample = 0.0f;
+    samplesWaitingForTrigger = 0;
+}
+
+void OscilloscopeCapture::setMode (Mode newMode) noexcept
+{
+    if (newMode == mode)
+        return;
+
+    mode = newMode;
+    reset();
+}
+
+void OscilloscopeCapture::setResolution (int points) noexcept
+{
+    const int clamped = juce::jlimit (minResolution, maxResolution, points);
+    if (clamped == resolution)
+        return;
+
+    resolution = clamped;
+    reset();
+}
+
+void OscilloscopeCapture::setTriggerLevel (float level) noexcept
+{
+    triggerLevel = juce::jlimit (-1.0f, 1.0f, level);
+}
+
+void OscilloscopeCapture::setWindowSeconds (double seconds) noexcept
+{
+    windowSeconds = juce::jlimit (0.001, 1.0, seconds);
+}
+
+void OscilloscopeCapture::process (const float* left, const float* right, int numSamples, const TempoSync& sync) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    if (isTempoSynced (mode))
+        processTempoSynced (left, right, numSamples, sync);
+    else
+        processTriggered (left, right, numSamples);
+}
+
+void OscilloscopeCapture::processTempoSynced (const float* left, const float* right, int numSamples, const TempoSync& sync) noexcept
+{
+    // Rounded down to a power of two so a tempo ramp does not restart the cycle every block.
+    const double samplesPerCycle = juce::jmax (static_cast<double> (kMinCyclePoints), sync.samplesPerCycle);
+    setCyclePoints (samplesPerCycle >= static_cast<double> (resolution)
+                        ? resolution
+                        : 1 << static_cast<int> (std::floor (std::log2 (samplesPerCycle))));
+
+    const double resolutionPoints = static_cast<double> (cyclePoints);
+    const double pointsPerSample = resolutionPoints / samplesPerCycle;
+
+    if (sync.hasHostPosition)
+    {
+        const double hostPosition = juce::jlimit (0.0, resolutionPoints - 1.0e-6, sync.hostSamplesIntoCycle * pointsPerSample);
+        double drift = hostPosition - pointPosition;
+        if (drift < -0.5 * resolutionPoints)
+            drift += resolutionPoints;
+        else if (drift > 0.5 * resolutionPoints)
+            drift -= resolutionPoints;
+
+        const double jumpTolerance = juce::jmax (2.0, resolutionPoints * kHostJumpToleranceFraction);
+        if (std::abs (drift) <= jumpTolerance)
+        {
+            pointPosition += drift;
+        }
+        else
+        {
+            const int hostPoint = juce::jmin (cyclePoints - 1, static_cast<int> (std::ceil (hostPosition)));
+            if (hostPoint > nextPoint)
+                fillFromPublished (nextPoint, hostPoint);
+
+            nextPoint = hostPoint;
+            nextPointPosition = static_cast<double> (hostPoint);
+            pointPosition = hostPosition;
+        }
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+        writePointsUpTo (pointPosition + pointsPerSample, left[i], right[i]);
+}
+
+void OscilloscopeCapture::processTriggered (const float* left, const float* right, int numSamples) noexcept
+{
+    const double windowSamples = juce::jmax (static_cast<double> (kMinCyclePoints), windowSeconds * sampleRate);
+    setCyclePoints (juce::jmin (resolution, static_cast<int> (windowSamples)));
+
+    const double pointsPerSample = static_cast<double> (cyclePoints) / windowSamples;
+    const bool freeRunning = mode == Mode::freeRun;
+    const float level = mode == Mode::risingZeroCrossing ? 0.0f : triggerLevel;
+    const int autoTriggerSamples = static_cast<int> (juce::jmax (windowSamples, kAutoTriggerSeconds * sampleRate));
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (capturing)
+        {
+            writePointsUpTo (pointPosition + pointsPerSample, left[i], right[i]);
+            continue;
+        }
+
+        const float mono = 0.5f * (left[i] + right[i]);
+        double startPosition = -1.0;
+
+        if (freeRunning)
+        {
+            startPosition = 0.0;
+        }
+        else if (triggerArmed && mono >= level)
+        {
+            // Place the crossing between samples so the trace does not jitter by a whole sample.
+            const float span = mono - previousTriggerSample;
+            const float frac = span > 1.0e-9f ? juce::jlimit (0.0f, 1.0f, (level - previousTriggerSample) / span) : 1.0f;
+            startPosition = static_cast<double> (1.0f - frac) * pointsPerSample;
+        }
+        else if (++samplesWaitingForTrigger >= autoTriggerSamples)
+        {
+            startPosition = 0.0;
+        }
+
+        if (mono < level - kTriggerHysteresis)
+            triggerArmed = true;
+        previousTriggerSample = mono;
+
+        if (startPosition < 0.0)
+            continue;
+
+        restartCycle (startPosition);
+        capturing = true;
+        triggerArmed = false;
+        samplesWaitingForTrigger = 0;
+        writePointsUpTo (startPosition + pointsPerSample, left[i], right[i]);
+    }
+}
+
+// Audio thread. Applies the cycle length for the current settings; a change starts a new cycle.
+void OscilloscopeCapture::setCyclePoints (int points) noexcept
+{
+    points = juce::jmax (kMinCyclePoints, points);
+    if (points == cyclePoints)
+        return;
+
+    cyclePoints = points;
+    restartCycle (0.0);
+    capturing = false;
+}
+
+void OscilloscopeCapture::writePointsUpTo (double endPosition, float sampleLeft, float sampleRight) noexcept
+{
+    if (nextPointPosition >= endPosition)
+    {
+        pointPosition = endPosition;
+        return;
+    }
+
+    const float clampedLeft = juce::jlimit (-1.0f, 1.0f, sampleLeft);
+    const float clampedRight = juce::jlimit (-1.0f, 1.0f, sampleRight);
+    while (nextPointPosition < endPosition)
+    {
+        const auto index = static_cast<size_t> (nextPoint);
+        writeSlot->left[index].store (clampedLeft, std::memory_order_relaxed);
+        writeSlot->right[index].store (clampedRight, std::memory_order_relaxed);
+
+        ++nextPoint;
+        nextPointPosition += 1.0;
+        if (nextPoint < cyclePoints)
+            continue;
+
+        publishCycle();
+        nextPoint = 0;
+        nextPointPosition -= static_cast<double> (cyclePoints);
+        endPosition -= static_cast<double> (cyclePoints);
+
+        if (mode == Mode::risingZeroCrossing || mode == Mode::levelThreshold)
+        {
+            restartCycle (0.0);
+            capturing = false;
+            return;
+        }
+    }
+
+    pointPosition = endPosition;
+}
+
+void OscilloscopeCapture::restartCycle (double startPosition) noexcept
+{
+    pointPosition = startPosition;
+    nextPoint = 0;
+    nextPointPosition = 0.0;
+}
+
+void OscilloscopeCapture::publishCycle() noexcept
+{
+    writeSlot->points.store (cyclePoints, std::memory_order_relaxed);
+    const auto published = publishedCount.fetch_add (1, std::memory_order_acq_rel) + 1u;
+    std::atomic_thread_fence (std::memory_order_release);
+    writeSlot = &slots[static_cast<size_t> ((published + 1u) & 1u)];
+}
+
+void OscilloscopeCapture::fillFromPublished (int fromPoint, int toPoint) noexcept
+{
+    auto& target = *writeSlot;
+    const auto& source = getPublishedSlot();
+    const bool sourceMatches = source.points.load (std::memory_order_relaxed) == cyclePoints;
+
+    for (int i = juce::jmax (0, fromPoint); i < juce::jmin (cyclePoints, toPoint); ++i)
+    {
+        const auto index = static_cast<size_t> (i);
+        target.left[index].store (sourceMatches ? source.left[index].load (std::memory_order_relaxed) : 0.0f,
+                                  std::memory_order_relaxed);
+        target.right[index].store (sourceMatches ? source.right[index].load (std::memory_order_relaxed) : 0.0f,
+                                   std::memory_order_relaxed);
+    }
+}
+
+const OscilloscopeCapture::Slot& OscilloscopeCapture::getPublishedSlot() const noexcept
+{
+    return slots[static_cast<size_t> (publishedCount.load (std::memory_order_relaxed) & 1u)];
+}
+
+int OscilloscopeCapture::copyLatestCycle (std::vector<float>& left, std::vector<float>& right, std::uint32_t& sequence) const
+{
+    for (int attempt = 0; attempt < 4; ++attempt)
+    {
+        const auto count = publishedCount.load (std::memory_order_acquire);
+        const auto& slot = slots[static_cast<size_t> (count & 1u)];
+        const int points = juce::jlimit (0, maxResolution, slot.points.load (std::memory_order_relaxed));
+
+        left.resize (static_cast<size_t> (points));
+        right.resize (static_cast<size_t> (points));
+        for (int i = 0; i < points; ++i)
+        {
+            const auto index = static_cast<size_t> (i);
+            left[index] = slot.left[index].load (std::memory_order_relaxed);
+            right[index] = slot.right[index].load (std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (publishedCount.load (std::memory_order_relaxed) == count)
+        {
+            sequence = count;
+            return points;
+        }
+    }
+
+    return 0;
+}
+
+std::uint32_t OscilloscopeCapture::getPublishedSequence() const noexcept
+{
+    return publishedCount.load (std::memory_order_acquire);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Waveform capture for the oscilloscope overlay. The audio thread maps each cycle onto a
+// fixed number of points and only publishes complete cycles; readers copy the latest
+// published cycle and retry if a newer one was published while they were copying.
+// A cycle never has more points than it spans samples, so each sample writes at most one.
+class OscilloscopeCapture
+{
+public:
+    static constexpr int minResolution = 1024;
+    static constexpr int maxResolution = 8192;
+    static constexpr int defaultResolution = 2048;
+
+    enum class Mode
+    {
+        beat = 0,
+        bar,
+        risingZeroCrossing,
+        levelThreshold,
+        freeRun
+    };
+    static constexpr int numModes = 5;
+
+    struct TempoSync
+    {
+        double samplesPerCycle = 1.0;
+        bool hasHostPosition = false;
+        double hostSamplesIntoCycle = 0.0;
+    };
+
+    // Audio thread.
+    void prepare (double newSampleRate) noexcept;
+    void reset() noexcept;
+    void setMode (Mode newMode) noexcept;
+    void setResolution (int points) noexcept;
+    void setTriggerLevel (float level) noexcept;
+    void setWindowSeconds (double seconds) noexcept;
+    int getResolution() const noexcept { return resolution; }
+    float getTriggerLevel() const noexcept { return triggerLevel; }
+    double getWindowSeconds() const noexcept { return windowSeconds; }
+    void process (const float* left, const float* right, int numSamples, const TempoSync& sync) noexcept;
+
+    // Any thread. Returns the number of points copied, or 0 when no stable copy was possible.
+    int copyLatestCycle (std::vector<float>& left, std::vector<float>& right, std::uint32_t& sequence) const;
+    std::uint32_t getPublishedSequence() const noexcept;
+
+    static bool isTempoSynced (Mode m) noexcept { return m == Mode::beat || m == Mode::bar; }
+
+private:
+    struct Slot
+    {
+        std::array<std::atomic<float>, maxResolution> left {};
+        std::array<std::atomic<float>, maxResolution> right {};
+        std::atomic<int> points { defaultResolution };
+    };
+
+    void processTempoSynced (const float* left, const float* right, int numSamples, const TempoSync& sync) noexcept;
+    void processTriggered (const float* left, const float* right, int numSamples) noexcept;
+    void setCyclePoints (int points) noexcept;
+    void writePointsUpTo (double endPosition, float sampleLeft, float sampleRight) noexcept;
+    void restartCycle (double startPosition) noexcept;
+    void publishCycle() noexcept;
+    void fillFromPublished (int fromPoint, int toPoint) noexcept;
+    const Slot& getPublishedSlot() const noexcept;
+
+    std::array<Slot, 2> slots;
+    std::atomic<std::uint32_t> publishedCount { 0 };
+
+    double sampleRate = 44100.0;
+    Mode mode = Mode::beat;
+    int resolution = defaultResolution;
+    // The resolution capped at the cycle's length in samples.
+    int cyclePoints = defaultResolution;
+    Slot* writeSlot = &slots[1];
+    float triggerLevel = 0.0f;
+    double windowSeconds = 0.02;
+
+    double pointPosition = 0.0;
+    double nextPointPosition = 0.0;
+    int nextPoint = 0;
+    bool capturing = false;
+    bool triggerArmed = false;
+    float previousTriggerSample = 0.0f;
+    int samplesWaitingForTrigger = 0;
+};
@@ -0,0 +1,247 @@
+#include "PartitionedConvolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    delete activeFilter;
+    delete fadingFilter;
+    delete pendingFilter.exchange (nullptr);
+    delete retiredFilter.exchange (nullptr);
+}
+
+void PartitionedConvolver::prepare (int newPartitionSize, int newMaxPartitions)
+{
+    partitionSize = juce::nextPowerOfTwo (juce::jmax (16, newPartitionSize));
+    numBins = partitionSize + 1;
+    maxPartitions = juce::jmax (1, newMaxPartitions);
+    fft = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (static_cast<double> (2 * partitionSize))));
+
+    for (auto& channel : channels)
+    {
+        channel.frame.assign (static_cast<size_t> (2 * partitionSize), 0.0f);
+        channel.output.assign (static_cast<size_t> (partitionSize), 0.0f);
+        channel.delayLine.assign (static_cast<size_t> (maxPartitions * numBins), Complex());
+    }
+
+    fftBuffer.assign (static_cast<size_t> (4 * partitionSize), 0.0f);
+    accumulator.assign (static_cast<size_t> (numBins), Complex());
+    fadeOutput.assign (static_cast<size_t> (partitionSize), 0.0f);
+
+    // Filters built for a different partition size no longer fit.
+    delete activeFilter;
+    delete fadingFilter;
+    activeFilter = nullptr;
+    fadingFilter = nullptr;
+    delete pendingFilter.exchange (nullptr);
+    collectRetiredFilters();
+    reset();
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    for (auto& channel : channels)
+    {
+        std::fill (channel.frame.begin(), channel.frame.end(), 0.0f);
+        std::fill (channel.output.begin(), channel.output.end(), 0.0f);
+        std::fill (channel.delayLine.begin(), channel.delayLine.end(), Complex());
+    }
+
+    delayLineHead = 0;
+    fillIndex = 0;
+}
+
+std::unique_ptr<PartitionedConvolver::Filter> PartitionedConvolver::createFilter (const float* impulse, int length, int delaySamples) const
+{
+    if (fft == nullptr || partitionSize <= 0)
+        return {};
+
+    const int usableLength = juce::jlimit (0, maxPartitions * partitionSize, length);
+    auto filter = std::make_unique<Filter>();
+    filter->delaySamples = delaySamples;
+    filter->numPartitions = juce::jmax (1, (usableLength + partitionSize - 1) / partitionSize);
+    filter->spectra.assign (static_cast<size_t> (filter->numPartitions * numBins), Complex());
+
+    std::vector<float> buffer (static_cast<size_t> (4 * partitionSize), 0.0f);
+    for (int p = 0; p < filter->numPartitions; ++p)
+    {
+        std::fill (buffer.begin(), buffer.end(), 0.0f);
+        const int start = p * partitionSize;
+        const int count = juce::jmin (partitionSize, usableLength - start);
+        if (count > 0)
+            std::copy (impulse + start, impulse + start + count, buffer.begin());
+
+        fft->performRealOnlyForwardTransform (buffer.data(), true);
+        const auto* bins = reinterpret_cast<const Complex*> (buffer.data());
+        std::copy (bins, bins + numBins, filter->spectra.begin() + static_cast<std::ptrdiff_t> (p * numBins));
+    }
+
+    return filter;
+}
+
+void PartitionedConvolver::setFilter (std::unique_ptr<Filter> filter) noexcept
+{
+    delete activeFilter;
+    delete fadingFilter;
+    activeFilter = filter.release();
+    fadingFilter = nullptr;
+    crossfadeRemaining = 0;
+}
+
+bool PartitionedConvolver::offerFilter (std::unique_ptr<Filter>& filter) noexcept
+{
+    collectRetiredFilters();
+    if (filter == nullptr)
+        return true;
+
+    Filter* expected = nullptr;
+    if (! pendingFilter.compare_exchange_strong (expected, filter.get(), std::memory_order_acq_rel))
+        return false;
+
+    filter.release();
+    return true;
+}
+
+void PartitionedConvolver::collectRetiredFilters() noexcept
+{
+    delete retiredFilter.exchange (nullptr, std::memory_order_acq_rel);
+}
+
+void PartitionedConvolver::process (float* const* channelData, int numChannels, int numSamples) noexcept
+{
+    if (fft == nullptr)
+        return;
+
+    numChannels = juce::jmin (numChannels, maxChannels);
+    int position = 0;
+    while (position < numSamples)
+    {
+        const int count = juce::jmin (numSamples - position, partitionSize - fillIndex);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& channel = channels[static_cast<size_t> (ch)];
+            float* samples = channelData[ch] + position;
+            float* input = channel.frame.data() + partitionSize + fillIndex;
+            const float* output = channel.output.data() + fillIndex;
+            for (int i = 0; i < count; ++i)
+            {
+                input[i] = samples[i];
+                samples[i] = output[i];
+            }
+        }
+
+        fillIndex += count;
+        position += count;
+
+        if (fillIndex == partitionSize)
+        {
+            processPartition (numChannels);
+            fillIndex = 0;
+        }
+    }
+}
+
+void PartitionedConvolver::processPartition (int numChannels) noexcept
+{
+    if (crossfadeRemaining == 0 && retiredFilter.load (std::memory_order_acquire) == nullptr)
+    {
+        if (auto* next = pendingFilter.exchange (nullptr, std::memory_order_acq_rel))
+        {
+            const int activeDelay = activeFilter != nullptr ? activeFilter->delaySamples : 0;
+            if (next->delaySamples == activeDelay)
+            {
+                fadingFilter = activeFilter;
+                crossfadeRemaining = crossfadePartitions;
+            }
+            else
+            {
+                retiredFilter.store (activeFilter, std::memory_order_release);
+            }
+            activeFilter = next;
+        }
+    }
+
+    delayLineHead = (delayLineHead + maxPartitions - 1) % maxPartitions;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = channels[static_cast<size_t> (ch)];
+
+        std::fill (fftBuffer.begin(), fftBuffer.end(), 0.0f);
+        std::copy (channel.frame.begin(), channel.frame.end(), fftBuffer.begin());
+        fft->performRealOnlyForwardTransform (fftBuffer.data(), true);
+        const auto* bins = reinterpret_cast<const Complex*> (fftBuffer.data());
+        std::copy (bins, bins + numBins, channel.delayLine.begin() + static_cast<std::ptrdiff_t> (delayLineHead * numBins));
+
+        // With no filter yet the convolver is a plain B-sample delay, so the first filter
+        // fades in from the dry signal rather than from silence.
+        const float* dry = channel.frame.data() + partitionSize;
+
+        if (activeFilter != nullptr)
+        {
+            accumulate (channel, *activeFilter, accumulator.data());
+            inverseToOutput (accumulator.data(), channel.output.data());
+        }
+        else
+        {
+            std::copy (dry, dry + partitionSize, channel.output.begin());
+        }
+
+        if (crossfadeRemaining > 0)
+        {
+            if (fadingFilter != nullptr)
+            {
+                accumulate (channel, *fadingFilter, accumulator.data());
+                inverseToOutput (accumulator.data(), fadeOutput.data());
+            }
+            else
+            {
+                std::copy (dry, dry + partitionSize, fadeOutput.begin());
+            }
+
+            const float totalLength = static_cast<float> (crossfadePartitions * partitionSize);
+            const float start = static_cast<float> ((crossfadePartitions - crossfadeRemaining) * partitionSize);
+            for (int n = 0; n < partitionSize; ++n)
+            {
+                const float gain = (start + static_cast<float> (n)) / totalLength;
+                auto& sample = channel.output[static_cast<size_t> (n)];
+                sample = fadeOutput[static_cast<size_t> (n)] + gain * (sample - fadeOutput[static_cast<size_t> (n)]);
+            }
+        }
+
+        std::copy (channel.frame.begin() + partitionSize, channel.frame.end(), channel.frame.begin());
+    }
+
+    if (crossfadeRemaining > 0 && --crossfadeRemaining == 0)
+    {
+        // Nothing else stores into retiredFilter, and it was empty when this fade started.
+        retiredFilter.store (fadingFilter, std::memory_order_release);
+        fadingFilter = nullptr;
+    }
+}
+
+void PartitionedConvolver::accumulate (const ChannelState& channel, const Filter& filter, Complex* result) const noexcept
+{
+    std::fill (result, result + numBins, Complex());
+
+    const int numPartitions = juce::jmin (filter.numPartitions, maxPartitions);
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const int slot = (delayLineHead + p) % maxPartitions;
+        const auto* x = channel.delayLine.data() + slot * numBins;
+        const auto* h = filter.spectra.data() + p * numBins;
+        for (int k = 0; k < numBins; ++k)
+            result[k] += x[k] * h[k];
+    }
+}
+
+void PartitionedConvolver::inverseToOutput (const Complex* spectrum, float* destination) noexcept
+{
+    std::fill (fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    std::copy (spectrum, spectrum + numBins, reinterpret_cast<Complex*> (fftBuffer.data()));
+    fft->performRealOnlyInverseTransform (fftBuffer.data());
+
+    // Overlap-save: the first half of the circular result is wrapped, the second half is valid.
+    std::copy (fftBuffer.begin() + partitionSize, fftBuffer.begin() + 2 * partitionSize, destination);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+// Uniformly partitioned overlap-save convolution. The impulse response is split into
+// partitions of B samples whose 2B-point spectra are multiplied against a frequency-domain
+// delay line of past input spectra, so each B-sample block costs one forward FFT, one
+// inverse FFT and one complex multiply-add per partition. Latency is B samples.
+//
+// New filters are handed over lock-free and crossfaded in over a few partitions; because
+// the delay line does not depend on the filter, the old and new outputs come from the same
+// input spectra. A filter whose delay differs from the current one is switched in without
+// the fade, since mixing the two would comb-filter. Retired filters are freed by the thread
+// that offers new ones.
+class PartitionedConvolver
+{
+public:
+    using Complex = std::complex<float>;
+
+    struct Filter
+    {
+        int numPartitions = 0;
+        // The delay the impulse response adds on top of the partition latency.
+        int delaySamples = 0;
+        std::vector<Complex> spectra;
+    };
+
+    static constexpr int maxChannels = 2;
+    static constexpr int crossfadePartitions = 8;
+
+    PartitionedConvolver() = default;
+    ~PartitionedConvolver();
+
+    // Allocates; call while the audio thread is not processing.
+    void prepare (int newPartitionSize, int newMaxPartitions);
+    void reset() noexcept;
+
+    int getPartitionSize() const noexcept { return partitionSize; }
+    int getLatencySamples() const noexcept { return partitionSize; }
+
+    // Background thread. Builds partition spectra for an impulse response of any length up to
+    // maxPartitions * partitionSize samples.
+    std::unique_ptr<Filter> createFilter (const float* impulse, int length, int delaySamples = 0) const;
+
+    // Call while the audio thread is not processing. Installs a filter at once, without a fade;
+    // until the first filter arrives the convolver passes the input through with no extra delay.
+    void setFilter (std::unique_ptr<Filter> filter) noexcept;
+
+    // Background thread. Returns false and leaves the filter with the caller if the previous
+    // offer has not been picked up yet.
+    bool offerFilter (std::unique_ptr<Filter>& filter) noexcept;
+    void collectRetiredFilters() noexcept;
+
+    // Audio thread.
+    void process (float* const* channels, int numChannels, int numSamples) noexcept;
+
+private:
+    struct ChannelState
+    {
+        std::vector<float> frame;
+        std::vector<float> output;
+        std::vector<Complex> delayLine;
+    };
+
+    void processPartition (int numChannels) noexcept;
+    void accumulate (const ChannelState& channel, const Filter& filter, Complex* result) const noexcept;
+    void inverseToOutput (const Complex* spectrum, float* destination) noexcept;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int partitionSize = 0;
+    int numBins = 0;
+    int maxPartitions = 0;
+    int delayLineHead = 0;
+    int fillIndex = 0;
+
+    std::array<ChannelState, maxChannels> channels;
+    std::vector<float> fftBuffer;
+    std::vector<Complex> accumulator;
+    std::vector<float> fadeOutput;
+
+    Filter* activeFilter = nullptr;
+    Filter* fadingFilter = nullptr;
+    int crossfadeRemaining = 0;
+    std::atomic<Filter*> pendingFilter { nullptr };
+    std::atomic<Filter*> retiredFilter { nullptr };
+};
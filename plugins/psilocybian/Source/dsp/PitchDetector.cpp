@@ -0,0 +1,221 @@
+#include "PitchDetector.h"
+
+#include <cmath>
+
+#include <juce_core/juce_core.h>
+
+namespace
+{
+constexpr double kMinDetectorSampleRate = 8000.0;
+constexpr double kHopSeconds = 0.005;
+constexpr double kRefreshSeconds = 1.5;
+constexpr float kYinThreshold = 0.15f;
+constexpr double kSilenceMeanSquare = 1.0e-7;
+} // namespace
+
+void PitchDetector::prepare (double inputSampleRate, int maxInputBlockSize)
+{
+    detectorSampleRate = juce::jmax (1000.0, inputSampleRate);
+    numDecimationStages = 0;
+    while (numDecimationStages < maxDecimationStages && detectorSampleRate * 0.5 >= kMinDetectorSampleRate)
+    {
+        detectorSampleRate *= 0.5;
+        ++numDecimationStages;
+    }
+
+    decimationScratch.assign (static_cast<size_t> (juce::jmax (1, maxInputBlockSize)), 0.0f);
+
+    maxLag = static_cast<int> (std::ceil (detectorSampleRate / static_cast<double> (minFrequencyHz)));
+    minLag = juce::jmax (2, static_cast<int> (std::floor (detectorSampleRate / static_cast<double> (maxFrequencyHz))));
+    windowSize = maxLag;
+    hopSize = juce::jmax (1, static_cast<int> (std::lround (detectorSampleRate * kHopSeconds)));
+    refreshIntervalHops = juce::jmax (1, static_cast<int> (kRefreshSeconds / kHopSeconds));
+
+    historySize = juce::nextPowerOfTwo (windowSize + maxLag + 2);
+    historyMask = historySize - 1;
+    history.assign (static_cast<size_t> (historySize * 2), 0.0f);
+    difference.assign (static_cast<size_t> (maxLag + 1), 0.0);
+    normalizedDifference.assign (static_cast<size_t> (maxLag + 1), 1.0f);
+
+    reset();
+}
+
+void PitchDetector::reset() noexcept
+{
+    for (auto& decimator : decimators)
+        decimator.reset();
+
+    std::fill (history.begin(), history.end(), 0.0f);
+    std::fill (difference.begin(), difference.end(), 0.0);
+    samplesWritten = 0;
+    samplesUntilHop = hopSize;
+    hopsUntilRefresh = refreshIntervalHops;
+    differenceValid = false;
+    windowEnergy = 0.0;
+    publish (0.0f, 0.0f);
+}
+
+void PitchDetector::process (const float* input, int numSamples) noexcept
+{
+    const int capacity = static_cast<int> (decimationScratch.size());
+    while (numSamples > 0)
+    {
+        const int chunk = juce::jmin (numSamples, capacity);
+        const float* source = input;
+        int count = chunk;
+
+        for (int stage = 0; stage < numDecimationStages; ++stage)
+        {
+            count = decimators[static_cast<size_t> (stage)].process (source, count, decimationScratch.data());
+            source = decimationScratch.data();
+        }
+
+        for (int i = 0; i < count; ++i)
+            pushDetectorSample (source[i]);
+
+        input += chunk;
+        numSamples -= chunk;
+    }
+}
+
+void PitchDetector::pushDetectorSample (float sample) noexcept
+{
+    const auto slot = static_cast<size_t> (samplesWritten & historyMask);
+    history[slot] = sample;
+    history[slot + static_cast<size_t> (historySize)] = sample;
+    ++samplesWritten;
+
+    const long long span = static_cast<long long> (windowSize + maxLag);
+    if (samplesWritten < span)
+        return;
+
+    const int windowStart = static_cast<int> ((samplesWritten - span) & historyMask);
+    if (! differenceValid)
+    {
+        recomputeDifference (windowStart);
+        differenceValid = true;
+        hopsUntilRefresh = refreshIntervalHops;
+    }
+    else
+    {
+        slideDifference (windowStart);
+    }
+
+    if (--samplesUntilHop > 0)
+        return;
+
+    samplesUntilHop = hopSize;
+    if (--hopsUntilRefresh <= 0)
+    {
+        recomputeDifference (windowStart);
+        hopsUntilRefresh = refreshIntervalHops;
+    }
+
+    estimateFromDifference();
+}
+
+void PitchDetector::slideDifference (int windowStart) noexcept
+{
+    // The window moved from [start - 1, start + W - 1) to [start, start + W): add the lag
+    // products of the newest window sample and remove those of the sample that left.
+    const float* added = history.data() + ((windowStart + windowSize - 1) & historyMask);
+    const float* removed = history.data() + ((windowStart - 1) & historyMask);
+    const float addedSample = added[0];
+    const float removedSample = removed[0];
+
+    for (int tau = 1; tau <= maxLag; ++tau)
+    {
+        const float a = addedSample - added[tau];
+        const float r = removedSample - removed[tau];
+        difference[static_cast<size_t> (tau)] += static_cast<double> (a * a - r * r);
+    }
+
+    windowEnergy += static_cast<double> (addedSample * addedSample - removedSample * removedSample);
+}
+
+void PitchDetector::recomputeDifference (int windowStart) noexcept
+{
+    const float* x = history.data() + windowStart;
+
+    double energy = 0.0;
+    for (int j = 0; j < windowSize; ++j)
+        energy += static_cast<double> (x[j] * x[j]);
+    windowEnergy = energy;
+
+    for (int tau = 1; tau <= maxLag; ++tau)
+    {
+        double sum = 0.0;
+        for (int j = 0; j < windowSize; ++j)
+        {
+            const float d = x[j] - x[j + tau];
+            sum += static_cast<double> (d * d);
+        }
+        difference[static_cast<size_t> (tau)] = sum;
+    }
+}
+
+void PitchDetector::estimateFromDifference() noexcept
+{
+    if (windowEnergy < kSilenceMeanSquare * static_cast<double> (windowSize))
+    {
+        publish (0.0f, 0.0f);
+        return;
+    }
+
+    // Cumulative mean normalised difference (YIN step 3).
+    double runningSum = 0.0;
+    normalizedDifference[0] = 1.0f;
+    for (int tau = 1; tau <= maxLag; ++tau)
+    {
+        const double d = juce::jmax (0.0, difference[static_cast<size_t> (tau)]);
+        runningSum += d;
+        normalizedDifference[static_cast<size_t> (tau)] = runningSum > 1.0e-20
+            ? static_cast<float> (d * static_cast<double> (tau) / runningSum)
+            : 1.0f;
+    }
+
+    auto value = [this] (int tau) { return normalizedDifference[static_cast<size_t> (tau)]; };
+
+    int bestLag = -1;
+    for (int tau = minLag; tau < maxLag; ++tau)
+    {
+        if (value (tau) >= kYinThreshold)
+            continue;
+
+        while (tau + 1 < maxLag && value (tau + 1) < value (tau))
+            ++tau;
+        bestLag = tau;
+        break;
+    }
+
+    if (bestLag < 0)
+    {
+        bestLag = minLag;
+        for (int tau = minLag + 1; tau < maxLag; ++tau)
+            if (value (tau) < value (bestLag))
+                bestLag = tau;
+    }
+
+    const float y0 = value (bestLag - 1);
+    const float y1 = value (bestLag);
+    const float y2 = value (bestLag + 1);
+    const float curvature = y0 - 2.0f * y1 + y2;
+    const float shift = curvature > 1.0e-9f ? juce::jlimit (-0.5f, 0.5f, 0.5f * (y0 - y2) / curvature) : 0.0f;
+
+    const double period = static_cast<double> (bestLag) + static_cast<double> (shift);
+    publish (static_cast<float> (detectorSampleRate / period), juce::jlimit (0.0f, 1.0f, 1.0f - y1));
+}
+
+void PitchDetector::publish (float frequencyHz, float confidence) noexcept
+{
+    publishedFrequencyHz.store (frequencyHz, std::memory_order_relaxed);
+    publishedConfidence.store (confidence, std::memory_order_relaxed);
+}
+
+PitchDetector::Estimate PitchDetector::getEstimate() const noexcept
+{
+    Estimate estimate;
+    estimate.frequencyHz = publishedFrequencyHz.load (std::memory_order_relaxed);
+    estimate.confidence = publishedConfidence.load (std::memory_order_relaxed);
+    return estimate;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "HalfBandDecimator.h"
+
+// YIN fundamental estimator for the low register. Input is decimated to roughly 8-16 kHz and
+// the difference function is slid one sample at a time (add the newest lag products, drop the
+// oldest), so the cost per hop is hop * maxLag instead of window * maxLag. A full recompute
+// runs every few hundred hops to stop rounding drift from accumulating.
+class PitchDetector
+{
+public:
+    struct Estimate
+    {
+        float frequencyHz = 0.0f;
+        float confidence = 0.0f;
+    };
+
+    static constexpr float minFrequencyHz = 27.5f;
+    static constexpr float maxFrequencyHz = 1000.0f;
+
+    // Worker thread, or any thread while the worker is stopped.
+    void prepare (double inputSampleRate, int maxInputBlockSize);
+    void reset() noexcept;
+    void process (const float* input, int numSamples) noexcept;
+
+    // Any thread.
+    Estimate getEstimate() const noexcept;
+
+private:
+    static constexpr int maxDecimationStages = 4;
+
+    void pushDetectorSample (float sample) noexcept;
+    void slideDifference (int windowStart) noexcept;
+    void recomputeDifference (int windowStart) noexcept;
+    void estimateFromDifference() noexcept;
+    void publish (float frequencyHz, float confidence) noexcept;
+
+    std::array<HalfBandDecimator<31>, maxDecimationStages> decimators;
+    int numDecimationStages = 0;
+    std::vector<float> decimationScratch;
+
+    double detectorSampleRate = 11025.0;
+    int windowSize = 0;
+    int minLag = 1;
+    int maxLag = 1;
+    int hopSize = 1;
+    int refreshIntervalHops = 1;
+
+    std::vector<float> history;
+    int historySize = 0;
+    int historyMask = 0;
+    long long samplesWritten = 0;
+    int samplesUntilHop = 0;
+    int hopsUntilRefresh = 0;
+    bool differenceValid = false;
+
+    std::vector<double> difference;
+    std::vector<float> normalizedDifference;
+    double windowEnergy = 0.0;
+
+    std::atomic<float> publishedFrequencyHz { 0.0f };
+    std::atomic<float> publishedConfidence { 0.0f };
+};
@@ -0,0 +1,101 @@
+#include "RealFftBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+RealFftBatch::RealFftBatch (int order, FftEngine::Backend backend)
+    : fft (order, backend),
+      halfFft (juce::jmax (0, order - 1), backend),
+      size (1 << order),
+      packed (static_cast<size_t> (1 << order)),
+      spectrum (static_cast<size_t> (1 << order)),
+      realTwiddles (static_cast<size_t> (getNumBins())),
+      realSpectrum (static_cast<size_t> (getNumBins()))
+{
+    for (int k = 0; k < getNumBins(); ++k)
+    {
+        const double angle = -juce::MathConstants<double>::twoPi * static_cast<double> (k) / static_cast<double> (size);
+        realTwiddles[static_cast<size_t> (k)] = Complex (static_cast<float> (std::cos (angle)), static_cast<float> (std::sin (angle)));
+    }
+}
+
+void RealFftBatch::transformPacked (const float* a, const float* b) noexcept
+{
+    for (int n = 0; n < size; ++n)
+        packed[static_cast<size_t> (n)] = Complex (a[n], b[n]);
+
+    fft.perform (packed.data(), spectrum.data());
+}
+
+void RealFftBatch::computeSpectra (const float* a, const float* b, Complex* spectrumA, Complex* spectrumB) noexcept
+{
+    transformPacked (a, b);
+
+    const int numBins = getNumBins();
+    for (int k = 0; k < numBins; ++k)
+    {
+        const auto z = spectrum[static_cast<size_t> (k)];
+        const auto mirrored = std::conj (spectrum[static_cast<size_t> ((size - k) & (size - 1))]);
+        spectrumA[k] = 0.5f * (z + mirrored);
+
+        // (z - mirrored) / 2i == -i (z - mirrored) / 2
+        const auto difference = z - mirrored;
+        spectrumB[k] = Complex (0.5f * difference.imag(), -0.5f * difference.real());
+    }
+}
+
+void RealFftBatch::computePowerSpectra (const float* a, const float* b, float* powerA, float* powerB) noexcept
+{
+    transformPacked (a, b);
+
+    const int numBins = getNumBins();
+    for (int k = 0; k < numBins; ++k)
+    {
+        const auto z = spectrum[static_cast<size_t> (k)];
+        const auto mirrored = std::conj (spectrum[static_cast<size_t> ((size - k) & (size - 1))]);
+        powerA[k] = 0.25f * std::norm (z + mirrored);
+        powerB[k] = 0.25f * std::norm (z - mirrored);
+    }
+}
+
+void RealFftBatch::transformSingle (const float* input) noexcept
+{
+    const int half = halfFft.getSize();
+    if (half == size)
+    {
+        realSpectrum[0] = Complex (input[0], 0.0f);
+        return;
+    }
+
+    for (int n = 0; n < half; ++n)
+        packed[static_cast<size_t> (n)] = Complex (input[2 * n], input[2 * n + 1]);
+
+    halfFft.perform (packed.data(), spectrum.data());
+
+    // Even samples E[k] = (Z[k] + conj Z[M-k]) / 2, odd O[k] = (Z[k] - conj Z[M-k]) / 2i,
+    // and X[k] = E[k] + W^k O[k] for k = 0..M, with Z periodic in M = N/2.
+    for (int k = 0; k <= half; ++k)
+    {
+        const auto z = spectrum[static_cast<size_t> (k & (half - 1))];
+        const auto mirrored = std::conj (spectrum[static_cast<size_t> ((half - k) & (half - 1))]);
+        const auto even = 0.5f * (z + mirrored);
+        const auto difference = z - mirrored;
+        const auto odd = Complex (0.5f * difference.imag(), -0.5f * difference.real());
+        realSpectrum[static_cast<size_t> (k)] = even + realTwiddles[static_cast<size_t> (k)] * odd;
+    }
+}
+
+void RealFftBatch::computeSpectrum (const float* input, Complex* output) noexcept
+{
+    transformSingle (input);
+    std::copy (realSpectrum.begin(), realSpectrum.end(), output);
+}
+
+void RealFftBatch::computePowerSpectrum (const float* input, float* power) noexcept
+{
+    transformSingle (input);
+
+    const int numBins = getNumBins();
+    for (int k = 0; k < numBins; ++k)
+        power[k] = std::norm (realSpectrum[static_cast<size_t> (k)]);
+}
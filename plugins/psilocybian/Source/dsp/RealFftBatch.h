@@ -0,0 +1,43 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "FftEngine.h"
+
+// Transforms two real frames of the same size with a single complex FFT by packing them as
+// a + ib, then separates the two half spectra using conjugate symmetry:
+//   A[k] = (Z[k] + conj Z[N-k]) / 2,   B[k] = (Z[k] - conj Z[N-k]) / 2i.
+// Single frames are packed as even + i odd samples into a half-size transform instead, and
+// split again with the twiddles W^k. Scaling matches juce::dsp::FFT's unnormalised forward
+// transform.
+class RealFftBatch
+{
+public:
+    using Complex = std::complex<float>;
+
+    explicit RealFftBatch (int order, FftEngine::Backend backend = FftEngine::defaultBackend);
+
+    int getSize() const noexcept { return size; }
+    int getNumBins() const noexcept { return (size / 2) + 1; }
+
+    // Realtime safe. Inputs hold getSize() samples; outputs receive getNumBins() values.
+    void computeSpectra (const float* a, const float* b, Complex* spectrumA, Complex* spectrumB) noexcept;
+    void computePowerSpectra (const float* a, const float* b, float* powerA, float* powerB) noexcept;
+
+    // Single frame, for when there is nothing to pair it with.
+    void computeSpectrum (const float* input, Complex* output) noexcept;
+    void computePowerSpectrum (const float* input, float* power) noexcept;
+
+private:
+    void transformPacked (const float* a, const float* b) noexcept;
+    void transformSingle (const float* input) noexcept;
+
+    FftEngine fft;
+    FftEngine halfFft;
+    int size = 0;
+    std::vector<Complex> packed;
+    std::vector<Complex> spectrum;
+    std::vector<Complex> realTwiddles;
+    std::vector<Complex> realSpectrum;
+};
@@ -0,0 +1,232 @@
+#include "ReassignedSpectrogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace
+{
+constexpr float kMinFrequencyHz = 20.0f;
+constexpr float kMaxFrequencyHz = 20000.0f;
+constexpr float kFloorDb = -96.0f;
+// Outside the Hann main lobe the instantaneous frequency estimate is dominated by leakage from
+// the neighbouring components, so those bins keep no energy of their own.
+constexpr float kMaxFrequencyReassignmentBins = 2.0f;
+} // namespace
+
+ReassignedSpectrogram::ReassignedSpectrogram()
+    : window (SharedDspTables::getWindow (SharedDspTables::WindowKind::hann, fftSize)),
+      timeRampedWindow (SharedDspTables::getWindow (SharedDspTables::WindowKind::hannTimeRamped, fftSize)),
+      derivativeWindow (SharedDspTables::getWindow (SharedDspTables::WindowKind::hannDerivative, fftSize))
+{
+    prepare (48000.0);
+}
+
+void ReassignedSpectrogram::prepare (double sampleRate)
+{
+    // Reassignment gathers the whole main lobe into one cell, which carries the window's noise
+    // bandwidth (in bins) times the peak power.
+    const double magnitudeScale = static_cast<double> (window->magnitudeScale);
+    powerScale = static_cast<float> (magnitudeScale * magnitudeScale);
+    reassignedPowerScale = static_cast<float> (magnitudeScale * magnitudeScale * window->sum * window->sum
+                                               / (static_cast<double> (fftSize) * window->sumOfSquares));
+    const double floorMagnitude = std::pow (10.0, static_cast<double> (kFloorDb) / 20.0) / magnitudeScale;
+    powerFloor = static_cast<float> (floorMagnitude * floorMagnitude);
+
+    const double binWidthHz = juce::jmax (1000.0, sampleRate) / static_cast<double> (fftSize);
+    const float nyquist = static_cast<float> (sampleRate * 0.5);
+    const float maxFreq = juce::jlimit (kMinFrequencyHz + 1.0f, juce::jmax (kMinFrequencyHz + 1.0f, nyquist), kMaxFrequencyHz);
+    const float logRatio = std::log (maxFreq / kMinFrequencyHz);
+    const float halfStep = 0.5f * logRatio / static_cast<float> (numBins - 1);
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        const float logFrequency = std::log (kMinFrequencyHz) + logRatio * static_cast<float> (i) / static_cast<float> (numBins - 1);
+        const double lowHz = std::exp (logFrequency - halfStep);
+        const double highHz = std::exp (logFrequency + halfStep);
+        fractionalFftBin[idx] = static_cast<float> (std::exp (logFrequency) / binWidthHz);
+        firstFftBin[idx] = juce::jlimit (0, numFftBins - 1, static_cast<int> (std::ceil (lowHz / binWidthHz)));
+        lastFftBin[idx] = juce::jlimit (0, numFftBins - 1, static_cast<int> (std::floor (highHz / binWidthHz)));
+    }
+
+    lowestBin = static_cast<float> (kMinFrequencyHz / binWidthHz);
+    binsPerLogFftBin = static_cast<float> (numBins - 1) / logRatio;
+
+    reset();
+}
+
+void ReassignedSpectrogram::reset() noexcept
+{
+    frame.fill (0.0f);
+    frameFill = 0;
+    for (auto& column : pending)
+        column.fill (0.0f);
+    framesProcessed = 0;
+}
+
+void ReassignedSpectrogram::process (const float* input, int numSamples) noexcept
+{
+    const auto mode = getMode();
+    if (mode != activeMode)
+    {
+        activeMode = mode;
+        reset();
+    }
+
+    if (activeMode == Mode::off)
+        return;
+
+    while (numSamples > 0)
+    {
+        const int count = juce::jmin (numSamples, fftSize - frameFill);
+        std::copy (input, input + count, frame.begin() + frameFill);
+        frameFill += count;
+        input += count;
+        numSamples -= count;
+
+        if (frameFill == fftSize)
+        {
+            processFrame();
+            std::copy (frame.begin() + hopSize, frame.end(), frame.begin());
+            frameFill = fftSize - hopSize;
+        }
+    }
+}
+
+void ReassignedSpectrogram::processFrame() noexcept
+{
+    if (activeMode == Mode::reassigned)
+        accumulateReassigned();
+    else
+        accumulateStandard (static_cast<int> (framesProcessed % static_cast<std::uint64_t> (numPendingColumns)));
+
+    ++framesProcessed;
+    if (framesProcessed > static_cast<std::uint64_t> (latencyColumns))
+    {
+        const auto finished = framesProcessed - 1 - static_cast<std::uint64_t> (latencyColumns);
+        publishColumn (static_cast<int> (finished % static_cast<std::uint64_t> (numPendingColumns)));
+    }
+}
+
+void ReassignedSpectrogram::accumulateStandard (int pendingSlot) noexcept
+{
+    juce::FloatVectorOperations::multiply (windowed.data(), frame.data(), window->values.data(), fftSize);
+    fft.computePowerSpectrum (windowed.data(), power.data());
+
+    auto& column = pending[static_cast<size_t> (pendingSlot)];
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        const int first = firstFftBin[idx];
+        const int last = lastFftBin[idx];
+        if (last >= first)
+        {
+            column[idx] = *std::max_element (power.begin() + first, power.begin() + last + 1);
+            continue;
+        }
+
+        // Narrower than an FFT bin: interpolate between the two around it.
+        const float position = fractionalFftBin[idx];
+        const int lower = juce::jlimit (0, numFftBins - 2, static_cast<int> (position));
+        const float frac = juce::jlimit (0.0f, 1.0f, position - static_cast<float> (lower));
+        column[idx] = power[static_cast<size_t> (lower)] + frac * (power[static_cast<size_t> (lower + 1)] - power[static_cast<size_t> (lower)]);
+    }
+}
+
+void ReassignedSpectrogram::accumulateReassigned() noexcept
+{
+    juce::FloatVectorOperations::multiply (windowed.data(), frame.data(), window->values.data(), fftSize);
+    juce::FloatVectorOperations::multiply (windowedDerivative.data(), frame.data(), derivativeWindow->values.data(), fftSize);
+    fft.computeSpectra (windowed.data(), windowedDerivative.data(), spectrum.data(), derivativeSpectrum.data());
+    juce::FloatVectorOperations::multiply (windowed.data(), frame.data(), timeRampedWindow->values.data(), fftSize);
+    fft.computeSpectrum (windowed.data(), timeRampedSpectrum.data());
+
+    for (int k = 0; k < numFftBins; ++k)
+    {
+        const auto idx = static_cast<size_t> (k);
+        re[idx] = spectrum[idx].real();
+        im[idx] = spectrum[idx].imag();
+        timeRampedRe[idx] = timeRampedSpectrum[idx].real();
+        timeRampedIm[idx] = timeRampedSpectrum[idx].imag();
+        derivativeRe[idx] = derivativeSpectrum[idx].real();
+        derivativeIm[idx] = derivativeSpectrum[idx].imag();
+    }
+
+    // |X_h|^2, Im (X_dh conj X_h) and Re (X_th conj X_h) for all bins at once.
+    juce::FloatVectorOperations::multiply (power.data(), re.data(), re.data(), numFftBins);
+    juce::FloatVectorOperations::addWithMultiply (power.data(), im.data(), im.data(), numFftBins);
+    juce::FloatVectorOperations::multiply (frequencyOffset.data(), derivativeIm.data(), re.data(), numFftBins);
+    juce::FloatVectorOperations::subtractWithMultiply (frequencyOffset.data(), derivativeRe.data(), im.data(), numFftBins);
+    juce::FloatVectorOperations::multiply (timeOffset.data(), timeRampedRe.data(), re.data(), numFftBins);
+    juce::FloatVectorOperations::addWithMultiply (timeOffset.data(), timeRampedIm.data(), im.data(), numFftBins);
+
+    const float radiansToBins = static_cast<float> (fftSize) / juce::MathConstants<float>::twoPi;
+    const auto column = static_cast<long long> (framesProcessed);
+    for (int k = 1; k < numFftBins - 1; ++k)
+    {
+        const auto idx = static_cast<size_t> (k);
+        const float p = power[idx];
+        if (p < powerFloor)
+            continue;
+
+        const float inverse = 1.0f / p;
+        const float binShift = frequencyOffset[idx] * inverse * radiansToBins;
+        if (std::abs (binShift) > kMaxFrequencyReassignmentBins)
+            continue;
+
+        const float reassignedBin = static_cast<float> (k) - binShift;
+        if (reassignedBin <= lowestBin * 0.5f)
+            continue;
+
+        const int bin = static_cast<int> (std::lround (std::log (reassignedBin / lowestBin) * binsPerLogFftBin));
+        if (bin < 0 || bin >= numBins)
+            continue;
+
+        const float columnShift = timeOffset[idx] * inverse / static_cast<float> (hopSize);
+        const long long target = column + juce::jlimit (-latencyColumns, latencyColumns, static_cast<int> (std::lround (columnShift)));
+        if (target < 0)
+            continue;
+
+        pending[static_cast<size_t> (target % numPendingColumns)][static_cast<size_t> (bin)] += p;
+    }
+}
+
+void ReassignedSpectrogram::publishColumn (int pendingSlot) noexcept
+{
+    auto& column = pending[static_cast<size_t> (pendingSlot)];
+    const float scale = activeMode == Mode::reassigned ? reassignedPowerScale : powerScale;
+    const auto index = numPublished.load (std::memory_order_relaxed);
+    const auto offset = static_cast<size_t> (index % static_cast<std::uint64_t> (numColumns)) * static_cast<size_t> (numBins);
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        const float scaled = column[idx] * scale;
+        const float dB = scaled > 1.0e-30f ? 10.0f * std::log10 (scaled) : -300.0f;
+        published[offset + idx].store (juce::jlimit (0.0f, 1.0f, juce::jmap (dB, kFloorDb, 0.0f, 0.0f, 1.0f)),
+                                       std::memory_order_relaxed);
+    }
+
+    column.fill (0.0f);
+    numPublished.store (index + 1, std::memory_order_release);
+}
+
+int ReassignedSpectrogram::read (std::uint64_t& nextColumn, std::vector<float>& out) const
+{
+    const auto total = numPublished.load (std::memory_order_acquire);
+    const auto oldest = total > static_cast<std::uint64_t> (numColumns) ? total - static_cast<std::uint64_t> (numColumns) : 0;
+    const auto first = juce::jlimit (oldest, total, nextColumn);
+    const int count = static_cast<int> (total - first);
+
+    out.resize (static_cast<size_t> (count) * static_cast<size_t> (numBins));
+    for (int c = 0; c < count; ++c)
+    {
+        const auto offset = static_cast<size_t> ((first + static_cast<std::uint64_t> (c)) % static_cast<std::uint64_t> (numColumns)) * static_cast<size_t> (numBins);
+        for (int i = 0; i < numBins; ++i)
+            out[static_cast<size_t> (c * numBins + i)] = published[offset + static_cast<size_t> (i)].load (std::memory_order_relaxed);
+    }
+
+    nextColumn = total;
+    return count;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "RealFftBatch.h"
+#include "SharedDspTables.h"
+
+// Scrolling spectrogram of the analysis stream on the same log-frequency axis as the spectrum
+// trace. In reassigned mode every frame is also transformed with the time-ramped and the
+// differentiated window, and each bin's energy is moved to its instantaneous frequency
+//   f^ = k - Im (X_dh conj X_h) / |X_h|^2 * N / 2 pi   (bins)
+// and group delay
+//   t^ = Re (X_th conj X_h) / |X_h|^2                   (samples from the frame centre),
+// which sharpens partials and onsets well beyond the window's own resolution. Energy can land
+// up to half a window either side of its frame, so columns are published half a window late.
+class ReassignedSpectrogram
+{
+public:
+    enum class Mode
+    {
+        off = 0,
+        standard,
+        reassigned
+    };
+
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = 256;
+    static constexpr int numBins = 256;
+    static constexpr int numColumns = 384;
+
+    ReassignedSpectrogram();
+
+    // Worker thread, or any thread while the worker is stopped.
+    void prepare (double sampleRate);
+    void reset() noexcept;
+    void process (const float* input, int numSamples) noexcept;
+
+    // Any thread.
+    void setMode (Mode newMode) noexcept { requestedMode.store (static_cast<int> (newMode), std::memory_order_relaxed); }
+    Mode getMode() const noexcept { return static_cast<Mode> (requestedMode.load (std::memory_order_relaxed)); }
+
+    // Any thread. Copies the columns published since nextColumn, oldest first with numBins
+    // normalised (0 = -96 dBFS, 1 = 0 dBFS) values each, advances nextColumn and returns the
+    // number of columns copied. Columns that were already overwritten are skipped.
+    int read (std::uint64_t& nextColumn, std::vector<float>& out) const;
+
+private:
+    static constexpr int latencyColumns = fftSize / (2 * hopSize);
+    static constexpr int numPendingColumns = (2 * latencyColumns) + 1;
+    static constexpr int numFftBins = (fftSize / 2) + 1;
+
+    void processFrame() noexcept;
+    void accumulateStandard (int pendingSlot) noexcept;
+    void accumulateReassigned() noexcept;
+    void publishColumn (int pendingSlot) noexcept;
+
+    RealFftBatch fft { fftOrder };
+    std::shared_ptr<const SharedDspTables::Window> window;
+    std::shared_ptr<const SharedDspTables::Window> timeRampedWindow;
+    std::shared_ptr<const SharedDspTables::Window> derivativeWindow;
+    std::array<float, fftSize> frame {};
+    std::array<float, fftSize> windowed {};
+    std::array<float, fftSize> windowedDerivative {};
+    int frameFill = 0;
+
+    std::array<RealFftBatch::Complex, numFftBins> spectrum {};
+    std::array<RealFftBatch::Complex, numFftBins> timeRampedSpectrum {};
+    std::array<RealFftBatch::Complex, numFftBins> derivativeSpectrum {};
+
+    // Split real / imaginary parts of the three spectra, so the per-bin products vectorise.
+    std::array<float, numFftBins> re {}, im {};
+    std::array<float, numFftBins> timeRampedRe {}, timeRampedIm {};
+    std::array<float, numFftBins> derivativeRe {}, derivativeIm {};
+    std::array<float, numFftBins> power {};
+    std::array<float, numFftBins> frequencyOffset {};
+    std::array<float, numFftBins> timeOffset {};
+
+    // Per display bin, the FFT bins it covers (standard mode) and the log-frequency mapping.
+    std::array<int, numBins> firstFftBin {};
+    std::array<int, numBins> lastFftBin {};
+    std::array<float, numBins> fractionalFftBin {};
+    float lowestBin = 1.0f;
+    float binsPerLogFftBin = 1.0f;
+
+    float powerFloor = 0.0f;
+    float powerScale = 1.0f;
+    float reassignedPowerScale = 1.0f;
+
+    std::array<std::array<float, numBins>, numPendingColumns> pending {};
+    std::uint64_t framesProcessed = 0;
+    Mode activeMode = Mode::off;
+
+    std::atomic<int> requestedMode { static_cast<int> (Mode::off) };
+    std::array<std::atomic<float>, numBins * numColumns> published {};
+    std::atomic<std::uint64_t> numPublished { 0 };
+};
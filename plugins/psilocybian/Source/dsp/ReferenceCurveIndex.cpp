@@ -0,0 +1,216 @@
+#include "ReferenceCurveIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr double kDisplayRangeDb = 96.0;
+// The covariance only has to find the dominant shapes; a strided sample of a large library
+// finds the same ones at a fraction of the cost.
+constexpr int kMaxTrainingCurves = 2048;
+constexpr int kSubspaceIterations = 30;
+} // namespace
+
+void ReferenceCurveIndex::removeLevel (const Curve& curve, std::array<double, numPoints>& shape) const noexcept
+{
+    double level = 0.0;
+    for (int i = 0; i < numPoints; ++i)
+    {
+        shape[static_cast<size_t> (i)] = static_cast<double> (curve[static_cast<size_t> (i)]) * kDisplayRangeDb;
+        level += shape[static_cast<size_t> (i)];
+    }
+
+    level /= static_cast<double> (numPoints);
+    for (auto& value : shape)
+        value -= level;
+}
+
+void ReferenceCurveIndex::project (const std::array<double, numPoints>& shape, Register* out) const noexcept
+{
+    for (int r = 0; r < registersPerCurve; ++r)
+        out[r] = Register::expand (0.0f);
+
+    for (int c = 0; c < numComponents; ++c)
+    {
+        const auto& component = components[static_cast<size_t> (c)];
+        double sum = 0.0;
+        for (int i = 0; i < numPoints; ++i)
+            sum += (shape[static_cast<size_t> (i)] - mean[static_cast<size_t> (i)]) * component[static_cast<size_t> (i)];
+
+        out[c / static_cast<int> (Register::size())].set (static_cast<size_t> (c) % Register::size(), static_cast<float> (sum));
+    }
+}
+
+void ReferenceCurveIndex::build (const std::vector<Curve>& curves)
+{
+    numCurves = static_cast<int> (curves.size());
+    mean.fill (0.0);
+
+    std::vector<std::array<double, numPoints>> shapes (curves.size());
+    for (size_t n = 0; n < curves.size(); ++n)
+    {
+        removeLevel (curves[n], shapes[n]);
+        for (int i = 0; i < numPoints; ++i)
+            mean[static_cast<size_t> (i)] += shapes[n][static_cast<size_t> (i)];
+    }
+
+    if (numCurves > 0)
+        for (auto& value : mean)
+            value /= static_cast<double> (numCurves);
+
+    // Covariance of a strided sample, upper triangle mirrored.
+    std::vector<double> covariance (static_cast<size_t> (numPoints * numPoints), 0.0);
+    const int stride = juce::jmax (1, numCurves / kMaxTrainingCurves);
+    std::array<double, numPoints> centred {};
+    for (int n = 0; n < numCurves; n += stride)
+    {
+        for (int i = 0; i < numPoints; ++i)
+            centred[static_cast<size_t> (i)] = shapes[static_cast<size_t> (n)][static_cast<size_t> (i)] - mean[static_cast<size_t> (i)];
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const double ci = centred[static_cast<size_t> (i)];
+            double* row = covariance.data() + static_cast<size_t> (i * numPoints);
+            for (int j = i; j < numPoints; ++j)
+                row[j] += ci * centred[static_cast<size_t> (j)];
+        }
+    }
+
+    for (int i = 0; i < numPoints; ++i)
+        for (int j = 0; j < i; ++j)
+            covariance[static_cast<size_t> (i * numPoints + j)] = covariance[static_cast<size_t> (j * numPoints + i)];
+
+    // Subspace iteration for the leading eigenvectors, started from cosine shapes, which are
+    // already close to the principal components of smooth spectra.
+    components.assign (static_cast<size_t> (numComponents), {});
+    for (int c = 0; c < numComponents; ++c)
+        for (int i = 0; i < numPoints; ++i)
+            components[static_cast<size_t> (c)][static_cast<size_t> (i)]
+                = std::cos (juce::MathConstants<double>::pi * static_cast<double> (c + 1) * (static_cast<double> (i) + 0.5) / static_cast<double> (numPoints));
+
+    auto orthonormalise = [this] (std::vector<std::array<double, numPoints>>& vectors)
+    {
+        for (int c = 0; c < numComponents; ++c)
+        {
+            auto& v = vectors[static_cast<size_t> (c)];
+            for (int p = 0; p < c; ++p)
+            {
+                const auto& u = components[static_cast<size_t> (p)];
+                double dot = 0.0;
+                for (int i = 0; i < numPoints; ++i)
+                    dot += v[static_cast<size_t> (i)] * u[static_cast<size_t> (i)];
+                for (int i = 0; i < numPoints; ++i)
+                    v[static_cast<size_t> (i)] -= dot * u[static_cast<size_t> (i)];
+            }
+
+            double norm = 0.0;
+            for (const auto value : v)
+                norm += value * value;
+
+            // A library with fewer distinct shapes than components leaves the rest unconstrained;
+            // keep the previous direction for those.
+            if (norm > 1.0e-18)
+            {
+                const double scale = 1.0 / std::sqrt (norm);
+                for (int i = 0; i < numPoints; ++i)
+                    components[static_cast<size_t> (c)][static_cast<size_t> (i)] = v[static_cast<size_t> (i)] * scale;
+            }
+        }
+    };
+
+    std::vector<std::array<double, numPoints>> next (static_cast<size_t> (numComponents));
+    next = components;
+    orthonormalise (next);
+    for (int iteration = 0; iteration < kSubspaceIterations; ++iteration)
+    {
+        for (int c = 0; c < numComponents; ++c)
+        {
+            const auto& v = components[static_cast<size_t> (c)];
+            auto& out = next[static_cast<size_t> (c)];
+            for (int i = 0; i < numPoints; ++i)
+            {
+                const double* row = covariance.data() + static_cast<size_t> (i * numPoints);
+                double sum = 0.0;
+                for (int j = 0; j < numPoints; ++j)
+                    sum += row[j] * v[static_cast<size_t> (j)];
+                out[static_cast<size_t> (i)] = sum;
+            }
+        }
+
+        orthonormalise (next);
+    }
+
+    coordinates.assign (static_cast<size_t> (numCurves * registersPerCurve), Register::expand (0.0f));
+    squaredNorms.assign (static_cast<size_t> (numCurves), 0.0f);
+    residuals.assign (static_cast<size_t> (numCurves), 0.0f);
+    for (int n = 0; n < numCurves; ++n)
+    {
+        const auto& shape = shapes[static_cast<size_t> (n)];
+        Register* x = coordinates.data() + static_cast<size_t> (n * registersPerCurve);
+        project (shape, x);
+
+        double total = 0.0;
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const double d = shape[static_cast<size_t> (i)] - mean[static_cast<size_t> (i)];
+            total += d * d;
+        }
+
+        float projected = 0.0f;
+        for (int r = 0; r < registersPerCurve; ++r)
+            projected += (x[r] * x[r]).sum();
+
+        squaredNorms[static_cast<size_t> (n)] = projected;
+        residuals[static_cast<size_t> (n)] = static_cast<float> (std::sqrt (juce::jmax (0.0, total - static_cast<double> (projected))));
+    }
+}
+
+void ReferenceCurveIndex::findNearest (const Curve& query, int maxMatches, std::vector<Match>& matches) const
+{
+    matches.clear();
+    if (numCurves == 0 || maxMatches <= 0)
+        return;
+
+    std::array<double, numPoints> shape {};
+    removeLevel (query, shape);
+
+    std::array<Register, registersPerCurve> q {};
+    project (shape, q.data());
+
+    double total = 0.0;
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const double d = shape[static_cast<size_t> (i)] - mean[static_cast<size_t> (i)];
+        total += d * d;
+    }
+
+    float queryNorm = 0.0f;
+    for (const auto& r : q)
+        queryNorm += (r * r).sum();
+    const float queryResidual = static_cast<float> (std::sqrt (juce::jmax (0.0, total - static_cast<double> (queryNorm))));
+
+    // |q - x|^2 = |q|^2 + |x|^2 - 2 q.x in the component space, plus the closest the two
+    // residuals could be.
+    std::vector<Match> all (static_cast<size_t> (numCurves));
+    for (int n = 0; n < numCurves; ++n)
+    {
+        const Register* x = coordinates.data() + static_cast<size_t> (n * registersPerCurve);
+        Register dot = Register::expand (0.0f);
+        for (int r = 0; r < registersPerCurve; ++r)
+            dot = Register::multiplyAdd (dot, q[static_cast<size_t> (r)], x[r]);
+
+        const float residualGap = queryResidual - residuals[static_cast<size_t> (n)];
+        const float squared = juce::jmax (0.0f, queryNorm + squaredNorms[static_cast<size_t> (n)] - 2.0f * dot.sum())
+                              + residualGap * residualGap;
+        all[static_cast<size_t> (n)] = { n, squared };
+    }
+
+    const int count = juce::jmin (maxMatches, numCurves);
+    std::partial_sort (all.begin(), all.begin() + count, all.end(),
+                       [] (const Match& a, const Match& b) { return a.distanceDb < b.distanceDb; });
+
+    matches.assign (all.begin(), all.begin() + count);
+    for (auto& match : matches)
+        match.distanceDb = std::sqrt (match.distanceDb / static_cast<float> (numPoints));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+// Nearest-neighbour search over 256-point reference curves by spectral shape. Each curve has
+// its own mean level removed, so only the tilt and contour are compared. The library mean is
+// subtracted and the curves are projected onto their leading principal components, which keep
+// practically all of the variance of smooth long-term spectra; a query is then one projection
+// plus a few SIMD dot products per stored curve.
+class ReferenceCurveIndex
+{
+public:
+    static constexpr int numPoints = 256;
+    static constexpr int numComponents = 16;
+    using Curve = std::array<float, numPoints>;
+
+    struct Match
+    {
+        int index = -1;
+        // RMS difference of the mean-removed shapes over the display range, in dB.
+        float distanceDb = 0.0f;
+    };
+
+    // Message thread. Curves hold normalised display values (0 = -96 dBFS, 1 = 0 dBFS).
+    void build (const std::vector<Curve>& curves);
+    int getNumCurves() const noexcept { return numCurves; }
+
+    // Message thread. Fills matches with up to maxMatches nearest curves, closest first.
+    void findNearest (const Curve& query, int maxMatches, std::vector<Match>& matches) const;
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+    static constexpr int registersPerCurve = (numComponents + static_cast<int> (Register::size()) - 1) / static_cast<int> (Register::size());
+
+    void removeLevel (const Curve& curve, std::array<double, numPoints>& shape) const noexcept;
+    void project (const std::array<double, numPoints>& shape, Register* out) const noexcept;
+
+    int numCurves = 0;
+    std::array<double, numPoints> mean {};
+    std::vector<std::array<double, numPoints>> components;
+    std::vector<Register> coordinates;
+    std::vector<float> squaredNorms;
+    // The part of each shape the components do not capture, so distances stay exact enough to
+    // rank curves that only differ outside the leading components.
+    std::vector<float> residuals;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+// Single-producer/single-consumer sample queue. The producer never blocks or allocates;
+// samples that do not fit are dropped and counted so the consumer can resynchronise.
+class SampleFifo
+{
+public:
+    explicit SampleFifo (int capacity)
+        : fifo (capacity + 1),
+          buffer (static_cast<size_t> (capacity + 1), 0.0f)
+    {
+    }
+
+    // Only call while neither side is running.
+    void reset() noexcept
+    {
+        fifo.reset();
+        droppedSamples.store (0, std::memory_order_relaxed);
+    }
+
+    // Only call while neither side is running. Empties the queue.
+    void setCapacity (int capacity)
+    {
+        buffer.assign (static_cast<size_t> (capacity + 1), 0.0f);
+        buffer.shrink_to_fit();
+        fifo.setTotalSize (capacity + 1);
+        reset();
+    }
+
+    int push (const float* samples, int numSamples) noexcept
+    {
+        const auto scope = fifo.write (numSamples);
+        copyIn (samples, scope.startIndex1, scope.blockSize1);
+        copyIn (samples + scope.blockSize1, scope.startIndex2, scope.blockSize2);
+
+        const int written = scope.blockSize1 + scope.blockSize2;
+        if (written < numSamples)
+            droppedSamples.fetch_add (numSamples - written, std::memory_order_relaxed);
+        return written;
+    }
+
+    int pop (float* destination, int maxSamples) noexcept
+    {
+        const auto scope = fifo.read (maxSamples);
+        copyOut (destination, scope.startIndex1, scope.blockSize1);
+        copyOut (destination + scope.blockSize1, scope.startIndex2, scope.blockSize2);
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    int getNumReady() const noexcept { return fifo.getNumReady(); }
+    int getFreeSpace() const noexcept { return fifo.getFreeSpace(); }
+    int takeDroppedSampleCount() noexcept { return droppedSamples.exchange (0, std::memory_order_relaxed); }
+
+private:
+    void copyIn (const float* source, int start, int count) noexcept
+    {
+        if (count > 0)
+            std::copy (source, source + count, buffer.begin() + start);
+    }
+
+    void copyOut (float* destination, int start, int count) const noexcept
+    {
+        if (count > 0)
+            std::copy (buffer.begin() + start, buffer.begin() + start + count, destination);
+    }
+
+    juce::AbstractFifo fifo;
+    std::vector<float> buffer;
+    std::atomic<int> droppedSamples { 0 };
+};
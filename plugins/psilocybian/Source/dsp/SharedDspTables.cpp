@@ -0,0 +1,131 @@
+#include "SharedDspTables.h"
+
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include <juce_core/juce_core.h>
+
+namespace
+{
+constexpr float kMinFrequencyHz = 20.0f;
+constexpr float kMaxFrequencyHz = 20000.0f;
+
+enum class TableType
+{
+    window,
+    displayAxis
+};
+
+struct Key
+{
+    TableType type = TableType::window;
+    int variant = 0;
+    int size = 0;
+    double sampleRate = 0.0;
+
+    bool operator< (const Key& other) const noexcept
+    {
+        return std::tie (type, variant, size, sampleRate) < std::tie (other.type, other.variant, other.size, other.sampleRate);
+    }
+};
+
+struct Cache
+{
+    std::mutex lock;
+    std::map<Key, std::weak_ptr<const void>> tables;
+};
+
+Cache& getCache()
+{
+    static Cache cache;
+    return cache;
+}
+
+template <typename Table, typename Builder>
+std::shared_ptr<const Table> findOrBuild (const Key& key, Builder&& build)
+{
+    auto& cache = getCache();
+    const std::scoped_lock lock (cache.lock);
+    if (auto existing = cache.tables[key].lock())
+        return std::static_pointer_cast<const Table> (existing);
+
+    // Forget tables whose last user has gone while the lock is held anyway.
+    for (auto it = cache.tables.begin(); it != cache.tables.end();)
+        it = it->second.expired() ? cache.tables.erase (it) : std::next (it);
+
+    auto table = std::make_shared<Table>();
+    build (*table);
+    cache.tables[key] = table;
+    return table;
+}
+} // namespace
+
+std::shared_ptr<const SharedDspTables::Window> SharedDspTables::getWindow (WindowKind kind, int size)
+{
+    size = juce::jmax (2, size);
+    return findOrBuild<Window> ({ TableType::window, static_cast<int> (kind), size, 0.0 }, [kind, size] (Window& window)
+    {
+        const double twoPi = juce::MathConstants<double>::twoPi;
+        const double period = static_cast<double> (size - 1);
+        std::vector<double> hann (static_cast<size_t> (size));
+        double hannSum = 0.0;
+        for (int n = 0; n < size; ++n)
+        {
+            hann[static_cast<size_t> (n)] = 0.5 - 0.5 * std::cos (twoPi * static_cast<double> (n) / period);
+            hannSum += hann[static_cast<size_t> (n)];
+        }
+
+        const double normalisation = static_cast<double> (size) / hannSum;
+        window.values.resize (static_cast<size_t> (size));
+        for (int n = 0; n < size; ++n)
+        {
+            const auto idx = static_cast<size_t> (n);
+            double value = hann[idx];
+            if (kind == WindowKind::hannTimeRamped)
+                value *= static_cast<double> (n) - 0.5 * period;
+            else if (kind == WindowKind::hannDerivative)
+                value = juce::MathConstants<double>::pi / period * std::sin (twoPi * static_cast<double> (n) / period);
+
+            window.values[idx] = static_cast<float> (value * normalisation);
+            window.sum += value * normalisation;
+            window.sumOfSquares += (value * normalisation) * (value * normalisation);
+        }
+
+        window.magnitudeScale = static_cast<float> (2.0 / (hannSum * normalisation));
+    });
+}
+
+template <int numPoints>
+std::shared_ptr<const SharedDspTables::DisplayAxis<numPoints>> SharedDspTables::getDisplayAxis (double sampleRate, int fftSize)
+{
+    const Key key { TableType::displayAxis, numPoints, fftSize, sampleRate };
+    return findOrBuild<DisplayAxis<numPoints>> (key, [sampleRate, fftSize] (DisplayAxis<numPoints>& axis)
+    {
+        const float nyquist = static_cast<float> (sampleRate * 0.5);
+        const float maxFreq = juce::jlimit (kMinFrequencyHz + 1.0f, nyquist, kMaxFrequencyHz);
+        const float ratio = maxFreq / kMinFrequencyHz;
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const float t = static_cast<float> (i) / static_cast<float> (numPoints - 1);
+            axis.frequencyHz[static_cast<size_t> (i)] = kMinFrequencyHz * std::pow (ratio, t);
+        }
+
+        const double binWidthHz = sampleRate / static_cast<double> (fftSize);
+        for (size_t f = 0; f < FractionalOctaveSmoother::standardFractions.size(); ++f)
+        {
+            FractionalOctaveSmoother::computeBands (axis.frequencyHz.data(),
+                                                    numPoints,
+                                                    binWidthHz,
+                                                    1.0 / static_cast<double> (FractionalOctaveSmoother::standardFractions[f]),
+                                                    (fftSize / 2) + 1,
+                                                    axis.bands[f].data());
+        }
+    });
+}
+
+template std::shared_ptr<const SharedDspTables::DisplayAxis<256>> SharedDspTables::getDisplayAxis<256> (double, int);
+template std::shared_ptr<const SharedDspTables::DisplayAxis<512>> SharedDspTables::getDisplayAxis<512> (double, int);
+template std::shared_ptr<const SharedDspTables::DisplayAxis<1024>> SharedDspTables::getDisplayAxis<1024> (double, int);
+template std::shared_ptr<const SharedDspTables::DisplayAxis<2048>> SharedDspTables::getDisplayAxis<2048> (double, int);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "FractionalOctaveSmoother.h"
+
+// Process-wide cache of immutable lookup tables. Every plugin instance in a session asks for
+// the same windows and display axes, so each table is built once per (kind, size, sample rate)
+// and handed out as a shared pointer to const; it is freed when the last instance lets go.
+// Lookups lock, so only request tables outside the audio callback, and keep the pointer.
+class SharedDspTables
+{
+public:
+    enum class WindowKind
+    {
+        hann = 0,         // as juce::dsp::WindowingFunction<float>::hann, normalised to a sum of size
+        hannTimeRamped,   // (n - centre) * hann, for reassignment
+        hannDerivative    // d hann / dn, for reassignment
+    };
+
+    struct Window
+    {
+        std::vector<float> values;
+        double sum = 0.0;
+        double sumOfSquares = 0.0;
+        // Converts an FFT magnitude of a Hann-windowed frame to the amplitude of a sine. Only
+        // meaningful for WindowKind::hann; the others share its scaling.
+        float magnitudeScale = 1.0f;
+    };
+
+    // numPoints centres from 20 Hz to min (20 kHz, Nyquist), with smoothing bands over an
+    // fftSize spectrum for every FractionalOctaveSmoother::standardFractions entry.
+    template <int numPoints>
+    struct DisplayAxis
+    {
+        std::array<float, numPoints> frequencyHz {};
+        std::array<std::array<FractionalOctaveSmoother::Band, numPoints>,
+                   FractionalOctaveSmoother::standardFractions.size()> bands {};
+    };
+
+    static std::shared_ptr<const Window> getWindow (WindowKind kind, int size);
+
+    template <int numPoints>
+    static std::shared_ptr<const DisplayAxis<numPoints>> getDisplayAxis (double sampleRate, int fftSize);
+};
+
+extern template std::shared_ptr<const SharedDspTables::DisplayAxis<256>> SharedDspTables::getDisplayAxis<256> (double, int);
+extern template std::shared_ptr<const SharedDspTables::DisplayAxis<512>> SharedDspTables::getDisplayAxis<512> (double, int);
+extern template std::shared_ptr<const SharedDspTables::DisplayAxis<1024>> SharedDspTables::getDisplayAxis<1024> (double, int);
+extern template std::shared_ptr<const SharedDspTables::DisplayAxis<2048>> SharedDspTables::getDisplayAxis<2048> (double, int);
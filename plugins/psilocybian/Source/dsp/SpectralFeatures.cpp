@@ -0,0 +1,123 @@
+#include "SpectralFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <juce_core/juce_core.h>
+
+namespace
+{
+// Below this total the frame is treated as silence and every feature reads 0.
+constexpr double kSilentPower = 1.0e-12;
+constexpr double kPowerFloor = 1.0e-20;
+} // namespace
+
+void SpectralFeatures::prepare (double sampleRate, int fftSize)
+{
+    numBins = fftSize / 2 + 1;
+    binHz = sampleRate / static_cast<double> (fftSize);
+    magnitude.assign (static_cast<size_t> (numBins), 0.0f);
+    previousMagnitude.assign (static_cast<size_t> (numBins), 0.0f);
+    pitchClass.assign (static_cast<size_t> (numBins), -1);
+
+    for (int k = 1; k < numBins; ++k)
+    {
+        const double frequency = static_cast<double> (k) * binHz;
+        if (frequency < minChromaHz || frequency > maxChromaHz)
+            continue;
+
+        // A4 = 440 Hz is pitch class 9 counted from C.
+        const auto semitones = static_cast<int> (std::lround (12.0 * std::log2 (frequency / 440.0)));
+        pitchClass[static_cast<size_t> (k)] = ((semitones + 9) % numChroma + numChroma) % numChroma;
+    }
+
+    reset();
+}
+
+void SpectralFeatures::reset() noexcept
+{
+    hasPrevious = false;
+    std::fill (previousMagnitude.begin(), previousMagnitude.end(), 0.0f);
+    publish (Values {});
+    publishedSequence.store (0, std::memory_order_release);
+}
+
+void SpectralFeatures::process (const float* linearPower) noexcept
+{
+    // DC carries no pitch or brightness; it is left out of every feature.
+    double total = 0.0;
+    double weighted = 0.0;
+    double logSum = 0.0;
+    double magnitudeTotal = 0.0;
+    double rise = 0.0;
+    std::array<double, numChroma> chroma {};
+
+    for (int k = 1; k < numBins; ++k)
+    {
+        const auto index = static_cast<size_t> (k);
+        const double power = static_cast<double> (linearPower[k]);
+        total += power;
+        weighted += power * static_cast<double> (k);
+        logSum += std::log (power + kPowerFloor);
+
+        magnitude[index] = static_cast<float> (std::sqrt (power));
+        magnitudeTotal += static_cast<double> (magnitude[index]);
+        rise += static_cast<double> (juce::jmax (0.0f, magnitude[index] - previousMagnitude[index]));
+
+        if (pitchClass[index] >= 0)
+            chroma[static_cast<size_t> (pitchClass[index])] += power;
+    }
+
+    Values values;
+    if (total > kSilentPower)
+    {
+        const double numUsed = static_cast<double> (numBins - 1);
+        values.centroidHz = static_cast<float> (weighted / total * binHz);
+        values.flatness = static_cast<float> (juce::jlimit (0.0, 1.0, std::exp (logSum / numUsed) / (total / numUsed)));
+        values.flux = hasPrevious ? static_cast<float> (juce::jlimit (0.0, 1.0, rise / magnitudeTotal)) : 0.0f;
+
+        const double rolloffTarget = static_cast<double> (rolloffFraction) * total;
+        double running = 0.0;
+        for (int k = 1; k < numBins; ++k)
+        {
+            running += static_cast<double> (linearPower[k]);
+            if (running >= rolloffTarget)
+            {
+                values.rolloffHz = static_cast<float> (static_cast<double> (k) * binHz);
+                break;
+            }
+        }
+
+        const double chromaPeak = *std::max_element (chroma.begin(), chroma.end());
+        if (chromaPeak > kPowerFloor)
+            for (size_t c = 0; c < chroma.size(); ++c)
+                values.chroma[c] = static_cast<float> (chroma[c] / chromaPeak);
+    }
+
+    std::swap (magnitude, previousMagnitude);
+    hasPrevious = true;
+    publish (values);
+}
+
+void SpectralFeatures::publish (const Values& values) noexcept
+{
+    published[0].store (values.centroidHz, std::memory_order_relaxed);
+    published[1].store (values.rolloffHz, std::memory_order_relaxed);
+    published[2].store (values.flatness, std::memory_order_relaxed);
+    published[3].store (values.flux, std::memory_order_relaxed);
+    for (int c = 0; c < numChroma; ++c)
+        published[static_cast<size_t> (4 + c)].store (values.chroma[static_cast<size_t> (c)], std::memory_order_relaxed);
+    publishedSequence.fetch_add (1, std::memory_order_release);
+}
+
+std::uint32_t SpectralFeatures::read (Values& out) const noexcept
+{
+    const auto sequence = publishedSequence.load (std::memory_order_acquire);
+    out.centroidHz = published[0].load (std::memory_order_relaxed);
+    out.rolloffHz = published[1].load (std::memory_order_relaxed);
+    out.flatness = published[2].load (std::memory_order_relaxed);
+    out.flux = published[3].load (std::memory_order_relaxed);
+    for (int c = 0; c < numChroma; ++c)
+        out.chroma[static_cast<size_t> (c)] = published[static_cast<size_t> (4 + c)].load (std::memory_order_relaxed);
+    return sequence;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Frame descriptors of the linear power spectrum the analyzer already computes, so no second
+// transform is needed: spectral centroid, the rolloff below which rolloffFraction of the power
+// lies, flatness (geometric over arithmetic mean power: 0 for a pure tone, about 0.56 for one
+// frame of white noise, whose periodogram scatters around its mean), flux (positive magnitude
+// change since the previous frame over the current total, 0 for a steady signal) and a 12-bin
+// chroma vector (C first, peak normalised to 1) over minChromaHz..maxChromaHz. Below about
+// 400 Hz a 2048-point bin is wider than a semitone, so the lowest chroma octave is coarse.
+// Storage is sized in prepare(), so process() never allocates.
+class SpectralFeatures
+{
+public:
+    static constexpr int numChroma = 12;
+    static constexpr int numValues = 4 + numChroma;
+    static constexpr float rolloffFraction = 0.85f;
+    static constexpr float minChromaHz = 220.0f;
+    static constexpr float maxChromaHz = 5000.0f;
+
+    struct Values
+    {
+        float centroidHz = 0.0f;
+        float rolloffHz = 0.0f;
+        float flatness = 0.0f;
+        float flux = 0.0f;
+        std::array<float, numChroma> chroma {};
+    };
+
+    // Message thread, audio stopped.
+    void prepare (double sampleRate, int fftSize);
+
+    // Consumer thread (the analysis worker, or the caller while the worker is stopped).
+    void reset() noexcept;
+    void process (const float* linearPower) noexcept;
+    int getNumBins() const noexcept { return numBins; }
+
+    // Any thread. Copies the latest values and returns a sequence number that changes with
+    // every frame (0 until the first).
+    std::uint32_t read (Values& out) const noexcept;
+
+private:
+    void publish (const Values& values) noexcept;
+
+    int numBins = 0;
+    double binHz = 0.0;
+    bool hasPrevious = false;
+    std::vector<float> magnitude;
+    std::vector<float> previousMagnitude;
+    // Pitch class per bin, -1 outside the chroma range.
+    std::vector<int> pitchClass;
+
+    std::array<std::atomic<float>, numValues> published {};
+    std::atomic<std::uint32_t> publishedSequence { 0 };
+};
@@ -0,0 +1,163 @@
+#include "SpectralPeakTracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <juce_core/juce_core.h>
+
+namespace
+{
+constexpr float kFloorDb = -90.0f;
+// Bins k +- 3 lie outside a Hann window's main lobe, so a stable partial clears them easily
+// while a noise maximum rarely does.
+constexpr int kProminenceOffset = 3;
+constexpr float kMinProminence = 4.0f; // power ratio, about 6 dB
+constexpr float kMaxDriftRatio = 0.03f; // about half a semitone per frame
+constexpr float kMinDriftBins = 1.0f;
+constexpr float kFrequencyFollow = 0.5f;
+constexpr int kConfirmFrames = 3;
+constexpr int kHoldFrames = 3;
+
+float powerToDb (float power, float dbOffset) noexcept
+{
+    return power > 1.0e-30f ? 10.0f * std::log10 (power) + dbOffset : -300.0f;
+}
+} // namespace
+
+bool SpectralPeakTracker::Track::isConfirmed() const noexcept
+{
+    return id >= 0 && age >= kConfirmFrames;
+}
+
+void SpectralPeakTracker::prepare (double sampleRate, int fftSize) noexcept
+{
+    binWidthHz = sampleRate / static_cast<double> (juce::jmax (1, fftSize));
+    reset();
+}
+
+void SpectralPeakTracker::reset() noexcept
+{
+    for (auto& track : tracks)
+        track = {};
+    numPeaks = 0;
+}
+
+void SpectralPeakTracker::findPeaks (const float* linearPower, int numBins, float magnitudeScale) noexcept
+{
+    numPeaks = 0;
+    const float dbOffset = 20.0f * std::log10 (juce::jmax (1.0e-20f, magnitudeScale));
+    int weakest = 0;
+
+    for (int k = kProminenceOffset; k < numBins - kProminenceOffset; ++k)
+    {
+        const float p = linearPower[k];
+        if (p <= linearPower[k - 1] || p < linearPower[k + 1])
+            continue;
+        if (p < kMinProminence * 0.5f * (linearPower[k - kProminenceOffset] + linearPower[k + kProminenceOffset]))
+            continue;
+
+        const float b = powerToDb (p, dbOffset);
+        if (b < kFloorDb)
+            continue;
+
+        const float a = powerToDb (linearPower[k - 1], dbOffset);
+        const float c = powerToDb (linearPower[k + 1], dbOffset);
+        const float curvature = a - 2.0f * b + c;
+        const float delta = curvature < 0.0f ? juce::jlimit (-0.5f, 0.5f, 0.5f * (a - c) / curvature) : 0.0f;
+
+        Peak peak;
+        peak.frequencyHz = static_cast<float> ((static_cast<double> (k) + static_cast<double> (delta)) * binWidthHz);
+        peak.levelDb = b - 0.25f * (a - c) * delta;
+
+        // Keep the strongest maxPeaks.
+        if (numPeaks < maxPeaks)
+        {
+            peaks[static_cast<size_t> (numPeaks++)] = peak;
+            if (numPeaks == maxPeaks)
+                for (int i = 0; i < numPeaks; ++i)
+                    if (peaks[static_cast<size_t> (i)].levelDb < peaks[static_cast<size_t> (weakest)].levelDb)
+                        weakest = i;
+        }
+        else if (peak.levelDb > peaks[static_cast<size_t> (weakest)].levelDb)
+        {
+            peaks[static_cast<size_t> (weakest)] = peak;
+            for (int i = 0; i < numPeaks; ++i)
+                if (peaks[static_cast<size_t> (i)].levelDb < peaks[static_cast<size_t> (weakest)].levelDb)
+                    weakest = i;
+        }
+    }
+}
+
+void SpectralPeakTracker::process (const float* linearPower, int numBins, float magnitudeScale) noexcept
+{
+    findPeaks (linearPower, numBins, magnitudeScale);
+
+    // Continue existing tracks, loudest first, each with the nearest unclaimed peak in reach.
+    std::array<int, maxTracks> order {};
+    int numActive = 0;
+    for (int t = 0; t < maxTracks; ++t)
+        if (tracks[static_cast<size_t> (t)].isActive())
+            order[static_cast<size_t> (numActive++)] = t;
+
+    std::sort (order.begin(), order.begin() + numActive, [this] (int x, int y)
+    {
+        return tracks[static_cast<size_t> (x)].levelDb > tracks[static_cast<size_t> (y)].levelDb;
+    });
+
+    for (int n = 0; n < numActive; ++n)
+    {
+        auto& track = tracks[static_cast<size_t> (order[static_cast<size_t> (n)])];
+        const float reachHz = juce::jmax (kMinDriftBins * static_cast<float> (binWidthHz), kMaxDriftRatio * track.frequencyHz);
+
+        int best = -1;
+        float bestDistance = std::numeric_limits<float>::max();
+        for (int i = 0; i < numPeaks; ++i)
+        {
+            const auto& peak = peaks[static_cast<size_t> (i)];
+            const float distance = std::abs (peak.frequencyHz - track.frequencyHz);
+            if (! peak.claimed && distance <= reachHz && distance < bestDistance)
+            {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+
+        if (best < 0)
+        {
+            if (++track.missedFrames > kHoldFrames)
+                track = {};
+            continue;
+        }
+
+        auto& peak = peaks[static_cast<size_t> (best)];
+        peak.claimed = true;
+        track.frequencyHz += (peak.frequencyHz - track.frequencyHz) * kFrequencyFollow;
+        track.levelDb = peak.levelDb;
+        track.missedFrames = 0;
+        ++track.age;
+    }
+
+    // Unclaimed peaks start tracks in whatever slots are free, strongest first.
+    std::sort (peaks.begin(), peaks.begin() + numPeaks, [] (const Peak& x, const Peak& y) { return x.levelDb > y.levelDb; });
+    int slot = 0;
+    for (int i = 0; i < numPeaks; ++i)
+    {
+        const auto& peak = peaks[static_cast<size_t> (i)];
+        if (peak.claimed)
+            continue;
+
+        while (slot < maxTracks && tracks[static_cast<size_t> (slot)].isActive())
+            ++slot;
+        if (slot >= maxTracks)
+            break;
+
+        auto& track = tracks[static_cast<size_t> (slot)];
+        track.id = nextTrackId;
+        nextTrackId = nextTrackId < std::numeric_limits<int>::max() ? nextTrackId + 1 : 0;
+        track.frequencyHz = peak.frequencyHz;
+        track.levelDb = peak.levelDb;
+        track.age = 1;
+        track.missedFrames = 0;
+    }
+}
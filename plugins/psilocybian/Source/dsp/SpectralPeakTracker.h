@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+
+// Follows spectral peaks of the analyzer's linear power spectrum from frame to frame. Peaks
+// are local maxima that stand out from the bins either side of the window's main lobe; their
+// frequency and level are refined by a parabola through the log power of the three bins
+// around the maximum. Each frame, tracks claim the nearest peak within a small drift, and
+// unclaimed peaks start new tracks. A track counts as confirmed after a few consecutive
+// frames and survives a few frames without a peak, so short gaps neither drop nor reorder it.
+class SpectralPeakTracker
+{
+public:
+    static constexpr int maxPeaks = 48;
+    static constexpr int maxTracks = 24;
+
+    struct Track
+    {
+        int id = -1; // -1 marks a free slot
+        float frequencyHz = 0.0f;
+        float levelDb = -120.0f;
+        int age = 0;
+        int missedFrames = 0;
+
+        bool isActive() const noexcept { return id >= 0; }
+        bool isConfirmed() const noexcept;
+    };
+
+    // Message thread, audio stopped.
+    void prepare (double sampleRate, int fftSize) noexcept;
+
+    // Audio thread, once per analyzer frame. magnitudeScale converts an FFT magnitude to full scale.
+    void reset() noexcept;
+    void process (const float* linearPower, int numBins, float magnitudeScale) noexcept;
+    const std::array<Track, maxTracks>& getTracks() const noexcept { return tracks; }
+
+private:
+    struct Peak
+    {
+        float frequencyHz = 0.0f;
+        float levelDb = -120.0f;
+        bool claimed = false;
+    };
+
+    void findPeaks (const float* linearPower, int numBins, float magnitudeScale) noexcept;
+
+    std::array<Peak, maxPeaks> peaks {};
+    int numPeaks = 0;
+    std::array<Track, maxTracks> tracks {};
+    int nextTrackId = 0;
+    double binWidthHz = 44100.0 / 2048.0;
+};
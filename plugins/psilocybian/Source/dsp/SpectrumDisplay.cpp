@@ -0,0 +1,131 @@
+#include "SpectrumDisplay.h"
+
+#include <cmath>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace
+{
+constexpr float kFloorDb = -96.0f;
+} // namespace
+
+template <int numBins>
+void SpectrumDisplay<numBins>::prepare (double sampleRate, int fftSize)
+{
+    axis = SharedDspTables::getDisplayAxis<numBins> (sampleRate, fftSize);
+    reset();
+}
+
+template <int numBins>
+void SpectrumDisplay<numBins>::reset() noexcept
+{
+    smoothed.fill (0.0f);
+    for (auto& v : published)
+        v.store (0.0f, std::memory_order_relaxed);
+}
+
+template <int numBins>
+void SpectrumDisplay<numBins>::process (FractionalOctaveSmoother& smoother,
+                                        const float* linearPower,
+                                        size_t smoothingIndex,
+                                        float magnitudeScale) noexcept
+{
+    smoother.process (linearPower, axis->bands[smoothingIndex].data(), numBins, smoothedPower.data());
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        const float scaledMag = std::sqrt (smoothedPower[idx]) * magnitudeScale;
+        const float dB = juce::Decibels::gainToDecibels (scaledMag, -120.0f);
+        const float normalized = juce::jlimit (0.0f, 1.0f, juce::jmap (dB, kFloorDb, 0.0f, 0.0f, 1.0f));
+
+        float& value = smoothed[idx];
+        const float coefficient = normalized >= value ? attackCoefficient : releaseCoefficient;
+        value += (normalized - value) * coefficient;
+        published[idx].store (value, std::memory_order_relaxed);
+    }
+}
+
+template <int numBins>
+void SpectrumDisplay<numBins>::copyPublished (float* dest) const noexcept
+{
+    for (int i = 0; i < numBins; ++i)
+        dest[i] = published[static_cast<size_t> (i)].load (std::memory_order_relaxed);
+}
+
+template class SpectrumDisplay<256>;
+template class SpectrumDisplay<512>;
+template class SpectrumDisplay<1024>;
+template class SpectrumDisplay<2048>;
+
+int SpectrumDisplaySet::getResolutionIndex (int numBins) noexcept
+{
+    for (size_t i = 0; i < resolutions.size(); ++i)
+        if (resolutions[i] == numBins)
+            return static_cast<int> (i);
+    return 0;
+}
+
+void SpectrumDisplaySet::prepare (double sampleRate, int fftSize)
+{
+    base.prepare (sampleRate, fftSize);
+    display512.prepare (sampleRate, fftSize);
+    display1024.prepare (sampleRate, fftSize);
+    display2048.prepare (sampleRate, fftSize);
+}
+
+void SpectrumDisplaySet::reset() noexcept
+{
+    base.reset();
+    display512.reset();
+    display1024.reset();
+    display2048.reset();
+}
+
+void SpectrumDisplaySet::resetResolution (int resolutionIndex) noexcept
+{
+    visitDetail (resolutionIndex, [] (auto& display) { display.reset(); });
+}
+
+void SpectrumDisplaySet::process (FractionalOctaveSmoother& smoother,
+                                  const float* linearPower,
+                                  size_t smoothingIndex,
+                                  float magnitudeScale,
+                                  int resolutionIndex) noexcept
+{
+    base.process (smoother, linearPower, smoothingIndex, magnitudeScale);
+    visitDetail (resolutionIndex, [&] (auto& display)
+    {
+        display.process (smoother, linearPower, smoothingIndex, magnitudeScale);
+    });
+}
+
+void SpectrumDisplaySet::copyPublished (int resolutionIndex, std::vector<float>& dest) const
+{
+    const int index = (resolutionIndex >= 0 && resolutionIndex < static_cast<int> (resolutions.size())) ? resolutionIndex : 0;
+    dest.resize (static_cast<size_t> (resolutions[static_cast<size_t> (index)]));
+
+    switch (index)
+    {
+        case 1: display512.copyPublished (dest.data()); break;
+        case 2: display1024.copyPublished (dest.data()); break;
+        case 3: display2048.copyPublished (dest.data()); break;
+        default: base.copyPublished (dest.data()); break;
+    }
+}
+
+const float* SpectrumDisplaySet::getFrequencies (int resolutionIndex) const noexcept
+{
+    auto frequencies = [] (const auto& display) noexcept -> const float*
+    {
+        return display.isPrepared() ? display.getFrequencies().data() : nullptr;
+    };
+
+    switch (resolutionIndex)
+    {
+        case 1: return frequencies (display512);
+        case 2: return frequencies (display1024);
+        case 3: return frequencies (display2048);
+        default: return frequencies (base);
+    }
+}
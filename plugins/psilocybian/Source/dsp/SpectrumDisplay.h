@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "FractionalOctaveSmoother.h"
+#include "SharedDspTables.h"
+
+// Log-frequency analyzer trace with a compile-time point count: numBins centres from 20 Hz to
+// min (20 kHz, Nyquist), smoothed from the linear power spectrum, mapped to the 0..1 display
+// range over -96..0 dBFS and given attack/release ballistics. All storage is fixed-size and
+// every per-point loop has a constant trip count, so each instantiation is compiled for its
+// own size. The centres and smoothing bands come from SharedDspTables, so instances at the
+// same sample rate share them; prepare() must run before anything else.
+template <int numBins>
+class SpectrumDisplay
+{
+public:
+    static constexpr int size = numBins;
+    static constexpr float attackCoefficient = 0.75f;
+    static constexpr float releaseCoefficient = 0.10f;
+    using Values = std::array<float, numBins>;
+
+    // Message thread, audio stopped.
+    void prepare (double sampleRate, int fftSize);
+
+    // Audio thread. magnitudeScale converts a smoothed FFT magnitude to linear full scale.
+    void reset() noexcept;
+    void process (FractionalOctaveSmoother& smoother,
+                  const float* linearPower,
+                  size_t smoothingIndex,
+                  float magnitudeScale) noexcept;
+    bool isPrepared() const noexcept { return axis != nullptr; }
+    const Values& getFrequencies() const noexcept { return axis->frequencyHz; }
+    const Values& getValues() const noexcept { return smoothed; }
+    const FractionalOctaveSmoother::Band* getBands (size_t smoothingIndex) const noexcept { return axis->bands[smoothingIndex].data(); }
+
+    // Any thread.
+    void copyPublished (float* dest) const noexcept;
+
+private:
+    std::shared_ptr<const SharedDspTables::DisplayAxis<numBins>> axis;
+    Values smoothedPower {};
+    Values smoothed {};
+    std::array<std::atomic<float>, numBins> published {};
+};
+
+extern template class SpectrumDisplay<256>;
+extern template class SpectrumDisplay<512>;
+extern template class SpectrumDisplay<1024>;
+extern template class SpectrumDisplay<2048>;
+
+// The runtime-selectable display resolutions. The 256-point trace is the base resolution that
+// reference curves, presets, the suppressor and the match EQ work at, so it runs every frame;
+// a finer selection adds only its own instantiation on top.
+class SpectrumDisplaySet
+{
+public:
+    static constexpr std::array<int, 4> resolutions { 256, 512, 1024, 2048 };
+    static constexpr int baseBins = resolutions.front();
+    static constexpr int maxBins = resolutions.back();
+    using Base = SpectrumDisplay<baseBins>;
+
+    // Unsupported counts fall back to the base resolution.
+    static int getResolutionIndex (int numBins) noexcept;
+
+    // Message thread, audio stopped.
+    void prepare (double sampleRate, int fftSize);
+
+    // Audio thread.
+    void reset() noexcept;
+    void resetResolution (int resolutionIndex) noexcept;
+    void process (FractionalOctaveSmoother& smoother,
+                  const float* linearPower,
+                  size_t smoothingIndex,
+                  float magnitudeScale,
+                  int resolutionIndex) noexcept;
+    const Base& getBase() const noexcept { return base; }
+
+    // Any thread. Resizes dest to the resolution's point count.
+    void copyPublished (int resolutionIndex, std::vector<float>& dest) const;
+    // Message thread or audio thread. The point centres of a resolution, in Hz, or nullptr
+    // before the first prepare().
+    const float* getFrequencies (int resolutionIndex) const noexcept;
+
+private:
+    template <typename Visitor>
+    void visitDetail (int resolutionIndex, Visitor&& visitor) noexcept
+    {
+        switch (resolutionIndex)
+        {
+            case 1: visitor (display512); break;
+            case 2: visitor (display1024); break;
+            case 3: visitor (display2048); break;
+            default: break;
+        }
+    }
+
+    Base base;
+    SpectrumDisplay<512> display512;
+    SpectrumDisplay<1024> display1024;
+    SpectrumDisplay<2048> display2048;
+};
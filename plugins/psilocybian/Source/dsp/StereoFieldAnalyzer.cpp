@@ -0,0 +1,95 @@
+#include "StereoFieldAnalyzer.h"
+
+#include <cmath>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace
+{
+constexpr float kFloorDb = -96.0f;
+} // namespace
+
+void StereoFieldAnalyzer::reset() noexcept
+{
+    hasAverage = false;
+    for (int i = 0; i < numBands; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        publishedCoherence[idx].store (1.0f, std::memory_order_relaxed);
+        publishedCorrelation[idx].store (1.0f, std::memory_order_relaxed);
+        publishedWidth[idx].store (0.0f, std::memory_order_relaxed);
+    }
+}
+
+void StereoFieldAnalyzer::process (FractionalOctaveSmoother& smoother,
+                                   const float* powerLeft,
+                                   const float* powerRight,
+                                   const float* crossReal,
+                                   const float* crossImag,
+                                   const FractionalOctaveSmoother::Band* bands,
+                                   float magnitudeScale) noexcept
+{
+    smoother.process (powerLeft, bands, numBands, bandLeft.data());
+    smoother.process (powerRight, bands, numBands, bandRight.data());
+    smoother.processSigned (crossReal, bands, numBands, bandCrossReal.data());
+    smoother.processSigned (crossImag, bands, numBands, bandCrossImag.data());
+
+    // Cross-spectra only mean something averaged, and the trace's release is the averaging
+    // time the analyzer already shows; the first frame seeds it.
+    const float coefficient = hasAverage ? SpectrumDisplaySet::Base::releaseCoefficient : 1.0f;
+    hasAverage = true;
+
+    const float floorAmplitude = juce::Decibels::decibelsToGain (kFloorDb) / juce::jmax (1.0e-20f, magnitudeScale);
+    const float floorPower = floorAmplitude * floorAmplitude;
+
+    for (int i = 0; i < numBands; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        averageLeft[idx] += (bandLeft[idx] - averageLeft[idx]) * coefficient;
+        averageRight[idx] += (bandRight[idx] - averageRight[idx]) * coefficient;
+        averageCrossReal[idx] += (bandCrossReal[idx] - averageCrossReal[idx]) * coefficient;
+        averageCrossImag[idx] += (bandCrossImag[idx] - averageCrossImag[idx]) * coefficient;
+
+        const float sxx = averageLeft[idx];
+        const float syy = averageRight[idx];
+        const float re = averageCrossReal[idx];
+        const float im = averageCrossImag[idx];
+
+        float coherence = 1.0f;
+        float correlation = 1.0f;
+        float width = 0.0f;
+        const float total = sxx + syy;
+        if (0.5f * total > floorPower)
+        {
+            const float product = sxx * syy;
+            if (product > 0.0f)
+            {
+                coherence = juce::jlimit (0.0f, 1.0f, (re * re + im * im) / product);
+                correlation = juce::jlimit (-1.0f, 1.0f, re / std::sqrt (product));
+            }
+            else
+            {
+                // One side silent: fully coherent by definition, but no correlation to speak of.
+                correlation = 0.0f;
+            }
+
+            // mid = (L + R) / 2, side = (L - R) / 2, so side / (mid + side) = (Sxx + Syy - 2 Re) / 2 (Sxx + Syy).
+            width = juce::jlimit (0.0f, 1.0f, (total - 2.0f * re) / (2.0f * total));
+        }
+
+        publishedCoherence[idx].store (coherence, std::memory_order_relaxed);
+        publishedCorrelation[idx].store (correlation, std::memory_order_relaxed);
+        publishedWidth[idx].store (width, std::memory_order_relaxed);
+    }
+}
+
+void StereoFieldAnalyzer::copySnapshot (Values& coherence, Values& correlation, Values& width) const noexcept
+{
+    for (int i = 0; i < numBands; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        coherence[idx] = publishedCoherence[idx].load (std::memory_order_relaxed);
+        correlation[idx] = publishedCorrelation[idx].load (std::memory_order_relaxed);
+        width[idx] = publishedWidth[idx].load (std::memory_order_relaxed);
+    }
+}
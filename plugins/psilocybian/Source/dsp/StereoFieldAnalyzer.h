@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "FractionalOctaveSmoother.h"
+#include "SpectrumDisplay.h"
+
+// Frequency-resolved stereo image from the L/R auto- and cross-spectra of the analyzer frame.
+// Each display band averages them over the analyzer's smoothing band and over time with the
+// trace's release coefficient, then reduces them to
+//   coherence    |Sxy|^2 / (Sxx Syy)            0 .. 1
+//   correlation  Re Sxy / sqrt (Sxx Syy)        -1 .. 1
+//   width        side / (mid + side) energy     0 (mono) .. 1 (out of phase)
+// Bands below the display floor read as coherent mono.
+class StereoFieldAnalyzer
+{
+public:
+    static constexpr int numBands = SpectrumDisplaySet::baseBins;
+    using Values = std::array<float, numBands>;
+
+    // Audio thread. The linear arrays hold one value per FFT bin; magnitudeScale is the
+    // analyzer's FFT magnitude to full-scale factor.
+    void reset() noexcept;
+    void process (FractionalOctaveSmoother& smoother,
+                  const float* powerLeft,
+                  const float* powerRight,
+                  const float* crossReal,
+                  const float* crossImag,
+                  const FractionalOctaveSmoother::Band* bands,
+                  float magnitudeScale) noexcept;
+
+    // Any thread.
+    void copySnapshot (Values& coherence, Values& correlation, Values& width) const noexcept;
+
+private:
+    Values bandLeft {};
+    Values bandRight {};
+    Values bandCrossReal {};
+    Values bandCrossImag {};
+    Values averageLeft {};
+    Values averageRight {};
+    Values averageCrossReal {};
+    Values averageCrossImag {};
+    bool hasAverage = false;
+
+    std::array<std::atomic<float>, numBands> publishedCoherence {};
+    std::array<std::atomic<float>, numBands> publishedCorrelation {};
+    std::array<std::atomic<float>, numBands> publishedWidth {};
+};
@@ -0,0 +1,179 @@
+#include "ThirdOctaveRta.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace
+{
+constexpr int kFirstBandIndex = -17; // 20 Hz, counted in tenths of a decade from 1 kHz.
+constexpr double kHalfBandRatio = 1.1220184543019633; // 10^0.05, band centre to edge.
+constexpr double kMaxUpperEdgeRatio = 0.45;
+constexpr float kFloorDb = -96.0f;
+} // namespace
+
+float ThirdOctaveRta::getCentreFrequency (int band) noexcept
+{
+    return static_cast<float> (1000.0 * std::pow (10.0, static_cast<double> (band + kFirstBandIndex) / 10.0));
+}
+
+void ThirdOctaveRta::prepare (double newSampleRate)
+{
+    sampleRate = juce::jmax (1000.0, newSampleRate);
+    numStages = 1;
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        auto& band = bands[static_cast<size_t> (b)];
+        const double centre = static_cast<double> (getCentreFrequency (b));
+        const double lower = centre / kHalfBandRatio;
+        const double upper = juce::jmin (centre * kHalfBandRatio, kMaxUpperEdgeRatio * sampleRate);
+
+        // Bands at or above Nyquist are left out rather than folded.
+        band.enabled = upper > lower * 1.01;
+        band.stage = 0;
+        if (! band.enabled)
+            continue;
+
+        while (band.stage + 1 < maxStages && upper <= maxEdgeRatio * sampleRate / static_cast<double> (1 << (band.stage + 1)))
+            ++band.stage;
+        numStages = juce::jmax (numStages, band.stage + 1);
+
+        // Sixth-order Butterworth band-pass: the third-order low-pass prototype poles at 120 and
+        // 180 degrees (the third is the conjugate of the first) through s -> (s^2 + w0^2) / (s bw),
+        // prewarped so the edges land exactly, then the bilinear transform per conjugate pair.
+        const double rate = sampleRate / static_cast<double> (1 << band.stage);
+        const double warpedLower = std::tan (juce::MathConstants<double>::pi * lower / rate);
+        const double warpedUpper = std::tan (juce::MathConstants<double>::pi * upper / rate);
+        const double bandwidth = warpedUpper - warpedLower;
+        const double centreSquared = warpedLower * warpedUpper;
+
+        const std::complex<double> prototypeA = std::polar (1.0, 2.0 * juce::MathConstants<double>::pi / 3.0);
+        const std::complex<double> prototypeB (-1.0, 0.0);
+        std::array<std::complex<double>, 3> analogPoles;
+        const auto rootA = std::sqrt (prototypeA * bandwidth * prototypeA * bandwidth - 4.0 * centreSquared);
+        const auto rootB = std::sqrt (prototypeB * bandwidth * prototypeB * bandwidth - 4.0 * centreSquared);
+        analogPoles[0] = 0.5 * (prototypeA * bandwidth + rootA);
+        analogPoles[1] = 0.5 * (prototypeA * bandwidth - rootA);
+        analogPoles[2] = 0.5 * (prototypeB * bandwidth + rootB);
+
+        // Each section is normalised to unity at the centre, so the cascade is too.
+        const double centreW = 2.0 * std::atan (std::sqrt (centreSquared));
+        const std::complex<double> zCentre = std::polar (1.0, -centreW);
+        for (size_t s = 0; s < band.sections.size(); ++s)
+        {
+            const auto pole = (1.0 + analogPoles[s]) / (1.0 - analogPoles[s]);
+            const double a1 = -2.0 * pole.real();
+            const double a2 = std::norm (pole);
+            const double response = std::abs ((1.0 - zCentre * zCentre) / (1.0 + a1 * zCentre + a2 * zCentre * zCentre));
+
+            auto& section = band.sections[s];
+            section.b0 = static_cast<float> (1.0 / response);
+            section.b2 = -section.b0;
+            section.a1 = static_cast<float> (a1);
+            section.a2 = static_cast<float> (a2);
+        }
+    }
+
+    updateTimeConstants();
+    reset();
+}
+
+void ThirdOctaveRta::reset() noexcept
+{
+    for (auto& band : bands)
+    {
+        for (auto& section : band.sections)
+            section.s1 = section.s2 = 0.0f;
+        band.meanSquare = 0.0f;
+    }
+
+    for (auto& decimator : decimators)
+        decimator.reset();
+
+    for (auto& value : published)
+        value.store (0.0f, std::memory_order_relaxed);
+}
+
+void ThirdOctaveRta::setWeighting (Weighting newWeighting) noexcept
+{
+    if (newWeighting == weighting)
+        return;
+
+    // Switched off, the bank stops running; clear it so it restarts without stale state.
+    if (weighting == Weighting::off || newWeighting == Weighting::off)
+        reset();
+
+    weighting = newWeighting;
+    updateTimeConstants();
+}
+
+void ThirdOctaveRta::updateTimeConstants() noexcept
+{
+    const double seconds = weighting == Weighting::slow ? slowSeconds : fastSeconds;
+    for (int b = 0; b < numBands; ++b)
+    {
+        const double rate = sampleRate / static_cast<double> (1 << bands[static_cast<size_t> (b)].stage);
+        averageCoefficients[static_cast<size_t> (b)] = static_cast<float> (1.0 - std::exp (-1.0 / (seconds * rate)));
+    }
+}
+
+void ThirdOctaveRta::process (const float* input, int numSamples) noexcept
+{
+    if (weighting == Weighting::off)
+        return;
+
+    while (numSamples > 0)
+    {
+        int count = juce::jmin (numSamples, chunkSize);
+        std::copy (input, input + count, buffer.begin());
+        input += count;
+        numSamples -= count;
+
+        for (int stage = 0; stage < numStages && count > 0; ++stage)
+        {
+            if (stage > 0)
+                count = decimators[static_cast<size_t> (stage - 1)].process (buffer.data(), count, buffer.data());
+
+            for (int b = 0; b < numBands; ++b)
+            {
+                auto& band = bands[static_cast<size_t> (b)];
+                if (! band.enabled || band.stage != stage)
+                    continue;
+
+                const float coefficient = averageCoefficients[static_cast<size_t> (b)];
+                float meanSquare = band.meanSquare;
+                for (int i = 0; i < count; ++i)
+                {
+                    float y = buffer[static_cast<size_t> (i)];
+                    for (auto& section : band.sections)
+                        y = section.process (y);
+                    meanSquare += (y * y - meanSquare) * coefficient;
+                }
+                band.meanSquare = meanSquare;
+            }
+        }
+    }
+
+    // A sine of amplitude A has a mean square of A^2 / 2.
+    for (int b = 0; b < numBands; ++b)
+    {
+        const auto& band = bands[static_cast<size_t> (b)];
+        const float dB = band.enabled ? juce::Decibels::gainToDecibels (std::sqrt (2.0f * band.meanSquare), -120.0f) : -120.0f;
+        published[static_cast<size_t> (b)].store (juce::jlimit (0.0f, 1.0f, juce::jmap (dB, kFloorDb, 0.0f, 0.0f, 1.0f)),
+                                                  std::memory_order_relaxed);
+    }
+}
+
+void ThirdOctaveRta::copyDisplay (const float* frequenciesHz, int numPoints, float* dest) const noexcept
+{
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const float frequency = frequenciesHz[i];
+        const int band = frequency > 0.0f ? static_cast<int> (std::floor (10.0f * std::log10 (frequency / 1000.0f) + 0.5f)) - kFirstBandIndex
+                                          : -1;
+        dest[i] = (band >= 0 && band < numBands) ? published[static_cast<size_t> (band)].load (std::memory_order_relaxed) : 0.0f;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "HalfBandDecimator.h"
+
+// Standards-shaped 1/3-octave real-time analyzer: the 31 base-ten bands of IEC 61260 from 20 Hz
+// to 20 kHz, each a sixth-order Butterworth band-pass (three biquads, the usual class 1 shape)
+// followed by exponential time weighting of the band power, Fast (125 ms) or Slow (1 s).
+// Bands run multirate: every band is filtered at the lowest rate of a chain of 2:1 half-band
+// decimators that keeps its upper edge below maxEdgeRatio of that rate, so each lower octave
+// costs half the one above and the whole bank stays under twice the cost of its top stage.
+// Published per band on the trace's 0..1 scale over -96..0 dBFS, with a sine reading as its
+// amplitude like the FFT trace.
+class ThirdOctaveRta
+{
+public:
+    enum class Weighting
+    {
+        off = 0,
+        fast,
+        slow
+    };
+
+    static constexpr int numBands = 31;
+    static constexpr int maxStages = 10;
+    static constexpr double maxEdgeRatio = 0.2;
+    static constexpr double fastSeconds = 0.125;
+    static constexpr double slowSeconds = 1.0;
+
+    // Message thread, audio stopped.
+    void prepare (double sampleRate);
+
+    static float getCentreFrequency (int band) noexcept;
+
+    // Audio thread.
+    void reset() noexcept;
+    void setWeighting (Weighting newWeighting) noexcept;
+    Weighting getWeighting() const noexcept { return weighting; }
+    void process (const float* input, int numSamples) noexcept;
+
+    // Any thread. Fills numPoints display values at the given frequencies, each showing the
+    // band it falls in, so the bands draw as steps on the trace's own axis.
+    void copyDisplay (const float* frequenciesHz, int numPoints, float* dest) const noexcept;
+
+private:
+    static constexpr int chunkSize = 256;
+
+    struct Section
+    {
+        float b0 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+        float s1 = 0.0f, s2 = 0.0f;
+
+        // Band-pass sections have b1 = 0 and b2 = -b0.
+        float process (float x) noexcept
+        {
+            const float y = b0 * x + s1;
+            s1 = s2 - a1 * y;
+            s2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+
+    struct Band
+    {
+        std::array<Section, 3> sections;
+        int stage = 0;
+        bool enabled = false;
+        float meanSquare = 0.0f;
+    };
+
+    void updateTimeConstants() noexcept;
+
+    double sampleRate = 48000.0;
+    Weighting weighting = Weighting::off;
+    std::array<Band, numBands> bands {};
+    std::array<float, numBands> averageCoefficients {};
+    int numStages = 1;
+    // decimators[j] feeds stage j + 1.
+    std::array<HalfBandDecimator<19>, maxStages - 1> decimators;
+    std::array<float, chunkSize> buffer {};
+
+    std::array<std::atomic<float>, numBands> published {};
+};
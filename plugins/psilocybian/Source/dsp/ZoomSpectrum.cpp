@@ -0,0 +1,229 @@
+#include "ZoomSpectrum.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "SpectrumDisplay.h"
+
+namespace
+{
+constexpr float kFloorDb = -96.0f;
+// The half-band stages are clean to about a quarter of their output rate either side of DC,
+// so the window is kept within half the final rate.
+constexpr double kOutputRatePerSpan = 2.0;
+constexpr double kMaxFrameSeconds = 1.0;
+constexpr int kHopsPerFrame = 8;
+} // namespace
+
+ZoomSpectrum::ZoomSpectrum()
+{
+    for (int order = minFftOrder; order <= maxFftOrder; ++order)
+    {
+        const auto idx = static_cast<size_t> (order - minFftOrder);
+        ffts[idx] = std::make_unique<FftEngine> (order);
+        windows[idx] = SharedDspTables::getWindow (SharedDspTables::WindowKind::hann, 1 << order);
+    }
+
+    prepare (48000.0);
+}
+
+void ZoomSpectrum::prepare (double newSampleRate)
+{
+    sampleRate = juce::jmax (1000.0, newSampleRate);
+    active = false;
+    activeMinHz = 0.0f;
+    activeMaxHz = 0.0f;
+    reset();
+}
+
+void ZoomSpectrum::reset() noexcept
+{
+    for (auto& stage : stages)
+    {
+        stage.real.reset();
+        stage.imag.reset();
+    }
+
+    oscillator = { 1.0, 0.0 };
+    historyIndex = 0;
+    historyFill = 0;
+    samplesSinceFrame = 0;
+    hasFrame = false;
+}
+
+void ZoomSpectrum::setRange (float minHz, float maxHz) noexcept
+{
+    const bool valid = std::isfinite (minHz) && std::isfinite (maxHz) && minHz > 0.0f && maxHz > minHz;
+    requestedMinHz.store (valid ? minHz : 0.0f, std::memory_order_relaxed);
+    requestedMaxHz.store (valid ? maxHz : 0.0f, std::memory_order_relaxed);
+}
+
+void ZoomSpectrum::configure (float minHz, float maxHz) noexcept
+{
+    activeMinHz = minHz;
+    activeMaxHz = maxHz;
+    active = maxHz > minHz;
+    reset();
+    if (! active)
+        return;
+
+    // Keep the window inside (0, Nyquist), so the negative-frequency image of the input never
+    // lands inside it, and at least minSpanHz wide.
+    const double nyquist = 0.5 * sampleRate;
+    const double lowHz = juce::jlimit (1.0, nyquist - static_cast<double> (minSpanHz) - 1.0, static_cast<double> (minHz));
+    const double highHz = juce::jlimit (lowHz + static_cast<double> (minSpanHz), nyquist - 1.0, static_cast<double> (maxHz));
+    const double spanHz = highHz - lowHz;
+    const double centreHz = 0.5 * (lowHz + highHz);
+
+    numStages = 0;
+    while (numStages < maxStages
+           && sampleRate / static_cast<double> (1 << (numStages + 1)) >= kOutputRatePerSpan * spanHz)
+        ++numStages;
+    const double outputRate = sampleRate / static_cast<double> (1 << numStages);
+
+    fftOrder = minFftOrder;
+    while (fftOrder < maxFftOrder
+           && static_cast<double> (1 << fftOrder) * spanHz / outputRate < static_cast<double> (numBins)
+           && static_cast<double> (1 << (fftOrder + 1)) / outputRate <= kMaxFrameSeconds)
+        ++fftOrder;
+    fftSize = 1 << fftOrder;
+    hopSize = fftSize / kHopsPerFrame;
+
+    const double w = juce::MathConstants<double>::twoPi * centreHz / sampleRate;
+    oscillatorStep = { std::cos (w), -std::sin (w) };
+
+    const double binWidthHz = outputRate / static_cast<double> (fftSize);
+    const double logRatio = std::log (highHz / lowHz);
+    const double halfStep = 0.5 * logRatio / static_cast<double> (numBins - 1);
+    const int lowestBin = -fftSize / 2;
+    const int highestBin = fftSize / 2 - 1;
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        const double logFrequency = std::log (lowHz) + logRatio * static_cast<double> (i) / static_cast<double> (numBins - 1);
+        fractionalFftBin[idx] = static_cast<float> ((std::exp (logFrequency) - centreHz) / binWidthHz);
+        firstFftBin[idx] = juce::jlimit (lowestBin, highestBin, static_cast<int> (std::ceil ((std::exp (logFrequency - halfStep) - centreHz) / binWidthHz)));
+        lastFftBin[idx] = juce::jlimit (lowestBin, highestBin, static_cast<int> (std::floor ((std::exp (logFrequency + halfStep) - centreHz) / binWidthHz)));
+    }
+
+    // Mixing splits a real sine's amplitude between +f and -f, and only +f survives the
+    // decimation; the window's magnitudeScale already doubles it back.
+    const double magnitudeScale = static_cast<double> (windows[static_cast<size_t> (fftOrder - minFftOrder)]->magnitudeScale);
+    powerScale = static_cast<float> (magnitudeScale * magnitudeScale);
+    const double floorMagnitude = std::pow (10.0, static_cast<double> (kFloorDb) / 20.0) / magnitudeScale;
+    powerFloor = static_cast<float> (floorMagnitude * floorMagnitude);
+
+    windowMinHz = static_cast<float> (lowHz);
+    windowMaxHz = static_cast<float> (highHz);
+}
+
+void ZoomSpectrum::process (const float* input, int numSamples) noexcept
+{
+    const float minHz = requestedMinHz.load (std::memory_order_relaxed);
+    const float maxHz = requestedMaxHz.load (std::memory_order_relaxed);
+    if (minHz != activeMinHz || maxHz != activeMaxHz)
+        configure (minHz, maxHz);
+
+    if (! active)
+        return;
+
+    const int mask = fftSize - 1;
+    while (numSamples > 0)
+    {
+        const int numIn = juce::jmin (numSamples, chunkSize);
+        for (int i = 0; i < numIn; ++i)
+        {
+            const double x = static_cast<double> (input[i]);
+            chunkReal[static_cast<size_t> (i)] = static_cast<float> (x * oscillator.real());
+            chunkImag[static_cast<size_t> (i)] = static_cast<float> (x * oscillator.imag());
+            oscillator *= oscillatorStep;
+        }
+        oscillator /= std::abs (oscillator);
+        input += numIn;
+        numSamples -= numIn;
+
+        int numOut = numIn;
+        for (int s = 0; s < numStages; ++s)
+        {
+            auto& stage = stages[static_cast<size_t> (s)];
+            stage.imag.process (chunkImag.data(), numOut, chunkImag.data());
+            numOut = stage.real.process (chunkReal.data(), numOut, chunkReal.data());
+        }
+
+        for (int i = 0; i < numOut; ++i)
+        {
+            history[static_cast<size_t> (historyIndex)] = { chunkReal[static_cast<size_t> (i)], chunkImag[static_cast<size_t> (i)] };
+            historyIndex = (historyIndex + 1) & mask;
+            historyFill = juce::jmin (fftSize, historyFill + 1);
+
+            if (++samplesSinceFrame >= hopSize && historyFill == fftSize)
+            {
+                samplesSinceFrame = 0;
+                processFrame();
+            }
+        }
+    }
+}
+
+void ZoomSpectrum::processFrame() noexcept
+{
+    const auto tableIndex = static_cast<size_t> (fftOrder - minFftOrder);
+    const float* windowValues = windows[tableIndex]->values.data();
+    const int mask = fftSize - 1;
+
+    // history[historyIndex] is the oldest sample once the ring is full.
+    for (int j = 0; j < fftSize; ++j)
+        frame[static_cast<size_t> (j)] = history[static_cast<size_t> ((historyIndex + j) & mask)] * windowValues[j];
+
+    ffts[tableIndex]->perform (frame.data(), spectrum.data());
+    for (int k = 0; k < fftSize; ++k)
+        power[static_cast<size_t> (k)] = std::norm (spectrum[static_cast<size_t> (k)]);
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto idx = static_cast<size_t> (i);
+        float binPower = 0.0f;
+        if (firstFftBin[idx] <= lastFftBin[idx])
+        {
+            // Points wider than a bin keep the strongest one, so narrow lines are not averaged away.
+            for (int k = firstFftBin[idx]; k <= lastFftBin[idx]; ++k)
+                binPower = juce::jmax (binPower, power[static_cast<size_t> (k & mask)]);
+        }
+        else
+        {
+            const float position = fractionalFftBin[idx];
+            const int k = static_cast<int> (std::floor (position));
+            const float t = position - static_cast<float> (k);
+            binPower = power[static_cast<size_t> (k & mask)] * (1.0f - t) + power[static_cast<size_t> ((k + 1) & mask)] * t;
+        }
+
+        const float dB = 10.0f * std::log10 (juce::jmax (powerFloor, binPower) * powerScale);
+        const float normalized = juce::jlimit (0.0f, 1.0f, juce::jmap (dB, kFloorDb, 0.0f, 0.0f, 1.0f));
+
+        float& value = smoothed[idx];
+        if (! hasFrame)
+            value = normalized;
+        const float coefficient = normalized >= value ? SpectrumDisplaySet::Base::attackCoefficient
+                                                      : SpectrumDisplaySet::Base::releaseCoefficient;
+        value += (normalized - value) * coefficient;
+        published[idx].store (value, std::memory_order_relaxed);
+    }
+
+    hasFrame = true;
+    publishedMinHz.store (windowMinHz, std::memory_order_relaxed);
+    publishedMaxHz.store (windowMaxHz, std::memory_order_relaxed);
+    publishedSequence.fetch_add (1, std::memory_order_release);
+}
+
+std::uint32_t ZoomSpectrum::read (std::vector<float>& out, float& minHz, float& maxHz) const
+{
+    const auto sequence = publishedSequence.load (std::memory_order_acquire);
+    minHz = publishedMinHz.load (std::memory_order_relaxed);
+    maxHz = publishedMaxHz.load (std::memory_order_relaxed);
+    out.resize (static_cast<size_t> (numBins));
+    for (int i = 0; i < numBins; ++i)
+        out[static_cast<size_t> (i)] = published[static_cast<size_t> (i)].load (std::memory_order_relaxed);
+    return sequence;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "FftEngine.h"
+#include "HalfBandDecimator.h"
+#include "SharedDspTables.h"
+
+// High-resolution spectrum of an arbitrary frequency window, by heterodyne / decimate / FFT:
+// the analysis stream is mixed down so the window's centre sits at DC, low-passed and
+// decimated by 2^stages with complex half-band stages until the window just fits the clean
+// part of the band, and transformed with a complex FFT. Bin spacing is then
+// fs / (2^stages * N) instead of fs / N, so a 40-120 Hz window gets real detail without a
+// global switch to a huge FFT. N grows until the window spans at least numBins FFT bins, as
+// long as a frame stays under a second. Published like the trace: numBins points log-spaced
+// across the window, 0..1 over -96..0 dBFS, with the trace's ballistics.
+class ZoomSpectrum
+{
+public:
+    static constexpr int numBins = 256;
+    static constexpr int maxStages = 12;
+    static constexpr int minFftOrder = 6;
+    static constexpr int maxFftOrder = 12;
+    static constexpr float minSpanHz = 2.0f;
+
+    ZoomSpectrum();
+
+    // Worker thread, or any thread while the worker is stopped.
+    void prepare (double sampleRate);
+    void reset() noexcept;
+    void process (const float* input, int numSamples) noexcept;
+
+    // Any thread. An empty or inverted range turns the analysis off.
+    void setRange (float minHz, float maxHz) noexcept;
+
+    // Any thread. Copies the latest published trace and the window it covers, and returns a
+    // sequence number that changes with every publish (0 until the first).
+    std::uint32_t read (std::vector<float>& out, float& minHz, float& maxHz) const;
+
+private:
+    using Complex = std::complex<float>;
+    static constexpr int maxFftSize = 1 << maxFftOrder;
+    static constexpr int chunkSize = 256;
+    static constexpr int halfBandTaps = 47;
+
+    struct Stage
+    {
+        HalfBandDecimator<halfBandTaps> real;
+        HalfBandDecimator<halfBandTaps> imag;
+    };
+
+    void configure (float minHz, float maxHz) noexcept;
+    void processFrame() noexcept;
+
+    double sampleRate = 48000.0;
+    std::array<std::unique_ptr<FftEngine>, maxFftOrder - minFftOrder + 1> ffts;
+    std::array<std::shared_ptr<const SharedDspTables::Window>, maxFftOrder - minFftOrder + 1> windows;
+
+    // Active configuration, worker side.
+    bool active = false;
+    float activeMinHz = 0.0f;
+    float activeMaxHz = 0.0f;
+    float windowMinHz = 0.0f;
+    float windowMaxHz = 0.0f;
+    int numStages = 0;
+    int fftOrder = minFftOrder;
+    int fftSize = 1 << minFftOrder;
+    int hopSize = 1 << (minFftOrder - 3);
+    std::complex<double> oscillator { 1.0, 0.0 };
+    std::complex<double> oscillatorStep { 1.0, 0.0 };
+    std::array<Stage, maxStages> stages;
+    std::array<float, chunkSize> chunkReal {};
+    std::array<float, chunkSize> chunkImag {};
+
+    std::array<Complex, maxFftSize> history {};
+    int historyIndex = 0;
+    int historyFill = 0;
+    int samplesSinceFrame = 0;
+    std::array<Complex, maxFftSize> frame {};
+    std::array<Complex, maxFftSize> spectrum {};
+    std::array<float, maxFftSize> power {};
+
+    // Per display point, the signed FFT bins it covers and its fractional centre bin.
+    std::array<int, numBins> firstFftBin {};
+    std::array<int, numBins> lastFftBin {};
+    std::array<float, numBins> fractionalFftBin {};
+    std::array<float, numBins> smoothed {};
+    bool hasFrame = false;
+    float powerFloor = 0.0f;
+    float powerScale = 1.0f;
+
+    std::atomic<float> requestedMinHz { 0.0f };
+    std::atomic<float> requestedMaxHz { 0.0f };
+    std::array<std::atomic<float>, numBins> published {};
+    std::atomic<float> publishedMinHz { 0.0f };
+    std::atomic<float> publishedMaxHz { 0.0f };
+    std::atomic<std::uint32_t> publishedSequence { 0 };
+};
@@ -0,0 +1,519 @@
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "../PluginProcessor.h"
+#include "../dsp/FftEngine.h"
+#include "../dsp/FilterResponse.h"
+
+namespace
+{
+constexpr int spectrumBins = SpecraumAudioProcessor::spectrumBins;
+constexpr int defaultBlockSize = 2048;
+constexpr int minBlockSize = 32;
+constexpr int maxBlockSize = 1 << 16;
+constexpr std::uint32_t binaryMagic = 0x41435053; // "SPCA"
+constexpr std::uint32_t binaryVersion = 2;
+constexpr int featureValues = SpectralFeatures::numValues;
+
+enum class OutputFormat
+{
+    json,
+    binary
+};
+
+struct InputFile
+{
+    juce::File file;
+    juce::String relativeName;
+};
+
+struct Options
+{
+    int jobs = juce::jmax (1, juce::SystemStats::getNumCpus());
+    int blockSize = defaultBlockSize;
+    OutputFormat format = OutputFormat::json;
+    bool features = false;
+    juce::File outputFolder;
+    juce::Array<InputFile> inputs;
+};
+
+struct AnalysisResult
+{
+    bool success = false;
+    juce::String message;
+    double sampleRate = 0.0;
+    std::int64_t samplesProcessed = 0;
+    int frameHop = SpecraumAudioProcessor::fftSize;
+    int numFrames = 0;
+    std::vector<float> spectrumFrames;
+    // featureValues per frame in SpectralFeatures::Values order, empty without --features.
+    std::vector<float> featureFrames;
+    std::vector<float> rmsDb;
+    std::vector<float> lufsIntegrated;
+};
+
+bool isSupportedAudioFile (const juce::File& file)
+{
+    const auto ext = file.getFileExtension().toLowerCase();
+    return ext == ".wav" || ext == ".aif" || ext == ".aiff" || ext == ".flac" || ext == ".ogg"
+        || ext == ".mp3" || ext == ".m4a" || ext == ".aac" || ext == ".wma";
+}
+
+AnalysisResult analyseFile (const juce::File& file, int blockSize, bool withFeatures)
+{
+    AnalysisResult result;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+    if (reader == nullptr)
+    {
+        result.message = "Unsupported or unreadable audio file.";
+        return result;
+    }
+
+    result.sampleRate = reader->sampleRate;
+    const auto totalSamples = reader->lengthInSamples;
+    const auto expectedFrames = static_cast<size_t> (totalSamples / SpecraumAudioProcessor::fftSize + 1);
+    const auto expectedBlocks = static_cast<size_t> (totalSamples / blockSize + 1);
+    result.spectrumFrames.reserve (expectedFrames * static_cast<size_t> (spectrumBins));
+    if (withFeatures)
+        result.featureFrames.reserve (expectedFrames * static_cast<size_t> (featureValues));
+    result.rmsDb.reserve (expectedBlocks);
+    result.lufsIntegrated.reserve (expectedBlocks);
+
+    SpecraumAudioProcessor processor;
+    processor.setNonRealtime (true);
+    processor.setPlayConfigDetails (2, 2, reader->sampleRate, blockSize);
+    processor.setSpectralFeaturesEnabled (withFeatures);
+    processor.setSpectrumFrameCallback ([&result, &processor, withFeatures] (const std::array<float, spectrumBins>& bins)
+    {
+        result.spectrumFrames.insert (result.spectrumFrames.end(), bins.begin(), bins.end());
+        ++result.numFrames;
+
+        // Offline, the features of this frame are already published.
+        if (withFeatures)
+        {
+            SpectralFeatures::Values features;
+            processor.readSpectralFeatures (features);
+            result.featureFrames.insert (result.featureFrames.end(),
+                                         { features.centroidHz, features.rolloffHz, features.flatness, features.flux });
+            result.featureFrames.insert (result.featureFrames.end(), features.chroma.begin(), features.chroma.end());
+        }
+    });
+    processor.prepareToPlay (reader->sampleRate, blockSize);
+
+    // High-rate files are decimated before analysis, so one frame spans more source samples.
+    result.frameHop = static_cast<int> (std::lround (SpecraumAudioProcessor::fftSize * reader->sampleRate
+                                                     / processor.getCurrentAnalysisSampleRate()));
+
+    // Mono files are duplicated to both channels by the reader, matching a stereo insert in a host.
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer midi;
+    std::int64_t position = 0;
+    while (position < totalSamples)
+    {
+        const int numSamples = static_cast<int> (juce::jmin<std::int64_t> (blockSize, totalSamples - position));
+        buffer.setSize (2, numSamples, false, false, true);
+        if (! reader->read (&buffer, 0, numSamples, position, true, true))
+        {
+            result.message = "Read error at sample " + juce::String (position) + ".";
+            processor.releaseResources();
+            return result;
+        }
+
+        processor.processBlock (buffer, midi);
+        result.rmsDb.push_back (processor.getRmsDb());
+        result.lufsIntegrated.push_back (processor.getLufsIntegrated());
+        position += numSamples;
+    }
+
+    processor.releaseResources();
+    result.samplesProcessed = position;
+    result.success = true;
+    result.message = "ok";
+    return result;
+}
+
+void appendFloatArray (juce::MemoryOutputStream& out, const float* values, size_t count, int decimals)
+{
+    out << "[";
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+            out << ",";
+        out << juce::String (values[i], decimals);
+    }
+    out << "]";
+}
+
+bool writeJson (const juce::File& target, const juce::String& sourcePath, const AnalysisResult& result, int blockSize)
+{
+    juce::MemoryOutputStream out;
+    out << "{";
+    out << "\"path\":" << juce::JSON::toString (juce::var (sourcePath)) << ",";
+    out << "\"sampleRate\":" << juce::String (result.sampleRate, 2) << ",";
+    out << "\"samples\":" << juce::String (result.samplesProcessed) << ",";
+    out << "\"bins\":" << spectrumBins << ",";
+    out << "\"frameHop\":" << result.frameHop << ",";
+    out << "\"blockSize\":" << blockSize << ",";
+    out << "\"frames\":[";
+    for (int f = 0; f < result.numFrames; ++f)
+    {
+        if (f > 0)
+            out << ",";
+        appendFloatArray (out, result.spectrumFrames.data() + static_cast<size_t> (f) * spectrumBins, spectrumBins, 5);
+    }
+    out << "],";
+    if (! result.featureFrames.empty())
+    {
+        out << "\"featureNames\":[\"centroidHz\",\"rolloffHz\",\"flatness\",\"flux\","
+               "\"chromaC\",\"chromaCs\",\"chromaD\",\"chromaDs\",\"chromaE\",\"chromaF\","
+               "\"chromaFs\",\"chromaG\",\"chromaGs\",\"chromaA\",\"chromaAs\",\"chromaB\"],";
+        out << "\"features\":[";
+        for (int f = 0; f < result.numFrames; ++f)
+        {
+            if (f > 0)
+                out << ",";
+            appendFloatArray (out, result.featureFrames.data() + static_cast<size_t> (f) * featureValues, featureValues, 4);
+        }
+        out << "],";
+    }
+    out << "\"rmsDb\":";
+    appendFloatArray (out, result.rmsDb.data(), result.rmsDb.size(), 3);
+    out << ",\"lufsIntegrated\":";
+    appendFloatArray (out, result.lufsIntegrated.data(), result.lufsIntegrated.size(), 3);
+    out << "}\n";
+
+    return target.replaceWithData (out.getData(), out.getDataSize());
+}
+
+// Little-endian: magic, version, sampleRate (f64), samples (i64), bins, frameHop, blockSize,
+// frameCount, meterCount, featureCount (u32 each; featureCount is 0 without --features), then
+// frameCount * bins spectrum values, meterCount RMS values, meterCount integrated LUFS values
+// and frameCount * featureCount feature values (f32 each).
+bool writeBinary (const juce::File& target, const AnalysisResult& result, int blockSize)
+{
+    target.deleteFile();
+    juce::FileOutputStream out (target);
+    if (! out.openedOk())
+        return false;
+
+    out.writeInt (static_cast<int> (binaryMagic));
+    out.writeInt (static_cast<int> (binaryVersion));
+    out.writeDouble (result.sampleRate);
+    out.writeInt64 (result.samplesProcessed);
+    out.writeInt (spectrumBins);
+    out.writeInt (result.frameHop);
+    out.writeInt (blockSize);
+    out.writeInt (result.numFrames);
+    out.writeInt (static_cast<int> (result.rmsDb.size()));
+    out.writeInt (result.featureFrames.empty() ? 0 : featureValues);
+
+    auto writeFloats = [&out] (const std::vector<float>& values)
+    {
+        for (const auto v : values)
+            out.writeFloat (v);
+    };
+    writeFloats (result.spectrumFrames);
+    writeFloats (result.rmsDb);
+    writeFloats (result.lufsIntegrated);
+    writeFloats (result.featureFrames);
+
+    out.flush();
+    return out.getStatus().wasOk();
+}
+
+juce::File getOutputFile (const Options& options, const InputFile& input)
+{
+    const auto extension = options.format == OutputFormat::json ? ".specraum.json" : ".specraum.bin";
+    if (options.outputFolder == juce::File())
+        return input.file.getSiblingFile (input.file.getFileNameWithoutExtension() + extension);
+
+    const auto relative = input.relativeName.upToLastOccurrenceOf (".", false, false);
+    return options.outputFolder.getChildFile (relative + extension);
+}
+
+void collectInputs (const juce::File& path, juce::Array<InputFile>& inputs)
+{
+    if (path.existsAsFile())
+    {
+        inputs.add ({ path, path.getFileName() });
+        return;
+    }
+
+    if (! path.isDirectory())
+        return;
+
+    for (const auto& entry : juce::RangedDirectoryIterator (path,
+                                                            true,
+                                                            "*",
+                                                            juce::File::findFiles,
+                                                            juce::File::FollowSymlinks::no))
+    {
+        const auto file = entry.getFile();
+        if (isSupportedAudioFile (file))
+            inputs.add ({ file, file.getRelativePathFrom (path) });
+    }
+}
+
+void printUsage()
+{
+    std::cout << "Usage: specraum_analyze [--jobs N] [--block N] [--format json|binary] [--features] [--out <folder>] <file or folder>...\n"
+                 "       specraum_analyze --fft-check\n"
+                 "       specraum_analyze --filter-response-check\n"
+                 "  Streams each file through the SPECRAUM processor and writes its analyzer frames and\n"
+                 "  per-block RMS/integrated LUFS next to the file, or under --out. RMS ballistics are\n"
+                 "  applied per block as in a host, so use the host block size when comparing against one.\n"
+                 "  --features adds spectral centroid, rolloff, flatness, flux and chroma per frame.\n"
+                 "  --fft-check compares the bundled FFT against juce::dsp::FFT and times both.\n"
+                 "  --filter-response-check compares the drawn filter response against a double-precision\n"
+                 "  evaluation for cascades of narrow low-frequency cuts like the suppressor's.\n";
+}
+
+// Prints one JSON line per size with the largest difference between the two backends,
+// relative to the largest output magnitude, and the time per transform of each.
+int runFftCheck()
+{
+    constexpr int repeats = 2000;
+    constexpr double tolerance = 1.0e-5;
+    juce::Random random (0x5eed);
+    bool passed = true;
+
+    std::cout << "{\"defaultBackend\":\"" << FftEngine::getBackendName (FftEngine::defaultBackend) << "\"}" << std::endl;
+    for (int order = 1; order <= 15; ++order)
+    {
+        FftEngine bundled (order, FftEngine::Backend::bundled);
+        FftEngine reference (order, FftEngine::Backend::juce);
+        const auto size = static_cast<size_t> (bundled.getSize());
+
+        std::vector<FftEngine::Complex> input (size), expected (size), actual (size);
+        for (auto& value : input)
+            value = FftEngine::Complex (random.nextFloat() * 2.0f - 1.0f, random.nextFloat() * 2.0f - 1.0f);
+
+        reference.perform (input.data(), expected.data());
+        bundled.perform (input.data(), actual.data());
+
+        double peak = 0.0;
+        double maxError = 0.0;
+        for (size_t k = 0; k < size; ++k)
+        {
+            peak = juce::jmax (peak, static_cast<double> (std::abs (expected[k])));
+            maxError = juce::jmax (maxError, static_cast<double> (std::abs (expected[k] - actual[k])));
+        }
+
+        const double relativeError = maxError / juce::jmax (1.0e-30, peak);
+        passed = passed && relativeError < tolerance;
+
+        auto timePerTransform = [&input, &actual] (FftEngine& fft)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int r = 0; r < repeats; ++r)
+                fft.perform (input.data(), actual.data());
+            const auto ticks = juce::Time::getHighResolutionTicks() - start;
+            return 1.0e6 * juce::Time::highResolutionTicksToSeconds (ticks) / static_cast<double> (repeats);
+        };
+
+        const double bundledUs = timePerTransform (bundled);
+        const double juceUs = timePerTransform (reference);
+
+        std::cout << "{\"size\":" << size
+                  << ",\"relativeError\":" << juce::String (relativeError, 9)
+                  << ",\"bundledMicroseconds\":" << juce::String (bundledUs, 3)
+                  << ",\"juceMicroseconds\":" << juce::String (juceUs, 3) << "}" << std::endl;
+    }
+
+    return passed ? 0 : 1;
+}
+
+// Prints one JSON line per cascade with the largest difference in dB between FilterResponse and
+// the same float coefficients evaluated in double. Runs with denormals flushed, as on the audio
+// thread, where long products of small per-section values used to collapse to zero.
+int runFilterResponseCheck()
+{
+    struct Cascade
+    {
+        double sampleRate;
+        std::vector<float> frequenciesHz;
+        float q;
+        float gainDb;
+    };
+
+    const std::vector<Cascade> cascades {
+        { 96000.0, { 80.0f, 120.0f, 180.0f, 250.0f }, 4.0f, -6.0f },
+        { 48000.0, { 60.0f, 75.0f, 93.0f, 116.0f, 145.0f, 180.0f }, 6.0f, -12.0f },
+        { 192000.0, { 40.0f, 50.0f, 62.0f, 77.0f, 96.0f, 120.0f }, 10.0f, -18.0f },
+        { 44100.0, { 2000.0f, 3500.0f, 6000.0f, 9000.0f, 14000.0f, 18000.0f }, 8.0f, -12.0f }
+    };
+
+    constexpr int numPoints = 256;
+    constexpr double toleranceDb = 0.01;
+    juce::ScopedNoDenormals noDenormals;
+    bool passed = true;
+
+    std::vector<float> frequencies (static_cast<size_t> (numPoints));
+    for (int i = 0; i < numPoints; ++i)
+        frequencies[static_cast<size_t> (i)] = 20.0f * std::pow (1000.0f, static_cast<float> (i) / static_cast<float> (numPoints - 1));
+
+    for (const auto& cascade : cascades)
+    {
+        FilterResponse response;
+        response.prepare (cascade.sampleRate, frequencies.data(), numPoints);
+
+        std::vector<juce::dsp::IIR::Coefficients<float>::Ptr> sections;
+        for (const auto frequency : cascade.frequenciesHz)
+        {
+            sections.push_back (juce::dsp::IIR::Coefficients<float>::makePeakFilter (
+                cascade.sampleRate, frequency, cascade.q, juce::Decibels::decibelsToGain (cascade.gainDb)));
+            response.addSection (*sections.back());
+        }
+
+        std::vector<float> responseDb (static_cast<size_t> (numPoints));
+        response.getResponseDb (responseDb.data());
+
+        double maxErrorDb = 0.0;
+        double worstHz = 0.0;
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const double w = juce::MathConstants<double>::twoPi * frequencies[static_cast<size_t> (i)] / cascade.sampleRate;
+            const auto z = std::polar (1.0, -w);
+            std::complex<double> h (1.0, 0.0);
+            for (const auto& section : sections)
+            {
+                // makePeakFilter designs second-order sections, stored normalised as b0 b1 b2 a1 a2.
+                const float* c = section->getRawCoefficients();
+                h *= (static_cast<double> (c[0]) + static_cast<double> (c[1]) * z + static_cast<double> (c[2]) * z * z)
+                   / (1.0 + static_cast<double> (c[3]) * z + static_cast<double> (c[4]) * z * z);
+            }
+
+            const double expectedDb = juce::jmax (static_cast<double> (FilterResponse::floorDb), 20.0 * std::log10 (std::abs (h)));
+            const double errorDb = std::abs (expectedDb - static_cast<double> (responseDb[static_cast<size_t> (i)]));
+            if (errorDb > maxErrorDb)
+            {
+                maxErrorDb = errorDb;
+                worstHz = frequencies[static_cast<size_t> (i)];
+            }
+        }
+
+        passed = passed && maxErrorDb < toleranceDb;
+        std::cout << "{\"sampleRate\":" << cascade.sampleRate
+                  << ",\"sections\":" << sections.size()
+                  << ",\"maxErrorDb\":" << juce::String (maxErrorDb, 6)
+                  << ",\"atHz\":" << juce::String (worstHz, 1) << "}" << std::endl;
+    }
+
+    return passed ? 0 : 1;
+}
+
+bool parseOptions (int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--jobs" && hasValue)
+            options.jobs = juce::jlimit (1, 256, juce::String (argv[++i]).getIntValue());
+        else if (arg == "--block" && hasValue)
+            options.blockSize = juce::jlimit (minBlockSize, maxBlockSize, juce::String (argv[++i]).getIntValue());
+        else if (arg == "--format" && hasValue)
+        {
+            const juce::String format (argv[++i]);
+            if (format == "json")
+                options.format = OutputFormat::json;
+            else if (format == "binary")
+                options.format = OutputFormat::binary;
+            else
+                return false;
+        }
+        else if (arg == "--features")
+            options.features = true;
+        else if (arg == "--out" && hasValue)
+            options.outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile (argv[++i]);
+        else if (arg.startsWith ("--"))
+            return false;
+        else
+            collectInputs (juce::File::getCurrentWorkingDirectory().getChildFile (arg), options.inputs);
+    }
+
+    return ! options.inputs.isEmpty();
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    if (argc == 2 && juce::String (argv[1]) == "--fft-check")
+        return runFftCheck();
+    if (argc == 2 && juce::String (argv[1]) == "--filter-response-check")
+        return runFilterResponseCheck();
+
+    Options options;
+    if (! parseOptions (argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::CriticalSection outputLock;
+    std::atomic<int> failures { 0 };
+
+    {
+        juce::ThreadPool pool (juce::jmin (options.jobs, options.inputs.size()));
+        for (const auto& input : options.inputs)
+        {
+            pool.addJob ([&options, &outputLock, &failures, input]
+            {
+                const auto startMs = juce::Time::getMillisecondCounterHiRes();
+                auto result = analyseFile (input.file, options.blockSize, options.features);
+                const auto target = getOutputFile (options, input);
+
+                if (result.success)
+                {
+                    target.getParentDirectory().createDirectory();
+                    const bool written = options.format == OutputFormat::json
+                        ? writeJson (target, input.file.getFullPathName(), result, options.blockSize)
+                        : writeBinary (target, result, options.blockSize);
+                    if (! written)
+                    {
+                        result.success = false;
+                        result.message = "Could not write " + target.getFullPathName() + ".";
+                    }
+                }
+
+                if (! result.success)
+                    failures.fetch_add (1);
+
+                const double elapsedSeconds = 0.001 * (juce::Time::getMillisecondCounterHiRes() - startMs);
+                const double audioSeconds = result.sampleRate > 0.0
+                    ? static_cast<double> (result.samplesProcessed) / result.sampleRate
+                    : 0.0;
+
+                juce::String line;
+                line << "{\"path\":" << juce::JSON::toString (juce::var (input.file.getFullPathName()))
+                     << ",\"output\":" << juce::JSON::toString (juce::var (result.success ? target.getFullPathName() : juce::String()))
+                     << ",\"success\":" << (result.success ? "true" : "false")
+                     << ",\"frames\":" << result.numFrames
+                     << ",\"seconds\":" << juce::String (audioSeconds, 3)
+                     << ",\"realtimeFactor\":" << juce::String (audioSeconds / juce::jmax (1.0e-6, elapsedSeconds), 1)
+                     << ",\"message\":" << juce::JSON::toString (juce::var (result.message)) << "}";
+
+                const juce::ScopedLock lock (outputLock);
+                std::cout << line << std::endl;
+            });
+        }
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep (20);
+    }
+
+    return failures.load() == 0 ? 0 : 2;
+}
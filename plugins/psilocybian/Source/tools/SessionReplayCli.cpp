@@ -0,0 +1,18 @@
+#include "../PluginProcessor.h"
+#include "SessionReplay.h"
+
+int main (int argc, char* argv[])
+{
+    SessionReplay::Hooks hooks;
+    hooks.createProcessor = [] { return std::make_unique<SpecraumAudioProcessor>(); };
+    hooks.prepare = [] (juce::AudioProcessor& processor, const SessionCapture::Header&)
+    {
+        static_cast<SpecraumAudioProcessor&> (processor).setSessionCaptureEnabled (false);
+    };
+    hooks.applyCommand = [] (juce::AudioProcessor& processor, const juce::MemoryBlock& command)
+    {
+        static_cast<SpecraumAudioProcessor&> (processor).replayControlCommand (command);
+    };
+
+    return SessionReplay::runCommandLine (argc, argv, "specraum_replay", hooks);
+}
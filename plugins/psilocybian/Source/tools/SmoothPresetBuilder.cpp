@@ -6,11 +6,15 @@
 #include <juce_core/juce_core.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include "../dsp/FractionalOctaveSmoother.h"
+#include "../dsp/RealFftBatch.h"
+
 namespace
 {
 constexpr int spectrumBins = 256;
 constexpr int fftOrder = 11;
 constexpr int fftSize = 1 << fftOrder;
+constexpr int linearBins = (fftSize / 2) + 1;
 constexpr int maxAudioFilesToAnalyse = 160;
 constexpr int maxCandidateFilesToScan = 30000;
 constexpr double maxSecondsPerFileToAnalyse = 120.0;
@@ -33,25 +37,21 @@ float computeFftMagnitudeScale()
     return static_cast<float> (2.0 / (static_cast<double> (fftSize) * safeGain));
 }
 
-std::array<float, spectrumBins> buildSpectrumBinPositions (double sampleRate) noexcept
+std::array<float, spectrumBins> buildSpectrumCentreFrequencies (double sampleRate) noexcept
 {
-    std::array<float, spectrumBins> positions {};
+    std::array<float, spectrumBins> centres {};
     const float nyquist = static_cast<float> (sampleRate * 0.5);
     const float minFreq = 20.0f;
     const float maxFreq = juce::jlimit (minFreq + 1.0f, nyquist, 20000.0f);
     const float ratio = maxFreq / minFreq;
-    const float fftBinHz = static_cast<float> (sampleRate / static_cast<double> (fftSize));
-    const float maxIndex = static_cast<float> ((fftSize / 2) - 2);
 
     for (int i = 0; i < spectrumBins; ++i)
     {
         const float t = static_cast<float> (i) / static_cast<float> (spectrumBins - 1);
-        const float f = minFreq * std::pow (ratio, t);
-        const float fftBin = f / fftBinHz;
-        positions[static_cast<size_t> (i)] = juce::jlimit (1.0f, maxIndex, fftBin);
+        centres[static_cast<size_t> (i)] = minFreq * std::pow (ratio, t);
     }
 
-    return positions;
+    return centres;
 }
 
 struct PresetBuildResult
@@ -64,7 +64,7 @@ struct PresetBuildResult
     juce::String message;
 };
 
-PresetBuildResult buildSmoothPresetFromFolder (const juce::File& folder)
+PresetBuildResult buildSmoothPresetFromFolder (const juce::File& folder, int octaveFraction)
 {
     PresetBuildResult result;
 
@@ -118,47 +118,30 @@ PresetBuildResult buildSmoothPresetFromFolder (const juce::File& folder)
     formatManager.registerBasicFormats();
 
     std::array<double, spectrumBins> accumulated {};
-    std::int64_t totalFrames = 0;
+    int filesWithFrames = 0;
 
-    juce::dsp::FFT localFft { fftOrder };
+    RealFftBatch localFft { fftOrder };
     juce::dsp::WindowingFunction<float> localWindow { fftSize, juce::dsp::WindowingFunction<float>::hann, true };
     std::array<float, fftSize> localFifo {};
-    std::array<float, fftSize * 2> localFftData {};
+    std::array<float, fftSize> localFrame {};
+    std::array<float, linearBins> localPower {};
+    std::array<double, linearBins> fileLinearPowerAccum {};
     const float localMagnitudeScale = computeFftMagnitudeScale();
+    const float localPowerScale = localMagnitudeScale * localMagnitudeScale;
 
-    auto analyseFrame = [&] (const std::array<float, spectrumBins>& binPositions)
-    {
-        std::fill (localFftData.begin(), localFftData.end(), 0.0f);
-        std::copy (localFifo.begin(), localFifo.end(), localFftData.begin());
-        localWindow.multiplyWithWindowingTable (localFftData.data(), fftSize);
-        localFft.performFrequencyOnlyForwardTransform (localFftData.data());
-
-        const int maxIndex = (fftSize / 2) - 1;
-        auto readMagnitude = [&] (float fftBin) -> float
-        {
-            const float clamped = juce::jlimit (1.0f, static_cast<float> (maxIndex - 1), fftBin);
-            const int index = static_cast<int> (clamped);
-            const float frac = clamped - static_cast<float> (index);
-            const float magA = localFftData[static_cast<size_t> (index)];
-            const float magB = localFftData[static_cast<size_t> (juce::jmin (index + 1, maxIndex))];
-            return juce::jmax (0.0f, magA + frac * (magB - magA));
-        };
+    FractionalOctaveSmoother smoother;
+    smoother.prepare (linearBins);
+    std::array<FractionalOctaveSmoother::Band, spectrumBins> smoothingBands {};
+    const double smoothingOctaves = 1.0 / static_cast<double> (FractionalOctaveSmoother::sanitizeFraction (octaveFraction));
 
-        for (int i = 0; i < spectrumBins; ++i)
-        {
-            const float pos = binPositions[static_cast<size_t> (i)];
-            const float centerMag = readMagnitude (pos);
-            const float leftMag = readMagnitude (pos - 0.5f);
-            const float rightMag = readMagnitude (pos + 0.5f);
-            const float blendedMag = centerMag * 0.60f + leftMag * 0.20f + rightMag * 0.20f;
-
-            const float scaledMag = blendedMag * localMagnitudeScale;
-            const float dB = juce::Decibels::gainToDecibels (scaledMag, -120.0f);
-            const float normalized = juce::jlimit (0.0f, 1.0f, juce::jmap (dB, -96.0f, 0.0f, 0.0f, 1.0f));
-            accumulated[static_cast<size_t> (i)] += static_cast<double> (normalized);
-        }
+    auto analyseFrame = [&]()
+    {
+        std::copy (localFifo.begin(), localFifo.end(), localFrame.begin());
+        localWindow.multiplyWithWindowingTable (localFrame.data(), fftSize);
+        localFft.computePowerSpectrum (localFrame.data(), localPower.data());
 
-        ++totalFrames;
+        for (int k = 0; k < linearBins; ++k)
+            fileLinearPowerAccum[static_cast<size_t> (k)] += static_cast<double> (localPower[static_cast<size_t> (k)] * localPowerScale);
     };
 
     for (const auto& file : audioFiles)
@@ -167,18 +150,18 @@ PresetBuildResult buildSmoothPresetFromFolder (const juce::File& folder)
         if (reader == nullptr)
             continue;
 
-        const auto binPositions = buildSpectrumBinPositions (reader->sampleRate);
         const int channelsToRead = juce::jmax (1, juce::jmin (2, static_cast<int> (reader->numChannels)));
         constexpr int readBlockSize = 4096;
         juce::AudioBuffer<float> readBuffer (channelsToRead, readBlockSize);
 
         std::fill (localFifo.begin(), localFifo.end(), 0.0f);
+        std::fill (fileLinearPowerAccum.begin(), fileLinearPowerAccum.end(), 0.0);
         int localFifoIndex = 0;
+        int fileFrames = 0;
         std::int64_t position = 0;
         const auto fileSamplesToAnalyse = juce::jmin<std::int64_t> (
             reader->lengthInSamples,
             static_cast<std::int64_t> (reader->sampleRate * maxSecondsPerFileToAnalyse));
-        bool fileContributed = false;
 
         while (position < fileSamplesToAnalyse)
         {
@@ -198,9 +181,9 @@ PresetBuildResult buildSmoothPresetFromFolder (const juce::File& folder)
 
                 if (localFifoIndex >= fftSize)
                 {
-                    analyseFrame (binPositions);
+                    analyseFrame();
                     localFifoIndex = 0;
-                    fileContributed = true;
+                    ++fileFrames;
                 }
             }
 
@@ -211,43 +194,51 @@ PresetBuildResult buildSmoothPresetFromFolder (const juce::File& folder)
         {
             for (int i = localFifoIndex; i < fftSize; ++i)
                 localFifo[static_cast<size_t> (i)] = 0.0f;
-            analyseFrame (binPositions);
-            fileContributed = true;
+            analyseFrame();
+            ++fileFrames;
         }
 
-        if (fileContributed)
-            ++result.filesAnalysed;
-    }
-
-    if (totalFrames <= 0)
-    {
-        result.message = "No analyzable frames were produced from the selected files.";
-        return result;
-    }
+        if (fileFrames <= 0)
+            continue;
 
-    std::array<float, spectrumBins> averaged {};
-    for (int i = 0; i < spectrumBins; ++i)
-        averaged[static_cast<size_t> (i)] = static_cast<float> (accumulated[static_cast<size_t> (i)] / static_cast<double> (totalFrames));
+        std::array<float, linearBins> fileLinearPower {};
+        for (int k = 0; k < linearBins; ++k)
+            fileLinearPower[static_cast<size_t> (k)] = static_cast<float> (
+                fileLinearPowerAccum[static_cast<size_t> (k)] / static_cast<double> (fileFrames));
+
+        const auto centres = buildSpectrumCentreFrequencies (reader->sampleRate);
+        FractionalOctaveSmoother::computeBands (centres.data(),
+                                                spectrumBins,
+                                                reader->sampleRate / static_cast<double> (fftSize),
+                                                smoothingOctaves,
+                                                linearBins,
+                                                smoothingBands.data());
+        std::array<float, spectrumBins> smoothedPower {};
+        smoother.process (fileLinearPower.data(), smoothingBands.data(), spectrumBins, smoothedPower.data());
 
-    auto applySmoothingPass = [] (const std::array<float, spectrumBins>& input)
-    {
-        std::array<float, spectrumBins> output {};
         for (int i = 0; i < spectrumBins; ++i)
         {
-            const int leftIdx = juce::jlimit (0, spectrumBins - 1, i - 1);
-            const int rightIdx = juce::jlimit (0, spectrumBins - 1, i + 1);
-            const float center = input[static_cast<size_t> (i)];
-            const float left = input[static_cast<size_t> (leftIdx)];
-            const float right = input[static_cast<size_t> (rightIdx)];
-            output[static_cast<size_t> (i)] = center * 0.60f + left * 0.20f + right * 0.20f;
+            const float amplitude = std::sqrt (juce::jmax (smoothedPower[static_cast<size_t> (i)], 1.0e-20f));
+            const float dB = juce::Decibels::gainToDecibels (amplitude, -120.0f);
+            accumulated[static_cast<size_t> (i)] += static_cast<double> (
+                juce::jlimit (0.0f, 1.0f, juce::jmap (dB, -96.0f, 0.0f, 0.0f, 1.0f)));
         }
-        return output;
-    };
 
-    auto smoothed = applySmoothingPass (averaged);
+        ++filesWithFrames;
+        ++result.filesAnalysed;
+    }
+
+    if (filesWithFrames <= 0)
+    {
+        result.message = "No analyzable frames were produced from the selected files.";
+        return result;
+    }
 
     for (int i = 0; i < spectrumBins; ++i)
-        result.bins[static_cast<size_t> (i)] = juce::jlimit (0.0f, 1.0f, smoothed[static_cast<size_t> (i)]);
+        result.bins[static_cast<size_t> (i)] = juce::jlimit (
+            0.0f,
+            1.0f,
+            static_cast<float> (accumulated[static_cast<size_t> (i)] / static_cast<double> (filesWithFrames)));
 
     result.success = true;
     result.message = "ok";
@@ -280,19 +271,26 @@ void printResult (const juce::String& name, const juce::String& path, const Pres
 
 int main (int argc, char* argv[])
 {
-    juce::ignoreUnused (argc, argv);
+    int firstPairArg = 1;
+    int octaveFraction = FractionalOctaveSmoother::defaultFraction;
+    if (argc > 2 && juce::String (argv[1]) == "--octave")
+    {
+        octaveFraction = FractionalOctaveSmoother::sanitizeFraction (juce::String (argv[2]).getIntValue());
+        firstPairArg = 3;
+    }
 
-    if (argc < 3 || ((argc - 1) % 2) != 0)
+    const int pairArgs = argc - firstPairArg;
+    if (pairArgs < 2 || (pairArgs % 2) != 0)
     {
-        std::cout << "Usage: specraum_smooth_preset_builder <name1> <folder1> [<name2> <folder2> ...]\n";
+        std::cout << "Usage: specraum_smooth_preset_builder [--octave 24|12|6|3|2|1] <name1> <folder1> [<name2> <folder2> ...]\n";
         return 1;
     }
 
-    for (int i = 1; i + 1 < argc; i += 2)
+    for (int i = firstPairArg; i + 1 < argc; i += 2)
     {
         const juce::String name = argv[i];
         const juce::String folderPath = argv[i + 1];
-        const auto result = buildSmoothPresetFromFolder (juce::File (folderPath));
+        const auto result = buildSmoothPresetFromFolder (juce::File (folderPath), octaveFraction);
         printResult (name, folderPath, result);
     }
 